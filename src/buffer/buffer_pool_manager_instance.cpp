@@ -12,17 +12,23 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type, int numa_node)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type, numa_node) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, int numa_node)
     : pool_size_(pool_size),
+      capacity_(pool_size * BUFFER_POOL_MAX_GROWTH),
       num_instances_(num_instances),
       instance_index_(instance_index),
       next_page_id_(instance_index),
@@ -32,60 +38,646 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  // We allocate a consecutive memory space for the buffer pool, keeping the page data apart from the bookkeeping.
+  // Frames up to the capacity are reserved so that the pool can grow without moving pages that are in use; the arena
+  // only takes memory for the frames that are touched.
+  frame_arena_ = new FrameArena(capacity_, numa_node);
+  pages_ = new Page[capacity_];
+  switch (replacer_type) {
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(capacity_);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(capacity_);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(capacity_);
+      break;
+  }
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+  // Initially, every page is in the free list. Free frames carry a negative pin count so they can never be pinned.
+  for (size_t i = 0; i < capacity_; ++i) {
+    pages_[i].data_ = frame_arena_->GetFrame(static_cast<frame_id_t>(i));
+    pages_[i].pin_count_ = -1;
+    if (i < pool_size) {
+      free_list_.emplace_back(static_cast<int>(i));
+    } else {
+      released_frames_.emplace_back(static_cast<int>(i));
+    }
   }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundWriter();
+  {
+    std::scoped_lock lock(prefetch_latch_);
+    prefetch_running_ = false;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetch_thread_ != nullptr) {
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
   delete[] pages_;
+  delete frame_arena_;
   delete replacer_;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  // Make sure you call DiskManager::WritePage!
-  return false;
+  frame_id_t frame_id;
+  {
+    // Evictions and deletes need latch_, so under it a resident page can be pinned without a CAS. The pin keeps the
+    // page in its frame while it is written, after latch_ is released.
+    std::scoped_lock latch(latch_);
+    auto &shard = GetShard(page_id);
+    std::shared_lock shard_latch(shard.latch_);
+    auto it = shard.table_.find(page_id);
+    if (it == shard.table_.end()) {
+      return false;
+    }
+    frame_id = it->second;
+    pages_[frame_id].pin_count_++;
+  }
+  bool written = FlushFrame(&pages_[frame_id]);
+  UnpinAfterWrite(frame_id);
+  return written;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  // You can do it!
+  std::vector<frame_id_t> frames;
+  {
+    std::scoped_lock latch(latch_);
+    for (auto &shard : page_table_) {
+      std::shared_lock shard_latch(shard.latch_);
+      for (const auto &[page_id, frame_id] : shard.table_) {
+        pages_[frame_id].pin_count_++;
+        frames.push_back(frame_id);
+      }
+    }
+  }
+  for (frame_id_t frame_id : frames) {
+    FlushFrame(&pages_[frame_id]);
+    UnpinAfterWrite(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::UnpinAfterWrite(frame_id_t frame_id) {
+  // If the frame was dropped by an evictor while we held it, this puts it back into the replacer.
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::NeedsLogFlush(Page *page) -> bool {
+  if (!enable_logging || log_manager_ == nullptr) {
+    return false;
+  }
+  lsn_t page_lsn = page->GetLSN();
+  // Pages without an LSN, like the header page, may hold anything there; only LSNs handed out by the log count.
+  return page_lsn > log_manager_->GetPersistentLSN() && page_lsn < log_manager_->GetNextLSN();
+}
+
+auto BufferPoolManagerInstance::FlushFrame(Page *page) -> bool {
+  // Writers modify a page under its write latch, so the read latch gives us a consistent image.
+  page->RLatch();
+  if (NeedsLogFlush(page)) {
+    log_manager_->WaitForFlush(page->GetLSN()).get();
+  }
+  // A change made after the write started marks the page dirty again; one that failed to write must not be lost.
+  page->is_dirty_ = false;
+  bool written = disk_manager_->WritePage(page->page_id_, page->GetData());
+  if (!written) {
+    page->is_dirty_ = true;
+  }
+  page->RUnlatch();
+  return written;
 }
 
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  // 0.   Make sure you call AllocatePage!
-  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
-  // 3.   Update P's metadata, zero out memory and add P to the page table.
-  // 4.   Set the page ID output parameter. Return a pointer to P.
-  return nullptr;
+  std::unique_lock latch = LockAndTime();
+  frame_id_t frame_id;
+  if (!AcquireFrameWaitingForLog(&latch, &frame_id)) {
+    return nullptr;
+  }
+  *page_id = AllocatePage();
+  Page *page = &pages_[frame_id];
+  page->ResetMemory();
+  page->page_id_ = *page_id;
+  page->is_dirty_ = false;
+  StartRecLSN(page);
+  page->pin_count_ = 1;
+  auto &shard = GetShard(*page_id);
+  std::unique_lock shard_latch(shard.latch_);
+  shard.table_[*page_id] = frame_id;
+  return page;
 }
 
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  // 1.     Search the page table for the requested page (P).
-  // 1.1    If P exists, pin it and return it immediately.
-  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-  //        Note that pages are always found from the free list first.
-  // 2.     If R is dirty, write it back to the disk.
-  // 3.     Delete R from the page table and insert P.
-  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  return nullptr;
+  // Hits only pin the frame, which does not need latch_.
+  Page *page = TryPinResident(page_id);
+  if (page != nullptr) {
+    stats_.Add(&BufferPoolStatsCounters::Stripe::hits_);
+    return page;
+  }
+
+  std::unique_lock latch = LockAndTime();
+  // Another thread may have brought the page in while we were waiting for latch_.
+  page = TryPinResident(page_id);
+  if (page != nullptr) {
+    stats_.Add(&BufferPoolStatsCounters::Stripe::hits_);
+    return page;
+  }
+  frame_id_t frame_id;
+  if (!AcquireFrameWaitingForLog(&latch, &frame_id)) {
+    stats_.Add(&BufferPoolStatsCounters::Stripe::misses_);
+    return nullptr;
+  }
+  // Waiting for the log releases latch_, and another thread may have brought the page in meanwhile.
+  page = TryPinResident(page_id);
+  if (page != nullptr) {
+    FreeFrame(frame_id);
+    stats_.Add(&BufferPoolStatsCounters::Stripe::hits_);
+    return page;
+  }
+  stats_.Add(&BufferPoolStatsCounters::Stripe::misses_);
+  page = &pages_[frame_id];
+  if (!disk_manager_->ReadPage(page_id, page->GetData())) {
+    // The page could not be read, or is corrupt on disk, e.g. torn by a crash; hand it out to nobody.
+    stats_.Add(&BufferPoolStatsCounters::Stripe::read_failures_);
+    FreeFrame(frame_id);
+    return nullptr;
+  }
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  StartRecLSN(page);
+  page->pin_count_ = 1;
+  auto &shard = GetShard(page_id);
+  std::unique_lock shard_latch(shard.latch_);
+  shard.table_[page_id] = frame_id;
+  return page;
+}
+
+void BufferPoolManagerInstance::FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) {
+  pages->assign(page_ids.size(), nullptr);
+  std::vector<size_t> misses;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    (*pages)[i] = TryPinResident(page_ids[i]);
+    if ((*pages)[i] != nullptr) {
+      stats_.Add(&BufferPoolStatsCounters::Stripe::hits_);
+    } else {
+      misses.push_back(i);
+    }
+  }
+  if (misses.empty()) {
+    return;
+  }
+
+  std::unique_lock latch = LockAndTime();
+  // Frames for the misses stay unpinnable, with a negative pin count, until the whole batch has been read.
+  std::unordered_map<page_id_t, frame_id_t> loading;
+  std::vector<page_id_t> read_ids;
+  std::vector<char *> read_data;
+  bool out_of_frames = false;
+  lsn_t wait_lsn = INVALID_LSN;
+  std::vector<size_t> deferred;
+  for (size_t i : misses) {
+    page_id_t page_id = page_ids[i];
+    if (loading.count(page_id) != 0) {
+      continue;
+    }
+    (*pages)[i] = TryPinResident(page_id);
+    if ((*pages)[i] != nullptr) {
+      stats_.Add(&BufferPoolStatsCounters::Stripe::hits_);
+      continue;
+    }
+    stats_.Add(&BufferPoolStatsCounters::Stripe::misses_);
+    frame_id_t frame_id;
+    if (out_of_frames || !AcquireFrame(&frame_id, &wait_lsn)) {
+      out_of_frames = true;
+      if (wait_lsn != INVALID_LSN) {
+        deferred.push_back(i);
+      }
+      continue;
+    }
+    loading[page_id] = frame_id;
+    read_ids.push_back(page_id);
+    read_data.push_back(pages_[frame_id].GetData());
+  }
+  std::vector<bool> verified = disk_manager_->ReadPages(read_ids, read_data);
+  for (size_t i = 0; i < read_ids.size(); ++i) {
+    if (!verified[i]) {
+      stats_.Add(&BufferPoolStatsCounters::Stripe::read_failures_);
+      FreeFrame(loading[read_ids[i]]);
+      loading.erase(read_ids[i]);
+    }
+  }
+
+  for (const auto &[page_id, frame_id] : loading) {
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
+    page->is_dirty_ = false;
+    StartRecLSN(page);
+    page->pin_count_ = 0;
+  }
+  // A page listed more than once is pinned once per occurrence.
+  for (size_t i : misses) {
+    auto it = loading.find(page_ids[i]);
+    if (it != loading.end()) {
+      (*pages)[i] = &pages_[it->second];
+      (*pages)[i]->pin_count_++;
+    }
+  }
+  for (const auto &[page_id, frame_id] : loading) {
+    auto &shard = GetShard(page_id);
+    std::unique_lock shard_latch(shard.latch_);
+    shard.table_[page_id] = frame_id;
+  }
+  // Misses left with only victims that wait for the log are fetched one at a time, which waits without latch_.
+  latch.unlock();
+  for (size_t i : deferred) {
+    (*pages)[i] = FetchPgImp(page_ids[i]);
+  }
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  // 0.   Make sure you call DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
-  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  return false;
+  std::scoped_lock latch(latch_);
+  auto &shard = GetShard(page_id);
+  frame_id_t frame_id;
+  {
+    std::unique_lock shard_latch(shard.latch_);
+    auto it = shard.table_.find(page_id);
+    if (it == shard.table_.end()) {
+      return true;
+    }
+    frame_id = it->second;
+    int expected = 0;
+    if (!pages_[frame_id].pin_count_.compare_exchange_strong(expected, -1)) {
+      return false;
+    }
+    shard.table_.erase(it);
+  }
+  DeallocatePage(page_id);
+  replacer_->Remove(frame_id);
+  FreeFrame(frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::FreeFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  if (frames_to_release_ > 0) {
+    frames_to_release_--;
+    ReleaseFrame(frame_id);
+  } else {
+    free_list_.push_back(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  {
+    auto &shard = GetShard(page_id);
+    std::shared_lock shard_latch(shard.latch_);
+    auto it = shard.table_.find(page_id);
+    if (it == shard.table_.end()) {
+      return false;
+    }
+    Page *page = &pages_[it->second];
+    // The dirty flag must be visible before the pin count can reach zero and the frame becomes evictable.
+    if (is_dirty) {
+      page->is_dirty_ = true;
+    }
+    int pin_count = page->pin_count_.load();
+    do {
+      if (pin_count <= 0) {
+        return false;
+      }
+    } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+    if (pin_count != 1) {
+      return true;
+    }
+    replacer_->Unpin(it->second);
+  }
+  // A shrink of the pool that found every frame pinned releases frames as they become evictable.
+  if (frames_to_release_ > 0) {
+    std::scoped_lock latch(latch_);
+    ReleasePendingFrames();
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::ResizePool(size_t pool_size) -> bool {
+  if (pool_size == 0 || pool_size > capacity_) {
+    return false;
+  }
+  std::scoped_lock latch(latch_);
+  size_t current_pool_size = pool_size_;
+  if (pool_size >= current_pool_size) {
+    // Frames that an earlier shrink has not released yet are kept instead of bringing back released ones.
+    size_t grow = pool_size - current_pool_size;
+    size_t kept = std::min(grow, frames_to_release_.load());
+    frames_to_release_ -= kept;
+    for (size_t i = kept; i < grow; ++i) {
+      free_list_.push_back(released_frames_.front());
+      released_frames_.pop_front();
+    }
+  } else {
+    frames_to_release_ += current_pool_size - pool_size;
+    ReleasePendingFrames();
+  }
+  pool_size_ = pool_size;
+  return true;
+}
+
+void BufferPoolManagerInstance::SkipPageIdsBelow(page_id_t page_id) {
+  std::scoped_lock latch(latch_);
+  page_id_t next_page_id = next_page_id_;
+  if (next_page_id < page_id) {
+    // Stay on the page ids of this instance.
+    next_page_id += (page_id - next_page_id + num_instances_ - 1) / num_instances_ * num_instances_;
+    next_page_id_ = next_page_id;
+  }
+}
+
+void BufferPoolManagerInstance::ReleaseFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  frame_arena_->Release(frame_id);
+  released_frames_.push_back(frame_id);
 }
 
-auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool { return false; }
+void BufferPoolManagerInstance::ReleasePendingFrames() {
+  // Free frames go first, then the replacer gives up unpinned pages, writing back the dirty ones.
+  frame_id_t frame_id;
+  while (frames_to_release_ > 0 && AcquireFrame(&frame_id)) {
+    frames_to_release_--;
+    ReleaseFrame(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPgImp(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID || page_id >= next_page_id_ || IsResident(page_id)) {
+    return;
+  }
+  ValidatePageId(page_id);
+  std::scoped_lock lock(prefetch_latch_);
+  // Prefetching more pages than the pool holds would only evict pages prefetched earlier.
+  if (prefetch_queue_.size() >= pool_size_) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetch_running_ = true;
+    prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+  }
+  prefetch_queue_.push_back(page_id);
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return !prefetch_running_ || !prefetch_queue_.empty(); });
+    if (!prefetch_running_) {
+      return;
+    }
+    page_id_t page_id = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    lock.unlock();
+    LoadPrefetchedPage(page_id);
+    lock.lock();
+  }
+}
+
+void BufferPoolManagerInstance::LoadPrefetchedPage(page_id_t page_id) {
+  std::scoped_lock latch(latch_);
+  frame_id_t frame_id;
+  if (IsResident(page_id) || !AcquireFrame(&frame_id)) {
+    return;
+  }
+  Page *page = &pages_[frame_id];
+  if (!disk_manager_->ReadPage(page_id, page->GetData())) {
+    stats_.Add(&BufferPoolStatsCounters::Stripe::read_failures_);
+    FreeFrame(frame_id);
+    return;
+  }
+  stats_.Add(&BufferPoolStatsCounters::Stripe::prefetches_);
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->pin_count_ = 0;
+  auto &shard = GetShard(page_id);
+  std::unique_lock shard_latch(shard.latch_);
+  shard.table_[page_id] = frame_id;
+  // Still under the shard latch, so that a hit on the page can only pin it after it is in the replacer.
+  replacer_->AddPrefetched(frame_id);
+}
+
+void BufferPoolManagerInstance::GetDirtyPageTable(std::unordered_map<page_id_t, lsn_t> *dirty_page_table) {
+  // Evictions write dirty pages back with latch_ held, after they have left the page table.
+  std::scoped_lock latch(latch_);
+  for (auto &shard : page_table_) {
+    std::shared_lock shard_latch(shard.latch_);
+    for (const auto &[page_id, frame_id] : shard.table_) {
+      Page *page = &pages_[frame_id];
+      // A pinned page is only marked dirty when it is unpinned, so its changes may already be in the log.
+      if (page->is_dirty_ || page->pin_count_ > 0) {
+        (*dirty_page_table)[page_id] = page->rec_lsn_;
+      }
+    }
+  }
+}
+
+void BufferPoolManagerInstance::StartRecLSN(Page *page) {
+  if (log_manager_ != nullptr) {
+    page->rec_lsn_ = log_manager_->GetNextLSN();
+  }
+}
+
+auto BufferPoolManagerInstance::LockAndTime() -> std::unique_lock<std::mutex> {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock latch(latch_);
+  auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  stats_.Add(&BufferPoolStatsCounters::Stripe::pin_wait_ns_, waited.count());
+  return latch;
+}
+
+auto BufferPoolManagerInstance::IsResident(page_id_t page_id) -> bool {
+  auto &shard = GetShard(page_id);
+  std::shared_lock shard_latch(shard.latch_);
+  return shard.table_.count(page_id) != 0;
+}
+
+auto BufferPoolManagerInstance::TryPinResident(page_id_t page_id) -> Page * {
+  auto &shard = GetShard(page_id);
+  std::shared_lock shard_latch(shard.latch_);
+  auto it = shard.table_.find(page_id);
+  if (it == shard.table_.end()) {
+    return nullptr;
+  }
+  Page *page = &pages_[it->second];
+  int pin_count = page->pin_count_.load();
+  do {
+    // The frame is being evicted or deleted, fall back to the slow path.
+    if (pin_count < 0) {
+      return nullptr;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // Only the 0 -> 1 transition has to tell the replacer; pinning an already pinned page is a single CAS.
+  if (pin_count == 0) {
+    replacer_->Pin(it->second);
+    if (!page->is_dirty_) {
+      StartRecLSN(page);
+    }
+  }
+  return page;
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id, lsn_t *wait_lsn) -> bool {
+  if (wait_lsn != nullptr) {
+    *wait_lsn = INVALID_LSN;
+  }
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  // Victims that cannot be written back stay resident, and go back into the replacer once the search is over.
+  std::vector<frame_id_t> skipped;
+  bool found = false;
+  while (!found && replacer_->Victim(frame_id)) {
+    Page *page = &pages_[*frame_id];
+    auto &shard = GetShard(page->page_id_);
+    {
+      std::unique_lock shard_latch(shard.latch_);
+      // A hit may have pinned the frame after it entered the replacer. It is re-added when it is unpinned again.
+      int expected = 0;
+      if (!page->pin_count_.compare_exchange_strong(expected, -1)) {
+        continue;
+      }
+      // WAL: a page may only reach the disk after the log records of its changes.
+      if (page->is_dirty_ && NeedsLogFlush(page)) {
+        if (wait_lsn != nullptr && (*wait_lsn == INVALID_LSN || page->GetLSN() < *wait_lsn)) {
+          *wait_lsn = page->GetLSN();
+        }
+        page->pin_count_ = 0;
+        skipped.push_back(*frame_id);
+        continue;
+      }
+      shard.table_.erase(page->page_id_);
+    }
+    if (page->is_dirty_) {
+      if (!disk_manager_->WritePage(page->page_id_, page->GetData())) {
+        // Reusing the frame would lose the change; the page stays, dirty, for a later write to try again.
+        std::unique_lock shard_latch(shard.latch_);
+        shard.table_[page->page_id_] = *frame_id;
+        page->pin_count_ = 0;
+        skipped.push_back(*frame_id);
+        continue;
+      }
+      page->is_dirty_ = false;
+      stats_.Add(&BufferPoolStatsCounters::Stripe::foreground_writes_);
+    }
+    stats_.Add(&BufferPoolStatsCounters::Stripe::evictions_);
+    found = true;
+  }
+  for (frame_id_t skipped_frame_id : skipped) {
+    replacer_->Unpin(skipped_frame_id);
+  }
+  return found;
+}
+
+auto BufferPoolManagerInstance::AcquireFrameWaitingForLog(std::unique_lock<std::mutex> *latch, frame_id_t *frame_id)
+    -> bool {
+  lsn_t wait_lsn;
+  while (!AcquireFrame(frame_id, &wait_lsn)) {
+    if (wait_lsn == INVALID_LSN) {
+      return false;
+    }
+    latch->unlock();
+    log_manager_->WaitForFlush(wait_lsn).get();
+    latch->lock();
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::StartBackgroundWriter(double clean_fraction) {
+  std::scoped_lock lock(background_writer_latch_);
+  if (background_writer_thread_ != nullptr) {
+    return;
+  }
+  background_writer_clean_fraction_ = clean_fraction;
+  background_writer_running_ = true;
+  background_writer_thread_ = new std::thread(&BufferPoolManagerInstance::RunBackgroundWriter, this);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  std::thread *thread;
+  {
+    std::scoped_lock lock(background_writer_latch_);
+    if (background_writer_thread_ == nullptr) {
+      return;
+    }
+    background_writer_running_ = false;
+    thread = background_writer_thread_;
+    background_writer_thread_ = nullptr;
+  }
+  background_writer_cv_.notify_all();
+  thread->join();
+  delete thread;
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter() {
+  std::unique_lock lock(background_writer_latch_);
+  while (!background_writer_cv_.wait_for(lock, background_writer_interval,
+                                         [this] { return !background_writer_running_; })) {
+    lock.unlock();
+    CleanEvictionCandidates();
+    lock.lock();
+  }
+}
+
+void BufferPoolManagerInstance::CleanEvictionCandidates() {
+  std::vector<frame_id_t> candidates;
+  replacer_->GetEvictionCandidates(
+      static_cast<size_t>(std::ceil(background_writer_clean_fraction_ * replacer_->Size())), &candidates);
+
+  // Pin the dirty candidates so that they cannot be evicted while they are written. This bypasses the replacer, so the
+  // candidates keep their place in the eviction order.
+  std::vector<frame_id_t> pinned;
+  {
+    std::scoped_lock latch(latch_);
+    for (frame_id_t frame_id : candidates) {
+      Page *page = &pages_[frame_id];
+      if (!page->is_dirty_) {
+        continue;
+      }
+      int expected = 0;
+      if (page->pin_count_.compare_exchange_strong(expected, 1)) {
+        pinned.push_back(frame_id);
+      }
+    }
+  }
+
+  for (frame_id_t frame_id : pinned) {
+    Page *page = &pages_[frame_id];
+    // Writers modify a page under its write latch, so the read latch gives us a consistent image.
+    page->RLatch();
+    bool wal_safe = !enable_logging || log_manager_ == nullptr || page->GetLSN() <= log_manager_->GetPersistentLSN();
+    if (page->is_dirty_ && wal_safe) {
+      // A change made after the write started marks the page dirty again; one that failed to write must not be lost.
+      page->is_dirty_ = false;
+      if (disk_manager_->WritePage(page->page_id_, page->GetData())) {
+        stats_.Add(&BufferPoolStatsCounters::Stripe::background_writes_);
+      } else {
+        page->is_dirty_ = true;
+      }
+    }
+    page->RUnlatch();
+    UnpinAfterWrite(frame_id);
+  }
+}
 
 auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
   const page_id_t next_page_id = next_page_id_;
@@ -14,16 +14,69 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : frames_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool {
+  std::scoped_lock latch(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  // At most two sweeps: the first one may only clear reference bits.
+  while (true) {
+    auto &frame = frames_[hand_];
+    size_t current = hand_;
+    hand_ = (hand_ + 1) % frames_.size();
+    if (!frame.in_replacer_) {
+      continue;
+    }
+    if (frame.ref_) {
+      frame.ref_ = false;
+      continue;
+    }
+    frame.in_replacer_ = false;
+    size_--;
+    *frame_id = static_cast<frame_id_t>(current);
+    return true;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.in_replacer_) {
+    frame.in_replacer_ = false;
+    size_--;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.in_replacer_) {
+    frame.in_replacer_ = true;
+    frame.ref_ = true;
+    size_++;
+  }
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t {
+  std::scoped_lock latch(latch_);
+  return size_;
+}
+
+void ClockReplacer::GetEvictionCandidates(size_t count, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock latch(latch_);
+  // The hand takes frames without a reference bit on its first sweep, and the rest on its second one.
+  for (bool ref : {false, true}) {
+    for (size_t i = 0; i < frames_.size() && frame_ids->size() < count; ++i) {
+      size_t current = (hand_ + i) % frames_.size();
+      if (frames_[current].in_replacer_ && frames_[current].ref_ == ref) {
+        frame_ids->push_back(static_cast<frame_id_t>(current));
+      }
+    }
+  }
+}
 
 }  // namespace bustub
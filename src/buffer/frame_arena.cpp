@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, int numa_node) {
+  size_t size = num_frames * PAGE_SIZE;
+  // Small pools are not worth a whole huge page, which would be committed in full on first touch.
+  bool want_huge_pages = size >= HUGE_PAGE_SIZE;
+  if (want_huge_pages) {
+    size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  }
+  // mmap only guarantees base page alignment, so over-map by one huge page and align the frames inside the mapping.
+  mapping_size_ = want_huge_pages ? size + HUGE_PAGE_SIZE : size;
+  mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map a frame arena of " + std::to_string(size) + " bytes");
+  }
+  auto start = reinterpret_cast<uintptr_t>(mapping_);
+  if (want_huge_pages) {
+    start = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  }
+  data_ = reinterpret_cast<char *>(start);
+
+#ifdef __linux__
+  // Both calls are hints: the arena works without them, just with more TLB misses or remote memory accesses.
+  if (want_huge_pages) {
+    huge_pages_ = madvise(data_, size, MADV_HUGEPAGE) == 0;
+  }
+  if (numa_node != ANY_NUMA_NODE && numa_node < static_cast<int>(sizeof(unsigned long) * 8)) {  // NOLINT
+    // Preferred rather than strict binding, so that a full node falls back to remote memory instead of failing.
+    unsigned long node_mask = 1UL << numa_node;  // NOLINT
+    if (syscall(SYS_mbind, data_, size, MPOL_PREFERRED, &node_mask, sizeof(node_mask) * 8, 0) == 0) {
+      numa_node_ = numa_node;
+    } else {
+      LOG_DEBUG("cannot bind frame arena to NUMA node %d", numa_node);
+    }
+  }
+#endif
+}
+
+FrameArena::~FrameArena() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+void FrameArena::Release(frame_id_t frame_id) {
+  char *frame = GetFrame(frame_id);
+#ifdef __linux__
+  // Anonymous private memory is refilled with zeroes on the next touch.
+  if (madvise(frame, PAGE_SIZE, MADV_DONTNEED) == 0) {
+    return;
+  }
+#endif
+  memset(frame, 0, PAGE_SIZE);
+}
+
+auto FrameArena::NumNumaNodes() -> int {
+  int num_nodes = 0;
+#ifdef __linux__
+  while (access(("/sys/devices/system/node/node" + std::to_string(num_nodes)).c_str(), F_OK) == 0) {
+    num_nodes++;
+  }
+#endif
+  return num_nodes > 0 ? num_nodes : 1;
+}
+
+}  // namespace bustub
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period)
+    : num_pages_(num_pages), k_(k), correlated_period_(correlated_period) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to track at least one reference");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+auto LRUKReplacer::Victim(frame_id_t *frame_id) -> bool {
+  std::scoped_lock latch(latch_);
+  auto &victims = young_.empty() ? old_ : young_;
+  if (victims.empty()) {
+    return false;
+  }
+  *frame_id = victims.begin()->second;
+  victims.erase(victims.begin());
+  // The frame is about to hold a different page, so its history is no longer relevant.
+  frames_.erase(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  auto &frame = it->second;
+  if (frame.evictable_) {
+    RemoveEvictable(frame, frame_id);
+    frame.evictable_ = false;
+  }
+  RecordAccess(&frame);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    if (frames_.size() >= num_pages_) {
+      return;
+    }
+    // First time we see this frame since it was loaded: the load itself is its first reference.
+    it = frames_.emplace(frame_id, FrameHistory{}).first;
+    RecordAccess(&it->second);
+  }
+  auto &frame = it->second;
+  if (!frame.evictable_) {
+    frame.evictable_ = true;
+    AddEvictable(frame, frame_id);
+  }
+}
+
+void LRUKReplacer::AddPrefetched(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  if (frames_.count(frame_id) != 0 || frames_.size() >= num_pages_) {
+    return;
+  }
+  auto &frame = frames_.emplace(frame_id, FrameHistory{}).first->second;
+  RecordAccess(&frame);
+  frame.prefetched_ = true;
+  frame.evictable_ = true;
+  AddEvictable(frame, frame_id);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  if (it->second.evictable_) {
+    RemoveEvictable(it->second, frame_id);
+  }
+  // Like a victim, the frame will hold a different page, which must not inherit the references of the deleted one.
+  frames_.erase(it);
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock latch(latch_);
+  return young_.size() + old_.size();
+}
+
+void LRUKReplacer::GetEvictionCandidates(size_t count, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock latch(latch_);
+  for (const auto *victims : {&young_, &old_}) {
+    for (auto it = victims->begin(); it != victims->end() && frame_ids->size() < count; ++it) {
+      frame_ids->push_back(it->second);
+    }
+  }
+}
+
+void LRUKReplacer::RecordAccess(FrameHistory *frame) {
+  size_t now = ++current_timestamp_;
+  if (frame->prefetched_) {
+    frame->prefetched_ = false;
+    frame->history_.clear();
+  }
+  if (!frame->history_.empty() && now - frame->last_ref_ <= correlated_period_) {
+    frame->last_ref_ = now;
+    return;
+  }
+  frame->last_ref_ = now;
+  frame->history_.push_back(now);
+  if (frame->history_.size() > k_) {
+    frame->history_.pop_front();
+  }
+}
+
+auto LRUKReplacer::EvictionKey(const FrameHistory &frame, frame_id_t frame_id) const
+    -> std::pair<size_t, frame_id_t> {
+  // Either the oldest reference (fewer than k references) or the k-th most recent one: both are the front.
+  return {frame.history_.front(), frame_id};
+}
+
+void LRUKReplacer::AddEvictable(const FrameHistory &frame, frame_id_t frame_id) {
+  auto &victims = frame.history_.size() < k_ ? young_ : old_;
+  victims.insert(EvictionKey(frame, frame_id));
+}
+
+void LRUKReplacer::RemoveEvictable(const FrameHistory &frame, frame_id_t frame_id) {
+  auto &victims = frame.history_.size() < k_ ? young_ : old_;
+  victims.erase(EvictionKey(frame, frame_id));
+}
+
+}  // namespace bustub
@@ -14,16 +14,50 @@
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : num_pages_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
-
-void LRUReplacer::Pin(frame_id_t frame_id) {}
-
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
-
-auto LRUReplacer::Size() -> size_t { return 0; }
+auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool {
+  std::scoped_lock latch(latch_);
+  if (lru_list_.empty()) {
+    return false;
+  }
+  *frame_id = lru_list_.front();
+  lru_map_.erase(*frame_id);
+  lru_list_.pop_front();
+  return true;
+}
+
+void LRUReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  auto it = lru_map_.find(frame_id);
+  if (it == lru_map_.end()) {
+    return;
+  }
+  lru_list_.erase(it->second);
+  lru_map_.erase(it);
+}
+
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  // A frame that is already evictable keeps its original position.
+  if (lru_map_.count(frame_id) != 0 || lru_list_.size() >= num_pages_) {
+    return;
+  }
+  lru_map_.emplace(frame_id, lru_list_.insert(lru_list_.end(), frame_id));
+}
+
+auto LRUReplacer::Size() -> size_t {
+  std::scoped_lock latch(latch_);
+  return lru_list_.size();
+}
+
+void LRUReplacer::GetEvictionCandidates(size_t count, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock latch(latch_);
+  for (auto it = lru_list_.begin(); it != lru_list_.end() && frame_ids->size() < count; ++it) {
+    frame_ids->push_back(*it);
+  }
+}
 
 }  // namespace bustub
@@ -12,58 +12,226 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager) {
+                                                     LogManager *log_manager, bool bind_numa_nodes)
+    : disk_manager_(disk_manager), log_manager_(log_manager), bind_numa_nodes_(bind_numa_nodes) {
   // Allocate and create individual BufferPoolManagerInstances
+  CreateInstances(num_instances, num_instances * pool_size, 0);
+}
+
+void ParallelBufferPoolManager::CreateInstances(size_t num_instances, size_t pool_size, page_id_t first_page_id) {
+  int num_numa_nodes = bind_numa_nodes_ ? FrameArena::NumNumaNodes() : 1;
+  for (size_t i = 0; i < num_instances; ++i) {
+    // Spread the instances over the nodes; on a single node host there is nothing to bind to.
+    int numa_node = num_numa_nodes > 1 ? static_cast<int>(i % num_numa_nodes) : FrameArena::ANY_NUMA_NODE;
+    auto *instance =
+        new BufferPoolManagerInstance(std::max<size_t>(InstancePoolSize(pool_size, num_instances, i), 1), num_instances,
+                                      i, disk_manager_, log_manager_, ReplacerType::LRU, numa_node);
+    instance->SkipPageIdsBelow(first_page_id);
+    if (background_writer_clean_fraction_ > 0) {
+      instance->StartBackgroundWriter(background_writer_clean_fraction_);
+    }
+    instances_.push_back(instance);
+  }
 }
 
 // Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
-ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
 
 auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  std::shared_lock instances_latch(instances_latch_);
   // Get size of all BufferPoolManagerInstances
-  return 0;
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  std::shared_lock instances_latch(instances_latch_);
+  BufferPoolStats stats;
+  for (auto *instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::GetInstanceStats() -> std::vector<BufferPoolStats> {
+  std::shared_lock instances_latch(instances_latch_);
+  std::vector<BufferPoolStats> stats;
+  stats.reserve(instances_.size());
+  for (auto *instance : instances_) {
+    stats.push_back(instance->GetStats());
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::StartBackgroundWriter(double clean_fraction) {
+  std::unique_lock instances_latch(instances_latch_);
+  background_writer_clean_fraction_ = clean_fraction;
+  for (auto *instance : instances_) {
+    instance->StartBackgroundWriter(clean_fraction);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  std::unique_lock instances_latch(instances_latch_);
+  background_writer_clean_fraction_ = 0;
+  for (auto *instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+void ParallelBufferPoolManager::GetDirtyPageTable(std::unordered_map<page_id_t, lsn_t> *dirty_page_table) {
+  std::shared_lock instances_latch(instances_latch_);
+  for (auto *instance : instances_) {
+    instance->GetDirtyPageTable(dirty_page_table);
+  }
+}
+
+auto ParallelBufferPoolManager::ResizePool(size_t pool_size) -> bool {
+  std::shared_lock instances_latch(instances_latch_);
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    size_t instance_pool_size = InstancePoolSize(pool_size, instances_.size(), i);
+    if (instance_pool_size == 0 || instance_pool_size > instances_[i]->GetCapacity()) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->ResizePool(InstancePoolSize(pool_size, instances_.size(), i));
+  }
+  return true;
+}
+
+auto ParallelBufferPoolManager::SetNumInstances(size_t num_instances) -> bool {
+  if (num_instances == 0) {
+    return false;
+  }
+  // Waits for the calls in flight, and keeps new ones out until the instances are rebuilt.
+  std::unique_lock instances_latch(instances_latch_);
+  page_id_t first_page_id = 0;
+  for (auto *instance : instances_) {
+    Page *pages = instance->GetPages();
+    for (size_t i = 0; i < instance->GetCapacity(); ++i) {
+      if (pages[i].GetPinCount() > 0) {
+        return false;
+      }
+    }
+    first_page_id = std::max(first_page_id, instance->GetNextPageId());
+  }
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+    instance->FlushAllPages();
+    delete instance;
+  }
+  instances_.clear();
+  // New pages must not collide with the pages the old instances handed out.
+  CreateInstances(num_instances, pool_size, first_page_id);
+  next_instance_ = 0;
+  return true;
+}
+
+auto ParallelBufferPoolManager::GetNumInstances() -> size_t {
+  std::shared_lock instances_latch(instances_latch_);
+  return instances_.size();
 }
 
 auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
   // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
-  return nullptr;
+  return instances_[page_id % instances_.size()];
 }
 
 auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  std::shared_lock instances_latch(instances_latch_);
   // Fetch page for page_id from responsible BufferPoolManagerInstance
-  return nullptr;
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+void ParallelBufferPoolManager::FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) {
+  std::shared_lock instances_latch(instances_latch_);
+  // Group the requests by instance, remembering where each of them goes in the result
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  std::vector<std::vector<size_t>> instance_positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    size_t instance = page_ids[i] % instances_.size();
+    instance_page_ids[instance].push_back(page_ids[i]);
+    instance_positions[instance].push_back(i);
+  }
+  pages->assign(page_ids.size(), nullptr);
+  std::vector<Page *> instance_pages;
+  for (size_t instance = 0; instance < instances_.size(); ++instance) {
+    if (instance_page_ids[instance].empty()) {
+      continue;
+    }
+    instances_[instance]->FetchPages(instance_page_ids[instance], &instance_pages);
+    for (size_t i = 0; i < instance_pages.size(); ++i) {
+      (*pages)[instance_positions[instance][i]] = instance_pages[i];
+    }
+  }
 }
 
 auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  std::shared_lock instances_latch(instances_latch_);
   // Unpin page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
 }
 
 auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  std::shared_lock instances_latch(instances_latch_);
   // Flush page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
 }
 
 auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  std::shared_lock instances_latch(instances_latch_);
   // create new page. We will request page allocation in a round robin manner from the underlying
   // BufferPoolManagerInstances
   // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
   // starting index and return nullptr
   // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
   // is called
+  size_t start;
+  {
+    std::scoped_lock latch(latch_);
+    start = next_instance_;
+    next_instance_ = (next_instance_ + 1) % instances_.size();
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    Page *page = instances_[(start + i) % instances_.size()]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
   return nullptr;
 }
 
 auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  std::shared_lock instances_latch(instances_latch_);
   // Delete page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
 }
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
+  std::shared_lock instances_latch(instances_latch_);
   // flush all pages from all BufferPoolManagerInstances
+  for (auto *instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+void ParallelBufferPoolManager::PrefetchPgImp(page_id_t page_id) {
+  std::shared_lock instances_latch(instances_latch_);
+  GetBufferPoolManager(page_id)->PrefetchPage(page_id);
 }
 
 }  // namespace bustub
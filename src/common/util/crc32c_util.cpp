@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.cpp
+//
+// Identification: src/common/util/crc32c_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c_util.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Reflected CRC32C polynomial. */
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+using Crc32cTables = std::array<std::array<uint32_t, 256>, 8>;
+
+/** Tables for slicing-by-8: tables[k][b] is the CRC of byte b followed by k zero bytes. */
+constexpr auto MakeCrc32cTables() -> Crc32cTables {
+  Crc32cTables tables{};
+  for (uint32_t b = 0; b < 256; ++b) {
+    uint32_t crc = b;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    tables[0][b] = crc;
+  }
+  for (uint32_t b = 0; b < 256; ++b) {
+    for (size_t k = 1; k < 8; ++k) {
+      tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr Crc32cTables CRC32C_TABLES = MakeCrc32cTables();
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) auto Crc32cHardware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  uint64_t crc64 = crc;
+  for (; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  for (; length > 0; ++data, --length) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+  }
+  return crc32;
+}
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+auto Crc32cHardware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  for (; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc = __crc32cd(crc, word);
+  }
+  for (; length > 0; ++data, --length) {
+    crc = __crc32cb(crc, static_cast<uint8_t>(*data));
+  }
+  return crc;
+}
+#endif
+
+}  // namespace
+
+auto Crc32cUtil::Crc32c(const char *data, size_t length, uint32_t crc) -> uint32_t {
+#if defined(__x86_64__) || (defined(__aarch64__) && defined(__ARM_FEATURE_CRC32))
+  static const bool has_hardware_support = HasHardwareSupport();
+  if (has_hardware_support) {
+    return ~Crc32cHardware(data, length, ~crc);
+  }
+#endif
+  return Crc32cSoftware(data, length, crc);
+}
+
+auto Crc32cUtil::Crc32cSoftware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  crc = ~crc;
+  // Slicing-by-8: fold eight bytes per step through eight tables instead of one byte through one table.
+  for (; length >= 8; data += 8, length -= 8) {
+    uint32_t low;
+    uint32_t high;
+    memcpy(&low, data, sizeof(low));
+    memcpy(&high, data + 4, sizeof(high));
+    low ^= crc;
+    crc = CRC32C_TABLES[7][low & 0xFF] ^ CRC32C_TABLES[6][(low >> 8) & 0xFF] ^ CRC32C_TABLES[5][(low >> 16) & 0xFF] ^
+          CRC32C_TABLES[4][low >> 24] ^ CRC32C_TABLES[3][high & 0xFF] ^ CRC32C_TABLES[2][(high >> 8) & 0xFF] ^
+          CRC32C_TABLES[1][(high >> 16) & 0xFF] ^ CRC32C_TABLES[0][high >> 24];
+  }
+  for (; length > 0; ++data, --length) {
+    crc = (crc >> 8) ^ CRC32C_TABLES[0][(crc ^ static_cast<uint8_t>(*data)) & 0xFF];
+  }
+  return ~crc;
+}
+
+auto Crc32cUtil::HasHardwareSupport() -> bool {
+#if defined(__x86_64__)
+  return __builtin_cpu_supports("sse4.2") != 0;
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace bustub
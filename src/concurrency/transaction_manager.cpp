@@ -30,6 +30,15 @@ auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level)
   if (txn == nullptr) {
     txn = new Transaction(next_txn_id_++, isolation_level);
   }
+  {
+    std::scoped_lock latch(running_txns_latch_);
+    if (enable_logging) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
+      txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+    }
+    running_txns_[txn] = enable_logging ? txn->GetPrevLSN() : INVALID_LSN;
+  }
+
   txn_map_mutex.lock();
   txn_map[txn->GetTransactionId()] = txn;
   txn_map_mutex.unlock();
@@ -52,6 +61,19 @@ void TransactionManager::Commit(Transaction *txn) {
   }
   write_set->clear();
 
+  {
+    std::scoped_lock latch(running_txns_latch_);
+    if (enable_logging) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+      txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+    }
+    running_txns_.erase(txn);
+  }
+  if (enable_logging) {
+    // The commit is durable once its record is; concurrent commits share the flush.
+    log_manager_->WaitForFlush(txn->GetPrevLSN()).get();
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
@@ -102,12 +124,33 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  {
+    std::scoped_lock latch(running_txns_latch_);
+    if (enable_logging) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+      txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+    }
+    running_txns_.erase(txn);
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+auto TransactionManager::GetActiveTransactionTable(std::unordered_map<txn_id_t, lsn_t> *active_txn_table) -> lsn_t {
+  std::scoped_lock latch(running_txns_latch_);
+  lsn_t oldest_begin_lsn = INVALID_LSN;
+  for (const auto &[txn, begin_lsn] : running_txns_) {
+    (*active_txn_table)[txn->GetTransactionId()] = txn->GetPrevLSN();
+    if (oldest_begin_lsn == INVALID_LSN || begin_lsn < oldest_begin_lsn) {
+      oldest_begin_lsn = begin_lsn;
+    }
+  }
+  return oldest_begin_lsn;
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
@@ -11,12 +11,135 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <optional>
+
+#include "common/exception.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+
 namespace bustub {
+
+namespace {
+
+/** @return the comparison that holds with its two sides swapped, so that `c < x` reads as `x > c` */
+auto FlipComparison(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+}  // namespace
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+  index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_);
+  cursor_ = OpenCursor();
+  if (cursor_ == nullptr) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "index " + index_info_->name_ + " does not support scans");
+  }
+}
+
+auto IndexScanExecutor::OpenCursor() -> std::unique_ptr<IndexCursor> {
+  auto *index = index_info_->index_.get();
+  auto *txn = exec_ctx_->GetTransaction();
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(plan_->GetPredicate());
+  if (comparison == nullptr || index->GetKeyAttrs().size() != 1) {
+    return index->ScanRange(nullptr, true, nullptr, true, plan_->IsReverse(), txn);
+  }
+
+  auto comp_type = comparison->GetComparisonType();
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  if (column == nullptr && constant == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    comp_type = FlipComparison(comp_type);
+  }
+  if (column == nullptr || constant == nullptr || column->GetColIdx() != index->GetKeyAttrs()[0] ||
+      comp_type == ComparisonType::NotEqual) {
+    return index->ScanRange(nullptr, true, nullptr, true, plan_->IsReverse(), txn);
+  }
+
+  // A constant that does not fit the key column bounds nothing; the predicate alone decides.
+  std::optional<Tuple> key;
+  bool exact = true;
+  try {
+    auto key_type = index_info_->key_schema_.GetColumn(0).GetType();
+    auto value = constant->Evaluate(nullptr, nullptr);
+    auto key_value = value;
+    if (value.GetTypeId() != key_type) {
+      key_value = value.CastAs(key_type);
+      exact = key_value.CastAs(value.GetTypeId()).CompareEquals(value) == CmpBool::CmpTrue;
+    }
+    key.emplace(std::vector<Value>{key_value}, &index_info_->key_schema_);
+  } catch (Exception &) {
+    return index->ScanRange(nullptr, true, nullptr, true, plan_->IsReverse(), txn);
+  }
 
-void IndexScanExecutor::Init() {}
+  // A cast that lost precision, e.g. 3.5 to 3, leaves a key next to the constant; including it keeps every match.
+  const Tuple *low = nullptr;
+  const Tuple *high = nullptr;
+  bool low_inclusive = true;
+  bool high_inclusive = true;
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      low = high = &*key;
+      break;
+    case ComparisonType::LessThan:
+      high_inclusive = !exact;
+      high = &*key;
+      break;
+    case ComparisonType::LessThanOrEqual:
+      high = &*key;
+      break;
+    case ComparisonType::GreaterThan:
+      low_inclusive = !exact;
+      low = &*key;
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      low = &*key;
+      break;
+    default:
+      break;
+  }
+  return index->ScanRange(low, low_inclusive, high, high_inclusive, plan_->IsReverse(), txn);
+}
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto *predicate = plan_->GetPredicate();
+  const auto &schema = table_info_->schema_;
+  Tuple row;
+  RID row_rid;
+  while (cursor_->Next(&row_rid)) {
+    if (!table_info_->table_->GetTuple(row_rid, &row, exec_ctx_->GetTransaction())) {
+      continue;
+    }
+    if (predicate != nullptr && !predicate->Evaluate(&row, &schema).GetAs<bool>()) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(GetOutputSchema()->GetColumnCount());
+    for (const auto &column : GetOutputSchema()->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&row, &schema));
+    }
+    *tuple = Tuple(values, GetOutputSchema());
+    *rid = row_rid;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
@@ -15,7 +15,9 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -84,9 +86,63 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a batch of pages, pinning each of them as FetchPage does. The pages that miss are read from disk together.
+   * @param page_ids ids of pages to be fetched, a page listed twice is pinned twice
+   * @param[out] pages the requested pages in the order of page_ids, nullptr for a page that could not be fetched
+   */
+  void FetchPages(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) { FetchPgsImp(page_ids, pages); }
+
+  /**
+   * Asynchronously read a page into the buffer pool without pinning it, so that a later FetchPage hits. This is only a
+   * hint: it never evicts a pinned page and may be dropped.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPage(page_id_t page_id) { PrefetchPgImp(page_id); }
+
+  /**
+   * Asynchronously read a range of pages into the buffer pool without pinning them.
+   * @param first_page_id id of the first page to be prefetched
+   * @param last_page_id id one past the last page to be prefetched
+   */
+  void PrefetchPages(page_id_t first_page_id, page_id_t last_page_id) {
+    for (page_id_t page_id = first_page_id; page_id < last_page_id; ++page_id) {
+      PrefetchPgImp(page_id);
+    }
+  }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /**
+   * Change the number of frames of the buffer pool while it is in use. Growing hands out new free frames right away.
+   * Shrinking evicts unpinned pages and gives their memory back, frames that are pinned follow once they are unpinned.
+   * @param pool_size the new size of the buffer pool
+   * @return false if the buffer pool cannot take this size
+   */
+  virtual auto ResizePool(size_t pool_size) -> bool { return false; }
+
+  /** @return a snapshot of the activity counters of the buffer pool */
+  virtual auto GetStats() -> BufferPoolStats = 0;
+
+  /**
+   * Start writing dirty, unpinned pages back to disk ahead of their eviction from a background thread.
+   * @param clean_fraction the fraction of the eviction candidates that the background writer keeps clean
+   */
+  virtual void StartBackgroundWriter(double clean_fraction) {}
+
+  /** Stop and join the background writer, if it is running. */
+  virtual void StopBackgroundWriter() {}
+
+  /**
+   * Collect the dirty page table for a checkpoint: every page that may differ from its copy on disk, with its recLSN.
+   * @param[out] dirty_page_table page ids mapped to the first LSN whose change may be missing from the page on disk
+   */
+  virtual void GetDirtyPageTable(std::unordered_map<page_id_t, lsn_t> *dirty_page_table) {}
+
+  /** Sync the pages flushed so far to stable storage, e.g. before their changes stop being logged or kept in it. */
+  virtual void SyncPages() {}
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -108,6 +164,18 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch a batch of pages from the buffer pool. Buffer pools that cannot batch fetch the pages one at a time.
+   * @param page_ids ids of pages to be fetched
+   * @param[out] pages the requested pages, nullptr for a page that could not be fetched
+   */
+  virtual void FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) {
+    pages->clear();
+    for (page_id_t page_id : page_ids) {
+      pages->push_back(FetchPgImp(page_id));
+    }
+  }
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -141,5 +209,12 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Asynchronously reads a page into the buffer pool without pinning it. Buffer pools that do not support prefetching
+   * ignore the hint.
+   * @param page_id id of page to be prefetched
+   */
+  virtual void PrefetchPgImp(page_id_t page_id) {}
 };
 }  // namespace bustub
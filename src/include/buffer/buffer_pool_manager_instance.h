@@ -12,11 +12,20 @@
 
 #pragma once
 
+#include <array>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -34,8 +43,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param numa_node NUMA node whose memory should hold the frames, or FrameArena::ANY_NUMA_NODE
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU,
+                            int numa_node = FrameArena::ANY_NUMA_NODE);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +56,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param numa_node NUMA node whose memory should hold the frames, or FrameArena::ANY_NUMA_NODE
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU,
+                            int numa_node = FrameArena::ANY_NUMA_NODE);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -55,9 +72,42 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return size of the buffer pool */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
-  /** @return pointer to all the pages in the buffer pool */
+  /** @return the largest size the buffer pool can be resized to */
+  auto GetCapacity() -> size_t { return capacity_; }
+
+  /**
+   * Resize the buffer pool, up to GetCapacity() frames.
+   * @param pool_size the new size of the buffer pool
+   * @return false if pool_size is 0 or larger than the capacity
+   */
+  auto ResizePool(size_t pool_size) -> bool override;
+
+  /** @return the page id this instance hands out next */
+  auto GetNextPageId() -> page_id_t { return next_page_id_; }
+
+  /**
+   * Make the page id allocator of this instance skip all page ids below the given one.
+   * @param page_id lower bound for the page ids handed out from now on
+   */
+  void SkipPageIdsBelow(page_id_t page_id);
+
+  /** @return pointer to all the pages in the buffer pool, including the frames beyond the current pool size */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @return the arena holding the data of all the pages in the buffer pool */
+  auto GetFrameArena() -> FrameArena * { return frame_arena_; }
+
+  void StartBackgroundWriter(double clean_fraction) override;
+
+  void StopBackgroundWriter() override;
+
+  auto GetStats() -> BufferPoolStats override { return stats_.Snapshot(); }
+
+  /** A page is in the dirty page table if it is dirty, or pinned and so possibly being changed. */
+  void GetDirtyPageTable(std::unordered_map<page_id_t, lsn_t> *dirty_page_table) override;
+
+  void SyncPages() override { disk_manager_->SyncPages(); }
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -66,6 +116,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * Fetch a batch of pages from the buffer pool. Hits are pinned without latch_, then latch_ is taken once to find
+   * frames for all misses, which are read from disk in a single batch.
+   * @param page_ids ids of pages to be fetched
+   * @param[out] pages the requested pages, nullptr for a page that could not be fetched
+   */
+  void FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -75,9 +133,9 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
 
   /**
-   * Flushes the target page to disk.
+   * Flushes the target page to disk. The caller must not hold the latch of the page.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
-   * @return false if the page could not be found in the page table, true otherwise
+   * @return false if the page could not be found in the page table or written, true otherwise
    */
   auto FlushPgImp(page_id_t page_id) -> bool override;
 
@@ -100,6 +158,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Queues a page to be read into the buffer pool by the prefetch thread. Pages that are resident or that have not
+   * been allocated by this instance are ignored.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
   /**
    * Allocate a page on disk.∂
    * @return the id of the allocated page
@@ -121,8 +186,95 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /**
+   * Fast path of FetchPgImp: pin the page if it is resident, without taking latch_.
+   * @param page_id id of page to be pinned
+   * @return the pinned page, or nullptr if the page is not resident or is being evicted
+   */
+  auto TryPinResident(page_id_t page_id) -> Page *;
+
+  /**
+   * Find a frame to hold a new page, from the free list first and then from the replacer. A dirty victim is written
+   * back and removed from the page table. Victims whose log records are not yet persistent, or that fail to be
+   * written, are passed over and stay resident. Must be called with latch_ held.
+   * @param[out] frame_id id of the frame, whose pin count is left negative so that nobody else can pin it
+   * @param[out] wait_lsn if not nullptr, the LSN the log has to reach for a victim that was passed over to become
+   * writable, or INVALID_LSN if there is none
+   * @return false if every frame is pinned or passed over
+   */
+  auto AcquireFrame(frame_id_t *frame_id, lsn_t *wait_lsn = nullptr) -> bool;
+
+  /**
+   * AcquireFrame, but when only victims that wait for the log are left, flush the log with latch_ released and try
+   * again. The caller must look again at anything it checked under latch_ before.
+   */
+  auto AcquireFrameWaitingForLog(std::unique_lock<std::mutex> *latch, frame_id_t *frame_id) -> bool;
+
+  /** @return true if the page has changes whose log records are not yet persistent, so it must not be written */
+  auto NeedsLogFlush(Page *page) -> bool;
+
+  /**
+   * Write a resident page back to disk under its read latch, waiting for the log first if the page has changes that
+   * are not yet persistent there. The caller pins the frame, which keeps the page from being evicted, and must not
+   * hold latch_: the page latch and the log can both take long, and a thread holding the page latch may need latch_.
+   * @return false if the page could not be written, in which case it stays dirty
+   */
+  auto FlushFrame(Page *page) -> bool;
+
+  /** Drop a pin taken to write a frame back, bypassing the replacer, and hand the frame back to it if it was last. */
+  void UnpinAfterWrite(frame_id_t frame_id);
+
+  /** Put a frame that holds no page back on the free list, or release it if the pool is shrinking. Requires latch_. */
+  void FreeFrame(frame_id_t frame_id);
+
+  /** Give the memory of a frame back and keep the frame aside until the pool grows again. Requires latch_. */
+  void ReleaseFrame(frame_id_t frame_id);
+
+  /** Release frames while a shrink of the pool is pending and there are free or evictable frames. Requires latch_. */
+  void ReleasePendingFrames();
+
+  /** Main loop of the background writer thread. */
+  void RunBackgroundWriter();
+
+  /**
+   * Write back dirty pages among the next eviction candidates, until clean_fraction of them are clean. Pages whose
+   * LSN is not yet persistent in the log are skipped, so the WAL rule is never broken.
+   */
+  void CleanEvictionCandidates();
+
+  /** Main loop of the prefetch thread. */
+  void RunPrefetcher();
+
+  /** Read a page into a free or evictable frame and leave it unpinned. */
+  void LoadPrefetchedPage(page_id_t page_id);
+
+  /** Start the recLSN of a page that is being pinned while clean at the next LSN of the log. */
+  void StartRecLSN(Page *page);
+
+  /** Acquire latch_, accounting the time spent waiting for it as pin wait time. */
+  auto LockAndTime() -> std::unique_lock<std::mutex>;
+
+  /** @return true if the page is in the page table */
+  auto IsResident(page_id_t page_id) -> bool;
+
+  /** A shard of the page table. The shard latch is only held for the hash lookup and the pin count CAS. */
+  struct PageTableShard {
+    std::shared_mutex latch_;
+    std::unordered_map<page_id_t, frame_id_t> table_;
+  };
+
+  /** @return the page table shard responsible for the given page id */
+  auto GetShard(page_id_t page_id) -> PageTableShard & {
+    return page_table_[(static_cast<uint32_t>(page_id) / num_instances_) % PAGE_TABLE_SHARDS];
+  }
+
+  /** Number of page table shards per instance. */
+  static constexpr size_t PAGE_TABLE_SHARDS = 16;
+
+  /** Number of pages in the buffer pool. Changed by ResizePool with latch_ held. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames allocated up front, the largest size the buffer pool can grow to. */
+  const size_t capacity_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
@@ -130,19 +282,50 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
   std::atomic<page_id_t> next_page_id_ = instance_index_;
 
-  /** Array of buffer pool pages. */
+  /** Array of buffer pool pages. Only the bookkeeping is kept here, the page data lives in frame_arena_. */
   Page *pages_;
+  /** Contiguous memory holding the data of all buffer pool pages. */
+  FrameArena *frame_arena_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  LogManager *log_manager_;
+  /** Page table for keeping track of buffer pool pages, sharded by page id. */
+  std::array<PageTableShard, PAGE_TABLE_SHARDS> page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /** Frames beyond the current pool size. Their memory is given back to the operating system. */
+  std::list<frame_id_t> released_frames_;
+  /** Number of frames that a shrink still has to release once they are unpinned. Changed with latch_ held. */
+  std::atomic<size_t> frames_to_release_{0};
+  /**
+   * This latch protects free_list_ and released_frames_ and serializes the slow path: misses, evictions, NewPgImp,
+   * DeletePgImp, flushes and resizes. Hits and unpins only take the shard latch of the page.
+   */
   std::mutex latch_;
+
+  /** Activity counters of this instance. */
+  BufferPoolStatsCounters stats_;
+  /** The background writer thread, nullptr if it is not running. */
+  std::thread *background_writer_thread_{nullptr};
+  /** Fraction of the eviction candidates that the background writer keeps clean. */
+  double background_writer_clean_fraction_{0};
+  /** True while the background writer should keep running. */
+  bool background_writer_running_{false};
+  /** Protects the background writer state above and wakes the writer up on shutdown. */
+  std::mutex background_writer_latch_;
+  std::condition_variable background_writer_cv_;
+
+  /** Pages waiting to be prefetched. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** The prefetch thread, started by the first prefetch request. */
+  std::thread *prefetch_thread_{nullptr};
+  /** True while the prefetch thread should keep running. */
+  bool prefetch_running_{false};
+  /** Protects the prefetch state above and wakes the prefetch thread up. */
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
 };
 }  // namespace bustub
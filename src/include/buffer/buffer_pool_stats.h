@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+/**
+ * A snapshot of the activity of a buffer pool, accumulated since it was created.
+ */
+struct BufferPoolStats {
+  /** FetchPage calls served by a resident page. */
+  uint64_t hits_{0};
+  /** FetchPage calls that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Frames reclaimed from the replacer to hold another page. */
+  uint64_t evictions_{0};
+  /** Dirty victims written back on the miss path, i.e. paid for by a foreground request. */
+  uint64_t foreground_writes_{0};
+  /** Dirty pages written back ahead of eviction by the background writer. */
+  uint64_t background_writes_{0};
+  /** Pages read into the pool by the prefetch thread. */
+  uint64_t prefetches_{0};
+  /** Pages that could not be read into the pool, or failed their checksum. */
+  uint64_t read_failures_{0};
+  /** Time, in nanoseconds, that FetchPage and NewPage spent waiting for the buffer pool latch. */
+  uint64_t pin_wait_ns_{0};
+
+  /** Add the counters of another snapshot, e.g. of another buffer pool instance. */
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    evictions_ += other.evictions_;
+    foreground_writes_ += other.foreground_writes_;
+    background_writes_ += other.background_writes_;
+    prefetches_ += other.prefetches_;
+    read_failures_ += other.read_failures_;
+    pin_wait_ns_ += other.pin_wait_ns_;
+    return *this;
+  }
+
+  /** @return the fraction of FetchPage calls that hit, 0 if there were none */
+  auto HitRatio() const -> double {
+    uint64_t fetches = hits_ + misses_;
+    return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+  }
+};
+
+/**
+ * The live counters behind BufferPoolStats. Counters are striped over cache-line aligned slots picked by thread, and
+ * updated with relaxed atomics, so that counting a hit does not make every thread write to the same cache line.
+ */
+class BufferPoolStatsCounters {
+ public:
+  /** One stripe of counters, mirroring the fields of BufferPoolStats. */
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> foreground_writes_{0};
+    std::atomic<uint64_t> background_writes_{0};
+    std::atomic<uint64_t> prefetches_{0};
+    std::atomic<uint64_t> read_failures_{0};
+    std::atomic<uint64_t> pin_wait_ns_{0};
+  };
+
+  /**
+   * Add to a counter of the calling thread's stripe.
+   * @param counter the counter, e.g. &Stripe::hits_
+   * @param amount the amount to add
+   */
+  void Add(std::atomic<uint64_t> Stripe::*counter, uint64_t amount = 1) {
+    (LocalStripe().*counter).fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  /** @return the sum of all stripes. Concurrent updates may or may not be included. */
+  auto Snapshot() const -> BufferPoolStats {
+    BufferPoolStats stats;
+    for (const auto &stripe : stripes_) {
+      stats.hits_ += stripe.hits_.load(std::memory_order_relaxed);
+      stats.misses_ += stripe.misses_.load(std::memory_order_relaxed);
+      stats.evictions_ += stripe.evictions_.load(std::memory_order_relaxed);
+      stats.foreground_writes_ += stripe.foreground_writes_.load(std::memory_order_relaxed);
+      stats.background_writes_ += stripe.background_writes_.load(std::memory_order_relaxed);
+      stats.prefetches_ += stripe.prefetches_.load(std::memory_order_relaxed);
+      stats.read_failures_ += stripe.read_failures_.load(std::memory_order_relaxed);
+      stats.pin_wait_ns_ += stripe.pin_wait_ns_.load(std::memory_order_relaxed);
+    }
+    return stats;
+  }
+
+ private:
+  static constexpr size_t NUM_STRIPES = 16;
+
+  auto LocalStripe() -> Stripe & {
+    static thread_local size_t stripe_index = std::hash<std::thread::id>()(std::this_thread::get_id()) % NUM_STRIPES;
+    return stripes_[stripe_index];
+  }
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+}  // namespace bustub
@@ -45,8 +45,23 @@ class ClockReplacer : public Replacer {
 
   auto Size() -> size_t override;
 
+  void GetEvictionCandidates(size_t count, std::vector<frame_id_t> *frame_ids) override;
+
  private:
-  // TODO(student): implement me!
+  /** Per-frame clock state. */
+  struct FrameState {
+    bool in_replacer_{false};
+    bool ref_{false};
+  };
+
+  /** Clock state of every frame, indexed by frame id. */
+  std::vector<FrameState> frames_;
+  /** Position of the clock hand. */
+  size_t hand_{0};
+  /** Number of frames currently in the replacer. */
+  size_t size_{0};
+  /** Protects frames_, hand_ and size_. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of all frames of a buffer pool in one contiguous, zeroed mapping. Arenas of at least
+ * HUGE_PAGE_SIZE are aligned to and advised for transparent huge pages, so a scan over the pool touches few TLB
+ * entries. The Page bookkeeping (pin count, dirty flag, latch) lives in a separate array and only points in here.
+ */
+class FrameArena {
+ public:
+  /** Passed as numa_node to leave memory placement to the kernel. */
+  static constexpr int ANY_NUMA_NODE = -1;
+
+  /**
+   * Map a new arena.
+   * @param num_frames number of PAGE_SIZE frames in the arena
+   * @param numa_node NUMA node whose memory should back the arena, or ANY_NUMA_NODE
+   */
+  explicit FrameArena(size_t num_frames, int numa_node = ANY_NUMA_NODE);
+
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  auto operator=(const FrameArena &) -> FrameArena & = delete;
+
+  /** @return the data of the given frame */
+  inline auto GetFrame(frame_id_t frame_id) -> char * { return data_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /**
+   * Give the memory of a frame back to the operating system. The frame stays mapped and reads as zeroes when it is
+   * used again.
+   * @param frame_id the frame to release
+   */
+  void Release(frame_id_t frame_id);
+
+  /** @return true if the kernel was asked to back the arena with huge pages */
+  inline auto IsHugePageBacked() const -> bool { return huge_pages_; }
+
+  /** @return the NUMA node the arena is bound to, or ANY_NUMA_NODE */
+  inline auto GetNumaNode() const -> int { return numa_node_; }
+
+  /** @return the number of NUMA nodes of this host, 1 where NUMA is not supported */
+  static auto NumNumaNodes() -> int;
+
+ private:
+  /** Start of the frame data. */
+  char *data_{nullptr};
+  /** Start and length of the whole mapping, which may be larger than the frame data because of alignment. */
+  void *mapping_{nullptr};
+  size_t mapping_size_{0};
+  /** True if the arena was advised for huge pages. */
+  bool huge_pages_{false};
+  /** NUMA node the arena is bound to, or ANY_NUMA_NODE. */
+  int numa_node_{ANY_NUMA_NODE};
+};
+
+}  // namespace bustub
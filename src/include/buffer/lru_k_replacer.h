@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose backward k-distance, i.e. the time since its k-th most recent reference,
+ * is the largest. Frames with fewer than k references have an infinite backward k-distance and are evicted first, in
+ * the order of their oldest reference. A page touched once by a sequential scan therefore never pushes out a page
+ * that has been referenced k times.
+ *
+ * A reference is recorded when a frame is first unpinned after being loaded and every time it is pinned again.
+ * A prefetched page enters the replacer with a placeholder reference that its first real reference replaces, so read
+ * ahead does not make a page scanned once look like it was referenced twice.
+ *
+ * References that fall within the correlated reference period of the previous one (e.g. an operator that pins and
+ * unpins the same page in a tight loop) count as a single reference.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references tracked per frame
+   * @param correlated_period references at most this many ticks after the previous one are correlated
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        size_t correlated_period = LRUK_CORRELATED_REFERENCE_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void AddPrefetched(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void GetEvictionCandidates(size_t count, std::vector<frame_id_t> *frame_ids) override;
+
+ private:
+  /** Reference history of a frame. */
+  struct FrameHistory {
+    /** Timestamps of the last k uncorrelated references, most recent at the back. */
+    std::list<size_t> history_;
+    /** Timestamp of the last reference, correlated or not. */
+    size_t last_ref_{0};
+    /** True if the frame is in the replacer, i.e. can be victimized. */
+    bool evictable_{false};
+    /** True if the page was prefetched and not referenced since; its only history entry is the prefetch time. */
+    bool prefetched_{false};
+  };
+
+  /** Record a reference to the frame at the current timestamp. */
+  void RecordAccess(FrameHistory *frame);
+
+  /** @return the ordering key of an evictable frame in its eviction set */
+  auto EvictionKey(const FrameHistory &frame, frame_id_t frame_id) const -> std::pair<size_t, frame_id_t>;
+
+  /** Add or remove an evictable frame from the eviction set it belongs to. */
+  void AddEvictable(const FrameHistory &frame, frame_id_t frame_id);
+  void RemoveEvictable(const FrameHistory &frame, frame_id_t frame_id);
+
+  /** Maximum number of frames the replacer tracks. */
+  size_t num_pages_;
+  /** Number of references tracked per frame. */
+  size_t k_;
+  /** Length of the correlated reference period, in ticks. */
+  size_t correlated_period_;
+  /** Logical clock, advanced on every recorded reference. */
+  size_t current_timestamp_{0};
+  /** Reference history of every frame the replacer has seen since it was last victimized. */
+  std::unordered_map<frame_id_t, FrameHistory> frames_;
+  /** Evictable frames with fewer than k references, ordered by their oldest reference. */
+  std::set<std::pair<size_t, frame_id_t>> young_;
+  /** Evictable frames with k references, ordered by their k-th most recent reference. */
+  std::set<std::pair<size_t, frame_id_t>> old_;
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
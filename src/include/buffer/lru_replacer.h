@@ -14,6 +14,7 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -45,8 +46,17 @@ class LRUReplacer : public Replacer {
 
   auto Size() -> size_t override;
 
+  void GetEvictionCandidates(size_t count, std::vector<frame_id_t> *frame_ids) override;
+
  private:
-  // TODO(student): implement me!
+  /** Maximum number of frames the replacer tracks. */
+  size_t num_pages_;
+  /** Evictable frames, least recently unpinned at the front. */
+  std::list<frame_id_t> lru_list_;
+  /** Maps a frame to its position in lru_list_ for O(1) removal. */
+  std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> lru_map_;
+  /** Protects lru_list_ and lru_map_. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
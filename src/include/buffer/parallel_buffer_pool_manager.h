@@ -12,7 +12,12 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -27,9 +32,10 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param bind_numa_nodes if true, the frames of instance i are bound to NUMA node i % number of nodes
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, bool bind_numa_nodes = false);
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -39,10 +45,58 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   auto GetPoolSize() -> size_t override;
 
+  /** @return the activity counters of all BufferPoolManagerInstances added up */
+  auto GetStats() -> BufferPoolStats override;
+
+  /** @return the activity counters of each BufferPoolManagerInstance, indexed by instance */
+  auto GetInstanceStats() -> std::vector<BufferPoolStats>;
+
+  void StartBackgroundWriter(double clean_fraction) override;
+
+  void StopBackgroundWriter() override;
+
+  void GetDirtyPageTable(std::unordered_map<page_id_t, lsn_t> *dirty_page_table) override;
+
+  /** The instances share the disk manager, so one sync covers them all. */
+  void SyncPages() override { disk_manager_->SyncPages(); }
+
+  /**
+   * Resize the buffer pool, spreading the frames evenly over the BufferPoolManagerInstances.
+   * @param pool_size the new size of the whole buffer pool
+   * @return false if an instance cannot take its share
+   */
+  auto ResizePool(size_t pool_size) -> bool override;
+
+  /**
+   * Add or remove BufferPoolManagerInstances, keeping the size of the whole buffer pool. Pages are still routed by
+   * page_id % num_instances, so every cached page moves to another instance: all pages are flushed and the instances
+   * are rebuilt. Calls on the buffer pool that run meanwhile wait for the new instances. Page pointers handed out
+   * before must not be used once the pages are unpinned, as always, since the frames behind them are freed.
+   * @param num_instances the new number of instances
+   * @return false if num_instances is 0 or a page is still pinned
+   */
+  auto SetNumInstances(size_t num_instances) -> bool;
+
+  /** @return the number of BufferPoolManagerInstances */
+  auto GetNumInstances() -> size_t;
+
  protected:
+  /**
+   * Create the BufferPoolManagerInstances, spreading pool_size frames over them.
+   * @param num_instances number of instances to create
+   * @param pool_size size of the whole buffer pool
+   * @param first_page_id lower bound for the page ids the new instances hand out
+   */
+  void CreateInstances(size_t num_instances, size_t pool_size, page_id_t first_page_id);
+
+  /** @return the share of pool_size frames of the given instance when spread over num_instances */
+  static auto InstancePoolSize(size_t pool_size, size_t num_instances, size_t instance) -> size_t {
+    return pool_size / num_instances + (instance < pool_size % num_instances ? 1 : 0);
+  }
+
   /**
    * @param page_id id of page
-   * @return pointer to the BufferPoolManager responsible for handling given page id
+   * @return pointer to the BufferPoolManager responsible for handling given page id. Requires instances_latch_.
    */
   auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager *;
 
@@ -53,6 +107,13 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * Fetch a batch of pages, handing each BufferPoolManagerInstance its share of the batch in a single call.
+   * @param page_ids ids of pages to be fetched
+   * @param[out] pages the requested pages, nullptr for a page that could not be fetched
+   */
+  void FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -86,5 +147,29 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   void FlushAllPgsImp() override;
+
+  /**
+   * Forwards a prefetch hint to the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
+  /** The individual BufferPoolManagerInstances; page_id is handled by instances_[page_id % num_instances]. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /**
+   * Protects instances_ and background_writer_clean_fraction_. Held shared by every call that is forwarded to the
+   * instances, and exclusively while the instances are rebuilt or their background writers started or stopped.
+   */
+  std::shared_mutex instances_latch_;
+  /** The instance NewPgImp starts searching from. */
+  size_t next_instance_{0};
+  /** Protects next_instance_. */
+  std::mutex latch_;
+  /** Kept to rebuild the instances when their number changes. */
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
+  bool bind_numa_nodes_;
+  /** Clean fraction of the running background writer, 0 if it is not running. */
+  double background_writer_clean_fraction_{0};
 };
 }  // namespace bustub
@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** Replacement policies a buffer pool can be configured with. */
+enum class ReplacerType { LRU, CLOCK, LRU_K };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,8 +48,29 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Adds a frame holding a prefetched page, which has been loaded but not referenced yet. By default this is the same
+   * as unpinning it.
+   * @param frame_id the id of the frame holding the prefetched page
+   */
+  virtual void AddPrefetched(frame_id_t frame_id) { Unpin(frame_id); }
+
+  /**
+   * Forgets a frame whose page was deleted, along with anything the replacer remembers about its use. By default this
+   * is the same as pinning it.
+   * @param frame_id the id of the frame to forget
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * Peek at the frames that would be victimized next, without removing them.
+   * @param count the maximum number of frames to return
+   * @param[out] frame_ids the frames, in the order they would be victimized
+   */
+  virtual void GetEvictionCandidates(size_t count, std::vector<frame_id_t> *frame_ids) = 0;
 };
 
 }  // namespace bustub
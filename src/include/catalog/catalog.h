@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -21,6 +22,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
@@ -57,6 +59,9 @@ struct TableInfo {
   const table_oid_t oid_;
 };
 
+/** The kinds of index that the catalog can build. */
+enum class IndexType { HashTable, BPlusTree };
+
 /**
  * The IndexInfo class maintains metadata about a index.
  */
@@ -186,12 +191,15 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param index_type The kind of index to build; only a B+ tree keeps keys in order for range scans
+   * @param is_unique Whether a key maps to at most one tuple; a B+ tree keeps several as a posting list
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, IndexType index_type = IndexType::HashTable,
+                   bool is_unique = true) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -208,14 +216,32 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique);
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::BPlusTree) {
+      index = MakeIndex<KeyType, KeyComparator>(
+          std::move(meta), [this](auto &&index_meta, auto *comparator) -> std::unique_ptr<Index> {
+            using Comparator = std::remove_pointer_t<decltype(comparator)>;
+            if constexpr (!BPlusTreeLayoutTraits<KeyType, Comparator>::POSTING_LISTS) {
+              // Only pages of key and value pairs keep posting lists, so duplicate keys keep the given comparator.
+              if (!index_meta->IsUnique()) {
+                return std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(index_meta),
+                                                                                           bpm_, log_manager_);
+              }
+            }
+            return std::make_unique<BPlusTreeIndex<KeyType, ValueType, Comparator>>(std::move(index_meta), bpm_,
+                                                                                    log_manager_);
+          });
+    } else {
+      index = MakeIndex<KeyType, KeyComparator>(
+          std::move(meta), [this, &hash_function](auto &&index_meta, auto *comparator) {
+            using Comparator = std::remove_pointer_t<decltype(comparator)>;
+            return std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, Comparator>>(std::move(index_meta),
+                                                                                              bpm_, hash_function);
+          });
+    }
 
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
@@ -323,6 +349,36 @@ class Catalog {
   }
 
  private:
+  /**
+   * Construct an index with make, which takes the metadata and a null pointer of the comparator type to build it with.
+   * Integer keys that the caller compares with GenericComparator get an IntegerComparator instead, which compares the
+   * key bytes in place rather than through Values.
+   */
+  template <class KeyType, class KeyComparator, class MakeFunction>
+  auto MakeIndex(std::unique_ptr<IndexMetadata> &&meta, const MakeFunction &make) -> std::unique_ptr<Index> {
+    constexpr std::size_t KEY_SIZE = sizeof(KeyType);
+    if constexpr (std::is_same_v<KeyComparator, GenericComparator<KEY_SIZE>> && KEY_SIZE <= 16) {
+      const Schema &key_schema = *meta->GetKeySchema();
+      if (IntegerComparator<KEY_SIZE, int32_t>::Accepts(key_schema)) {
+        return make(std::move(meta), static_cast<IntegerComparator<KEY_SIZE, int32_t> *>(nullptr));
+      }
+      if constexpr (KEY_SIZE >= 8) {
+        if (IntegerComparator<KEY_SIZE, int64_t>::Accepts(key_schema)) {
+          return make(std::move(meta), static_cast<IntegerComparator<KEY_SIZE, int64_t> *>(nullptr));
+        }
+        if (IntegerComparator<KEY_SIZE, int32_t, 2>::Accepts(key_schema)) {
+          return make(std::move(meta), static_cast<IntegerComparator<KEY_SIZE, int32_t, 2> *>(nullptr));
+        }
+      }
+      if constexpr (KEY_SIZE >= 16) {
+        if (IntegerComparator<KEY_SIZE, int64_t, 2>::Accepts(key_schema)) {
+          return make(std::move(meta), static_cast<IntegerComparator<KEY_SIZE, int64_t, 2> *>(nullptr));
+        }
+      }
+    }
+    return make(std::move(meta), static_cast<KeyComparator *>(nullptr));
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -43,6 +43,7 @@ class BustubInstance {
   }
 
   ~BustubInstance() {
+    StopBackgroundWriter();
     if (enable_logging) {
       log_manager_->StopFlushThread();
     }
@@ -54,6 +55,17 @@ class BustubInstance {
     delete disk_manager_;
   }
 
+  /**
+   * Start the buffer pool background writer, which writes dirty pages back ahead of their eviction.
+   * @param clean_fraction the fraction of the eviction candidates that are kept clean
+   */
+  void StartBackgroundWriter(double clean_fraction = BACKGROUND_WRITER_CLEAN_FRACTION) {
+    buffer_pool_manager_->StartBackgroundWriter(clean_fraction);
+  }
+
+  /** Stop the buffer pool background writer. */
+  void StopBackgroundWriter() { buffer_pool_manager_->StopBackgroundWriter(); }
+
   DiskManager *disk_manager_;
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
@@ -27,6 +27,9 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background writer of the buffer pool cleans eviction candidates every BACKGROUND_WRITER_INTERVAL. */
+extern std::chrono::milliseconds background_writer_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,6 +38,16 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // k of the LRU-K replacer
+static constexpr int LRUK_CORRELATED_REFERENCE_PERIOD = 0;                    // LRU-K correlated reference period
+static constexpr double BACKGROUND_WRITER_CLEAN_FRACTION = 0.25;              // eviction candidates kept clean
+static constexpr int READ_AHEAD_WINDOW = 8;                                   // pages prefetched by sequential scans
+static constexpr size_t HUGE_PAGE_SIZE = 2097152;                             // huge page size for the frame arena
+static constexpr int BUFFER_POOL_MAX_GROWTH = 4;                              // max pool size / initial pool size
+static constexpr int DISK_IO_THREADS = 4;                                     // threads of the pread/pwrite backend
+static constexpr int DISK_IO_QUEUE_DEPTH = 64;                                // io_uring submission queue entries
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;                           // buffer alignment required by O_DIRECT
+static constexpr int LOG_SEGMENT_SIZE = 16 * 1024 * 1024;                     // size of a log segment file in byte
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
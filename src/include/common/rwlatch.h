@@ -48,6 +48,19 @@ class ReaderWriterLatch {
     }
   }
 
+  /**
+   * Acquire a write latch if no one holds the latch.
+   * @return false, without waiting, if a reader or a writer holds it
+   */
+  auto TryWLock() -> bool {
+    std::lock_guard<mutex_t> guard(mutex_);
+    if (writer_entered_ || reader_count_ > 0) {
+      return false;
+    }
+    writer_entered_ = true;
+    return true;
+  }
+
   /**
    * Release a write latch.
    */
@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.h
+//
+// Identification: src/include/common/util/crc32c_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32cUtil computes CRC32C (Castagnoli) checksums, using the CRC32 instruction of SSE 4.2 or ARMv8 when the CPU has
+ * it and a table driven software implementation otherwise.
+ */
+class Crc32cUtil {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param length number of bytes
+   * @param crc checksum of the preceding bytes, to checksum a buffer piece by piece
+   * @return the CRC32C of the bytes
+   */
+  static auto Crc32c(const char *data, size_t length, uint32_t crc = 0) -> uint32_t;
+
+  /** Same as Crc32c, but never uses the CRC32 instruction. */
+  static auto Crc32cSoftware(const char *data, size_t length, uint32_t crc = 0) -> uint32_t;
+
+  /** @return true if Crc32c runs on the CRC32 instruction of this CPU */
+  static auto HasHardwareSupport() -> bool;
+};
+
+}  // namespace bustub
@@ -268,8 +268,8 @@ class Transaction {
   std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
   /** The undo set of indexes. */
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
-  /** The LSN of the last record written by the transaction. */
-  lsn_t prev_lsn_;
+  /** The LSN of the last record written by the transaction, read by checkpoints from other threads. */
+  std::atomic<lsn_t> prev_lsn_;
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
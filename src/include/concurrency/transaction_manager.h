@@ -13,6 +13,7 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -78,6 +79,13 @@ class TransactionManager {
     return res;
   }
 
+  /**
+   * Collect the active transaction table for a fuzzy checkpoint.
+   * @param[out] active_txn_table ids of the running transactions mapped to the LSN of their last log record
+   * @return the LSN of the oldest BEGIN record among them, which undo may have to read back to, or INVALID_LSN
+   */
+  auto GetActiveTransactionTable(std::unordered_map<txn_id_t, lsn_t> *active_txn_table) -> lsn_t;
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -104,10 +112,18 @@ class TransactionManager {
 
   std::atomic<txn_id_t> next_txn_id_{0};
   LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** The transactions that have begun and not yet committed or aborted, mapped to the LSN of their BEGIN record. */
+  std::unordered_map<Transaction *, lsn_t> running_txns_;
+  /**
+   * Protects running_txns_. BEGIN, COMMIT and ABORT records are appended with it held, so that a checkpoint sees a
+   * transaction as running exactly when its BEGIN record precedes the checkpoint and its end record does not.
+   */
+  std::mutex running_txns_latch_;
 };
 
 }  // namespace bustub
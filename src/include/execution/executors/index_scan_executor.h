@@ -12,18 +12,22 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table. A predicate that compares the single key column with a
+ * constant is pushed down into the index as scan bounds; the predicate is still checked on every tuple.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +46,16 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Opens a cursor over the index, bounded by the predicate where it compares the key column with a constant. */
+  auto OpenCursor() -> std::unique_ptr<IndexCursor>;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The index being scanned. */
+  IndexInfo *index_info_{nullptr};
+  /** The table the index is built on. */
+  TableInfo *table_info_{nullptr};
+  /** The position of the scan in the index. */
+  std::unique_ptr<IndexCursor> cursor_;
 };
 }  // namespace bustub
@@ -54,6 +54,9 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  /** @return the type of comparison, of the left child with the right one */
+  auto GetComparisonType() const -> ComparisonType { return comp_type_; }
+
  private:
   auto PerformComparison(const Value &lhs, const Value &rhs) const -> CmpBool {
     switch (comp_type_) {
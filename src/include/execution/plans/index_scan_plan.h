@@ -28,9 +28,11 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
    * nullptr
    * @param table_oid the identifier of table to be scanned
+   * @param reverse whether to scan the index keys from the greatest down, as for ORDER BY ... DESC
    */
-  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
-      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    bool reverse = false)
+      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid), reverse_(reverse) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -40,11 +42,16 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return true if tuples are returned in descending key order */
+  auto IsReverse() const -> bool { return reverse_; }
+
  private:
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
+  /** Whether the index is scanned in descending key order. */
+  bool reverse_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <thread>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
@@ -19,7 +22,12 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager takes ARIES-style fuzzy checkpoints, which do not stop the running transactions.
+ *
+ * A checkpoint logs a BEGIN_CHECKPOINT record, then an END_CHECKPOINT record carrying the active transaction table and
+ * the dirty page table, and makes them durable. The dirty pages are then written back by a background thread, which
+ * moves the redo point of the next checkpoint forward. Recovery starts redo from the smallest recLSN in the dirty page
+ * table of the last checkpoint.
  */
 class CheckpointManager {
  public:
@@ -29,15 +37,24 @@ class CheckpointManager {
         log_manager_(log_manager),
         buffer_pool_manager_(buffer_pool_manager) {}
 
-  ~CheckpointManager() = default;
+  ~CheckpointManager() { EndCheckpoint(); }
 
+  /** Log a checkpoint and start writing back the pages that were dirty in it. */
   void BeginCheckpoint();
+
+  /** Wait until the pages that were dirty in the last checkpoint have been written back. */
   void EndCheckpoint();
 
  private:
-  TransactionManager *transaction_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Write back the given pages, each after the log records of its changes. */
+  void WriteDirtyPages(const std::vector<page_id_t> &page_ids);
+
+  TransactionManager *transaction_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+
+  /** The thread writing back the dirty pages of the last checkpoint, nullptr if it has been joined. */
+  std::thread *writer_thread_{nullptr};
 };
 
 }  // namespace bustub
@@ -13,9 +13,14 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <utility>
+#include <vector>
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -23,22 +28,30 @@
 namespace bustub {
 
 /**
- * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
- * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ * LogManager maintains a separate thread that is awakened whenever the log buffer is full, whenever a timeout happens,
+ * or whenever someone waits for a record to become persistent. When the thread is awakened, the log buffer is swapped
+ * with the flush buffer and its content is written into the disk log file, so appends continue during the write.
+ *
+ * Appending takes no latch: a record reserves its LSN and its slice of the log buffer with one atomic update, and is
+ * then serialized into the slice in parallel with the other appenders. Before writing a buffer out, the flush thread
+ * waits until every slice reserved in it has been filled.
+ *
+ * Commits use this for group commit: every transaction that waits for its COMMIT record while a flush is in progress
+ * is made durable by the next single write and sync of the log file.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+  explicit LogManager(DiskManager *disk_manager) : persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+    buffers_[0] = new char[LOG_BUFFER_SIZE];
+    buffers_[1] = new char[LOG_BUFFER_SIZE];
   }
 
   ~LogManager() {
-    delete[] log_buffer_;
-    delete[] flush_buffer_;
-    log_buffer_ = nullptr;
-    flush_buffer_ = nullptr;
+    StopFlushThread();
+    delete[] buffers_[0];
+    delete[] buffers_[1];
+    buffers_[0] = nullptr;
+    buffers_[1] = nullptr;
   }
 
   void RunFlushThread();
@@ -46,29 +59,95 @@ class LogManager {
 
   auto AppendLogRecord(LogRecord *log_record) -> lsn_t;
 
-  inline auto GetNextLSN() -> lsn_t { return next_lsn_; }
+  /**
+   * Wait for a log record to reach the disk. Waiters that arrive while a flush is in progress are batched into the
+   * next flush, which is what makes concurrent commits share one sync of the log file.
+   * @param lsn the record to wait for
+   * @return a future that becomes ready once the log is persistent up to and including lsn
+   */
+  auto WaitForFlush(lsn_t lsn) -> std::future<void>;
+
+  /** Make every record appended so far persistent, and wait for it. */
+  void Flush();
+
+  /**
+   * Let the disk manager delete the log segments that recovery no longer needs.
+   * @param restart_lsn the oldest record recovery has to read
+   */
+  void TruncateLog(lsn_t restart_lsn);
+
+  inline auto GetNextLSN() -> lsn_t { return ReservedLSN(reservation_); }
   inline auto GetPersistentLSN() -> lsn_t { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
-  inline auto GetLogBuffer() -> char * { return log_buffer_; }
+  inline auto GetLogBuffer() -> char * { return buffers_[ReservedEpoch(reservation_) % 2]; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /*
+   * The reservation word packs the next LSN (upper 32 bits), the epoch of the log buffer (8 bits, counting buffer
+   * swaps) and the number of bytes reserved in it (lower 24 bits), so that one compare-and-swap hands out both an LSN
+   * and a slice. Records therefore lie in the log in LSN order.
+   */
+  static constexpr int RESERVATION_OFFSET_BITS = 24;
+  static constexpr int RESERVATION_EPOCH_BITS = 8;
+  static constexpr uint64_t RESERVATION_OFFSET_MASK = (uint64_t{1} << RESERVATION_OFFSET_BITS) - 1;
+  static constexpr uint64_t RESERVATION_EPOCH_MASK = (uint64_t{1} << RESERVATION_EPOCH_BITS) - 1;
+  static_assert(LOG_BUFFER_SIZE <= RESERVATION_OFFSET_MASK, "log buffer offsets must fit the reservation word");
+
+  static auto ReservedLSN(uint64_t reservation) -> lsn_t { return static_cast<lsn_t>(reservation >> 32); }
+  static auto ReservedEpoch(uint64_t reservation) -> uint32_t {
+    return (reservation >> RESERVATION_OFFSET_BITS) & RESERVATION_EPOCH_MASK;
+  }
+  static auto ReservedOffset(uint64_t reservation) -> int {
+    return static_cast<int>(reservation & RESERVATION_OFFSET_MASK);
+  }
+
+  /** Copy a log record into its reserved slice of a log buffer. */
+  static void SerializeLogRecord(LogRecord *log_record, char *pos);
 
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+  /** Slow path of AppendLogRecord: wait until the log buffer seen in reservation has been swapped out. */
+  void WaitForRoom(uint64_t reservation);
+
+  /**
+   * Swap the buffers and write out the filled one, then complete the waiters it satisfies. Called with latch_ held
+   * through lock; the latch is released during the write. Only one flush runs at a time.
+   */
+  void FlushLogBuffer(std::unique_lock<std::mutex> *lock);
+
+  /** Main loop of the flush thread. */
+  void FlushThreadLoop();
+
+  /** Next LSN, epoch and fill of the log buffer; see above. */
+  std::atomic<uint64_t> reservation_{0};
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
-  char *log_buffer_;
-  char *flush_buffer_;
+  /** The log buffer is buffers_[epoch % 2]; the other one is the flush buffer. */
+  std::array<char *, 2> buffers_;
+  /** Number of bytes serialized into each buffer, which trails the reserved bytes while appenders are copying. */
+  std::array<std::atomic<int>, 2> completed_{};
+
+  /** The last record of the flush in progress, or INVALID_LSN if there is none. */
+  lsn_t flushing_lsn_{INVALID_LSN};
+  /** The first record of the next flush, which starts the log segment if the flush opens one. */
+  lsn_t flush_start_lsn_{0};
+  bool flush_requested_{false};
+  bool flushing_{false};
+  bool running_{false};
+
+  /** Records waited for, and the promises to complete once they are persistent. */
+  std::vector<std::pair<lsn_t, std::promise<void>>> waiters_;
 
+  /** Protects everything above except the atomics. Appends only take it when the log buffer is full. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
 
+  /** Wakes up the flush thread. */
   std::condition_variable cv_;
+  /** Signalled when the buffers are swapped or a flush completes. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,9 @@
 
 #include <cassert>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,15 +35,81 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** The start of a fuzzy checkpoint. */
+  BEGIN_CHECKPOINT,
+  /** The end of a fuzzy checkpoint, carrying the active transaction table and the dirty page table. */
+  END_CHECKPOINT,
+  /** Inserting an entry into a B+ tree leaf. */
+  INDEX_INSERT,
+  /** Deleting an entry from a B+ tree leaf. */
+  INDEX_DELETE,
+  /** An insert that split pages of a B+ tree, up to and possibly including the root. */
+  INDEX_SPLIT,
+  /** A delete that merged pages of a B+ tree, up to and possibly including the root. */
+  INDEX_MERGE,
+  /** A delete that moved entries between sibling pages of a B+ tree. */
+  INDEX_REDISTRIBUTE,
+};
+
+/** The type of a change to a single index page. */
+enum class IndexLogOpType : int32_t {
+  /** Write the page header in data_ and leave the page without entries. */
+  FORMAT = 0,
+  /** Insert the entries in data_ at slot_, shifting the entries from slot_ on up. */
+  INSERT_ENTRIES,
+  /** Remove value_ entries at slot_, shifting the later entries down. */
+  REMOVE_ENTRIES,
+  /** Set the next page id of a leaf to value_. */
+  SET_NEXT_PAGE,
+  /** Set the parent page id to value_. */
+  SET_PARENT_PAGE,
+  /** Record value_ as the root page of the index named data_ in the header page. */
+  SET_ROOT,
+  /**
+   * Overwrite the page with data_: its first slot_ bytes go to the start of the page, the rest to offset value_.
+   * Pages of variable-length keys log this, leaving out their free space, in place of entry changes.
+   */
+  PAGE_IMAGE,
+  /** Set the previous page id of a leaf to value_. */
+  SET_PREV_PAGE,
+};
+
+/**
+ * One change to one page in an index log record. Changes address entries by slot, so redo repeats them without
+ * knowing the key type; entry_size_ gives the width of an entry on the page.
+ */
+struct IndexLogOp {
+  IndexLogOpType type_{IndexLogOpType::FORMAT};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  int32_t slot_{0};
+  int32_t value_{0};
+  int32_t entry_size_{0};
+  std::string data_;
+
+  /** Serialized size of the fixed fields and the length of data_. */
+  static constexpr int HEADER_SIZE = 24;
+};
+
+/**
+ * A byte range that an update changed: old_data_ at offset_ of the old tuple became new_data_. Ranges do not overlap
+ * and are sorted by offset; only the last one may change the length of the tuple.
+ */
+struct UpdateRange {
+  uint32_t offset_{0};
+  std::string old_data_;
+  std::string new_data_;
 };
 
 /**
  * For every write operation on the table page, you should write ahead a corresponding log record.
  *
- * For EACH log record, HEADER is like (5 fields in common, 20 bytes in total).
+ * For EACH log record, HEADER is like (5 fields in common, 8 to 20 bytes in total).
  *---------------------------------------------
  * | size | LSN | transID | prevLSN | LogType |
  *---------------------------------------------
+ * The LSN takes 4 bytes and the type 1; size, transID + 1 and prevLSN + 1 are varints of 1 to 5 bytes, 7 bits per
+ * byte with the high bit set on all but the last. The LSN is fixed size since the size of a record has to be known
+ * before the log manager hands it an LSN.
  * For insert type log record
  *---------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
@@ -49,14 +118,25 @@ enum class LogRecordType {
  *----------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
  *---------------------------------------------------------------
- * For update type log record
- *-----------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
- *-----------------------------------------------------------------------------------
+ * For update type log record, holding only the byte ranges that differ between the old and the new tuple; redo and
+ * undo rebuild one tuple from the other on the page (all sizes are varints)
+ *---------------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | num_ranges | offset | old_size | new_size | old_data | new_data | ... |
+ *---------------------------------------------------------------------------------------------------
  * For new page type log record
- *--------------------------
- * | HEADER | prev_page_id |
- *--------------------------
+ *------------------------------------
+ * | HEADER | prev_page_id | page_id |
+ *------------------------------------
+ * For end checkpoint type log record, where the tables are lists of (txn_id, last_lsn) and (page_id, rec_lsn)
+ *------------------------------------------------------------------------------
+ * | HEADER | num_txns | active_txn_table | num_pages | dirty_page_table |
+ *------------------------------------------------------------------------------
+ * For index type log records, a list of page changes that is applied atomically
+ *---------------------------------------------------------------------------------------------------------
+ * | HEADER | num_ops | type | page_id | slot | value | entry_size | data_size | data(char[] array) | ... |
+ *---------------------------------------------------------------------------------------------------------
+ * Index records are redo-only and carry no transaction: they are undone logically, by the index operation that
+ * reverses them, not by undoing the page changes.
  */
 class LogRecord {
   friend class LogManager;
@@ -67,7 +147,9 @@ class LogRecord {
 
   // constructor for Transaction type(BEGIN/COMMIT/ABORT)
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type)
-      : size_(HEADER_SIZE), txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {
+    SetSize(0);
+  }
 
   // constructor for INSERT/DELETE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple)
@@ -82,7 +164,7 @@ class LogRecord {
       delete_tuple_ = tuple;
     }
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+    SetSize(sizeof(RID) + sizeof(int32_t) + tuple.GetLength());
   }
 
   // constructor for UPDATE type
@@ -92,22 +174,49 @@ class LogRecord {
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         update_rid_(update_rid),
-        old_tuple_(old_tuple),
-        new_tuple_(new_tuple) {
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+        update_ranges_(DiffTuples(old_tuple, new_tuple)) {
+    // calculate log record size, rid + range count + each range
+    int size = sizeof(RID) + VarintSize(update_ranges_.size());
+    for (const auto &range : update_ranges_) {
+      size += VarintSize(range.offset_) + VarintSize(range.old_data_.size()) + VarintSize(range.new_data_.size()) +
+              range.old_data_.size() + range.new_data_.size();
+    }
+    SetSize(size);
   }
 
   // constructor for NEWPAGE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id)
-      : size_(HEADER_SIZE),
-        txn_id_(txn_id),
+      : txn_id_(txn_id),
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         prev_page_id_(prev_page_id),
         page_id_(page_id) {
     // calculate log record size, header size + sizeof(prev_page_id) + sizeof(page_id)
-    size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
+    SetSize(sizeof(page_id_t) * 2);
+  }
+
+  // constructor for END_CHECKPOINT type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
+            std::unordered_map<txn_id_t, lsn_t> active_txn_table, std::unordered_map<page_id_t, lsn_t> dirty_page_table)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        active_txn_table_(std::move(active_txn_table)),
+        dirty_page_table_(std::move(dirty_page_table)) {
+    // calculate log record size, header size + two counts + 8 bytes per table entry
+    SetSize(2 * sizeof(int32_t) +
+            (active_txn_table_.size() + dirty_page_table_.size()) * (sizeof(int32_t) + sizeof(lsn_t)));
+  }
+
+  // constructor for the INDEX_* types
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, std::vector<IndexLogOp> index_ops)
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type), index_ops_(std::move(index_ops)) {
+    // calculate log record size, header size + op count + each op
+    int size = sizeof(int32_t);
+    for (const auto &op : index_ops_) {
+      size += IndexLogOp::HEADER_SIZE + op.data_.size();
+    }
+    SetSize(size);
   }
 
   ~LogRecord() = default;
@@ -120,14 +229,29 @@ class LogRecord {
 
   inline auto GetInsertRID() -> RID & { return insert_rid_; }
 
-  inline auto GetOriginalTuple() -> Tuple & { return old_tuple_; }
+  /** @return the tuple before the update, rebuilt from the tuple after it */
+  inline auto GetOriginalTuple(const Tuple &new_tuple) const -> Tuple { return ApplyUpdateRanges(new_tuple, false); }
+
+  /** @return the tuple after the update, rebuilt from the tuple before it */
+  inline auto GetUpdateTuple(const Tuple &old_tuple) const -> Tuple { return ApplyUpdateRanges(old_tuple, true); }
 
-  inline auto GetUpdateTuple() -> Tuple & { return new_tuple_; }
+  inline auto GetUpdateRanges() -> std::vector<UpdateRange> & { return update_ranges_; }
 
   inline auto GetUpdateRID() -> RID & { return update_rid_; }
 
   inline auto GetNewPageRecord() -> page_id_t { return prev_page_id_; }
 
+  inline auto GetActiveTxnTable() -> std::unordered_map<txn_id_t, lsn_t> & { return active_txn_table_; }
+
+  inline auto GetDirtyPageTable() -> std::unordered_map<page_id_t, lsn_t> & { return dirty_page_table_; }
+
+  inline auto GetIndexOps() -> std::vector<IndexLogOp> & { return index_ops_; }
+
+  /** Whether the record changes index pages; see LogRecordType::INDEX_INSERT and the types after it. */
+  static auto IsIndexRecord(LogRecordType log_record_type) -> bool {
+    return log_record_type >= LogRecordType::INDEX_INSERT && log_record_type <= LogRecordType::INDEX_REDISTRIBUTE;
+  }
+
   inline auto GetSize() -> int32_t { return size_; }
 
   inline auto GetLSN() -> lsn_t { return lsn_; }
@@ -152,6 +276,48 @@ class LogRecord {
   }
 
  private:
+  /** Set size_ from the size of the fields that follow the header. */
+  void SetSize(int body_size);
+
+  /** The ranges that differ between two tuples, with short runs of equal bytes between them logged inside. */
+  static auto DiffTuples(const Tuple &old_tuple, const Tuple &new_tuple) -> std::vector<UpdateRange>;
+
+  /** Rebuild the tuple on the other side of update_ranges_, the new one if forward and the old one otherwise. */
+  auto ApplyUpdateRanges(const Tuple &tuple, bool forward) const -> Tuple;
+
+  /** @return the number of bytes of value as a varint */
+  static auto VarintSize(uint32_t value) -> int {
+    int size = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      size++;
+    }
+    return size;
+  }
+
+  /** Write value as a varint. @return the position after it */
+  static auto EncodeVarint(uint32_t value, char *pos) -> char * {
+    while (value >= 0x80) {
+      *pos++ = static_cast<char>(value | 0x80);
+      value >>= 7;
+    }
+    *pos++ = static_cast<char>(value);
+    return pos;
+  }
+
+  /** Read a varint. @return the position after it */
+  static auto DecodeVarint(const char *pos, uint32_t *value) -> const char * {
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      auto byte = static_cast<uint8_t>(*pos++);
+      *value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+    }
+    return pos;
+  }
+
   // the length of log record(for serialization, in bytes)
   int32_t size_{0};
   // must have fields
@@ -170,13 +336,22 @@ class LogRecord {
 
   // case3: for update operation
   RID update_rid_;
-  Tuple old_tuple_;
-  Tuple new_tuple_;
+  std::vector<UpdateRange> update_ranges_;
 
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
-  static const int HEADER_SIZE = 20;
+
+  // case5: for end checkpoint operation, the last lsn of each active transaction and the rec lsn of each dirty page
+  std::unordered_map<txn_id_t, lsn_t> active_txn_table_;
+  std::unordered_map<page_id_t, lsn_t> dirty_page_table_;
+
+  // case6: for index operations, the changes to each page they touch
+  std::vector<IndexLogOp> index_ops_;
+  /** Serialized size of the header at its largest, which is enough to read the size of any record. */
+  static const int MAX_HEADER_SIZE = 20;
+  /** Runs of up to this many equal bytes between changed ones cost less logged twice than the sizes of a new range. */
+  static const uint32_t MAX_UPDATE_RANGE_GAP = 1;
 };  // namespace bustub
 
 }  // namespace bustub
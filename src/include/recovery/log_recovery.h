@@ -13,22 +13,38 @@
 #pragma once
 
 #include <algorithm>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/log_record.h"
+#include "storage/page/table_page.h"
 
 namespace bustub {
 
 /**
  * Read log file from disk, redo and undo.
+ *
+ * Redo runs in two phases. A single thread parses the log sequentially, building active_txn_ and lsn_mapping_ and
+ * partitioning the records that change a page by a hash of their page id. The partitions are then applied in
+ * parallel, one thread each, so every page sees its records in LSN order while different pages are redone at once.
+ * Records before the redo point of the last fuzzy checkpoint are dropped from the partitions before they are applied.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
+  /**
+   * @param num_redo_threads number of threads applying redo records, defaulting to one per core
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager,
+              size_t num_redo_threads = std::thread::hardware_concurrency())
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        num_redo_threads_(std::max<size_t>(num_redo_threads, 1)),
+        offset_(0) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
@@ -37,20 +53,58 @@ class LogRecovery {
     log_buffer_ = nullptr;
   }
 
+  /**
+   * Redo every logged change the pages on disk are missing.
+   * @throws Exception if a page to redo cannot be read; the pages may then be partly redone
+   */
   void Redo();
   void Undo();
   auto DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool;
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Redo records of the pages hashed to one redo thread, each with the page it is applied to, in LSN order. */
+  using RedoPartition = std::vector<std::pair<page_id_t, LogRecord>>;
+
+  /**
+   * Drop the parsed redo records that the dirty page table of a checkpoint shows to be on disk already.
+   * @param checkpoint_lsn LSN of the BEGIN_CHECKPOINT record, or INVALID_LSN if it was not seen
+   * @param log_record the END_CHECKPOINT record
+   */
+  void ApplyCheckpoint(lsn_t checkpoint_lsn, LogRecord *log_record, std::vector<RedoPartition> *partitions);
+
+  /** @return the page a log record changes, or INVALID_PAGE_ID for transaction records */
+  static auto GetLogRecordPageId(LogRecord *log_record) -> page_id_t;
+
+  /**
+   * Fetch a page, waiting for other recovery threads to unpin theirs if the buffer pool is full.
+   * @throws Exception if the page, or a page fetched by another thread meanwhile, cannot be read
+   */
+  auto FetchPage(page_id_t page_id) -> Page *;
+  auto FetchTablePage(page_id_t page_id) -> TablePage *;
+
+  /**
+   * Apply a log record to a page unless the page already contains it. A NEWPAGE record is applied to both the new
+   * page and the previous one, which gets linked to it.
+   */
+  void RedoLogRecord(page_id_t page_id, LogRecord *log_record);
+
+  /** Apply the changes of an index log record to one of the pages it covers, which carry only the ops on that page. */
+  void RedoIndexLogRecord(page_id_t page_id, LogRecord *log_record);
+
+  /** Revert the change of a log record on its page. */
+  void UndoLogRecord(LogRecord *log_record);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  size_t num_redo_threads_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   /** Mapping the log sequence number to log file offset for undos. */
-  std::unordered_map<lsn_t, int> lsn_mapping_;
+  std::unordered_map<lsn_t, int64_t> lsn_mapping_;
 
-  int offset_ __attribute__((__unused__));
+  /** Offset in the log file of the data in log_buffer_. */
+  int64_t offset_;
   char *log_buffer_;
 };
 
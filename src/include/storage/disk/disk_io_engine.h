@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_io_engine.h
+//
+// Identification: src/include/storage/disk/disk_io_engine.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+/** How a DiskManager performs page I/O. */
+enum class DiskIOBackend {
+  /** Every request is done by the calling thread. */
+  SYNC,
+  /** Requests are queued to a pool of threads doing pread/pwrite. */
+  THREAD_POOL,
+  /** Requests are submitted to an io_uring, falling back to THREAD_POOL where io_uring is not available. */
+  IO_URING
+};
+
+/**
+ * DiskIOEngine runs positional reads and writes asynchronously. Any number of requests can be in flight; each one
+ * reports its result to a callback, which runs on a thread owned by the engine. Callbacks should be short and must not
+ * submit requests themselves.
+ */
+class DiskIOEngine {
+ public:
+  /** Called with the number of bytes transferred, or -errno if the request failed. */
+  using Callback = std::function<void(ssize_t result)>;
+
+  virtual ~DiskIOEngine() = default;
+
+  /**
+   * Queue a read.
+   * @param fd file to read from
+   * @param data buffer of at least size bytes, which must stay valid until the callback runs
+   * @param size number of bytes to read
+   * @param offset file offset to read from
+   * @param callback called once the read is complete
+   */
+  virtual void SubmitRead(int fd, char *data, size_t size, off_t offset, Callback callback) = 0;
+
+  /**
+   * Queue a write.
+   * @param fd file to write to
+   * @param data the bytes to write, which must stay valid until the callback runs
+   * @param size number of bytes to write
+   * @param offset file offset to write at
+   * @param callback called once the write is complete
+   */
+  virtual void SubmitWrite(int fd, const char *data, size_t size, off_t offset, Callback callback) = 0;
+
+  /** @return the backend that actually serves the requests */
+  virtual auto GetBackend() const -> DiskIOBackend = 0;
+
+  /**
+   * Create an engine for an asynchronous backend.
+   * @param backend THREAD_POOL or IO_URING
+   * @return the engine; an IO_URING request yields a THREAD_POOL engine if the kernel refuses to set up an io_uring
+   */
+  static auto Create(DiskIOBackend backend) -> std::unique_ptr<DiskIOEngine>;
+
+  /**
+   * pread until size bytes are read or the file ends, retrying interrupted and partial reads.
+   * @return the number of bytes read, or -errno
+   */
+  static auto ReadFully(int fd, char *data, size_t size, off_t offset) -> ssize_t;
+
+  /**
+   * preadv into consecutive buffers until they are full or the file ends, retrying interrupted and partial reads.
+   * @param iov the buffers, at most IOV_MAX of them
+   * @return the number of bytes read, or -errno
+   */
+  static auto ReadvFully(int fd, std::vector<iovec> iov, off_t offset) -> ssize_t;
+
+  /**
+   * pwrite until all size bytes are written, retrying interrupted and partial writes.
+   * @return the number of bytes written, or -errno
+   */
+  static auto WriteFully(int fd, const char *data, size_t size, off_t offset) -> ssize_t;
+};
+
+/** DiskIOEngine doing pread/pwrite on a fixed pool of threads. */
+class ThreadPoolDiskIOEngine : public DiskIOEngine {
+ public:
+  /** @param num_threads number of I/O threads, and so the number of requests that run at the same time */
+  explicit ThreadPoolDiskIOEngine(size_t num_threads);
+
+  /** Waits for the queued requests and joins the threads. */
+  ~ThreadPoolDiskIOEngine() override;
+
+  void SubmitRead(int fd, char *data, size_t size, off_t offset, Callback callback) override;
+
+  void SubmitWrite(int fd, const char *data, size_t size, off_t offset, Callback callback) override;
+
+  auto GetBackend() const -> DiskIOBackend override { return DiskIOBackend::THREAD_POOL; }
+
+ private:
+  void Enqueue(std::function<void()> request);
+
+  /** Main loop of an I/O thread. */
+  void Run();
+
+  std::vector<std::thread> threads_;
+  std::deque<std::function<void()>> queue_;
+  bool running_{true};
+  /** Protects queue_ and running_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+/**
+ * DiskIOEngine on a Linux io_uring, driven through the raw system calls so that no liburing is needed. Submissions go
+ * straight into the submission queue; a completion thread reaps the completion queue and runs the callbacks.
+ */
+class IoUringDiskIOEngine : public DiskIOEngine {
+ public:
+  /**
+   * Set up the io_uring. Check IsReady() afterwards: kernels without io_uring, or sandboxes that forbid it, fail here.
+   * @param queue_depth number of submission queue entries, which bounds the requests in flight
+   */
+  explicit IoUringDiskIOEngine(unsigned queue_depth);
+
+  /** Waits for the requests in flight, stops the completion thread and tears down the io_uring. */
+  ~IoUringDiskIOEngine() override;
+
+  /** @return true if the io_uring was set up */
+  auto IsReady() const -> bool { return ring_fd_ >= 0; }
+
+  void SubmitRead(int fd, char *data, size_t size, off_t offset, Callback callback) override;
+
+  void SubmitWrite(int fd, const char *data, size_t size, off_t offset, Callback callback) override;
+
+  auto GetBackend() const -> DiskIOBackend override { return DiskIOBackend::IO_URING; }
+
+ private:
+  /** A request in flight. Its address is the user data of the submission. */
+  struct Request;
+
+  void Submit(uint8_t opcode, int fd, char *data, size_t size, off_t offset, Callback callback);
+
+  /**
+   * Put a request into the submission queue and submit it. The caller holds latch_ and has counted the request in
+   * in_flight_.
+   */
+  void Enqueue(uint8_t opcode, int fd, Request *request);
+
+  /**
+   * Check a completion for a transfer that has to go on: a short read or write, which is advanced past the bytes
+   * done, or one interrupted before it started.
+   * @return true if the request is to be submitted again
+   */
+  auto NeedsResubmit(Request *request, int result) -> bool;
+
+  /** Main loop of the completion thread. */
+  void ReapCompletions();
+
+  int ring_fd_{-1};
+  /** The mapped submission queue ring, completion queue ring and submission queue entries. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** Pointers into the rings. */
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  void *cqes_{nullptr};
+  unsigned queue_depth_{0};
+
+  /** Number of submitted requests that have not completed yet. */
+  unsigned in_flight_{0};
+  /** Protects the submission queue and in_flight_. */
+  std::mutex latch_;
+  /** Signalled when a request completes, for submitters waiting for room and for the destructor. */
+  std::condition_variable cv_;
+  std::thread completion_thread_;
+};
+
+}  // namespace bustub
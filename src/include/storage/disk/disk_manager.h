@@ -13,12 +13,16 @@
 #pragma once
 
 #include <atomic>
-#include <fstream>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/disk_io_engine.h"
 
 namespace bustub {
 
@@ -31,8 +35,15 @@ class DiskManager {
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param enable_checksums if true, every page written gets a CRC32C trailer that is verified when it is read back
+   * @param io_backend how the asynchronous page I/O calls are served
+   * @param direct_io if true, open the database file with O_DIRECT so that pages bypass the operating system's page
+   * cache; falls back to buffered I/O on file systems without O_DIRECT support
+   * @param log_segment_size size of a log segment file, including its header, after which the log goes on in a new one
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool enable_checksums = false,
+                       DiskIOBackend io_backend = DiskIOBackend::SYNC, bool direct_io = false,
+                       int log_segment_size = LOG_SEGMENT_SIZE);
 
   ~DiskManager() = default;
 
@@ -45,31 +56,100 @@ class DiskManager {
    * Write a page to the database file.
    * @param page_id id of the page
    * @param page_data raw page data
+   * @return false if the page could not be written
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  auto WritePage(page_id_t page_id, const char *page_data) -> bool;
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return false if the read failed, or checksums are enabled and the page does not match its trailer, e.g. after a
+   * torn write
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  auto ReadPage(page_id_t page_id, char *page_data) -> bool;
 
   /**
-   * Flush the entire log buffer into disk.
+   * Read a batch of pages from the database file, with one vectored read per run of adjacent page ids, or as one batch
+   * of requests in flight with an asynchronous backend.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, one per page id
+   * @return for each page, false if its read failed or it does not match its checksum trailer
+   */
+  auto ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) -> std::vector<bool>;
+
+  /**
+   * Start writing a page to the database file. With the SYNC backend the write is done before this returns.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay unchanged until the write is complete
+   * @return a future that becomes ready when the write is complete
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void>;
+
+  /**
+   * Start reading a page from the database file. With the SYNC backend the read is done before this returns.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the read is complete
+   * @return a future for the result of the read, false if it failed or the page does not match its checksum trailer
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /**
+   * Sync the pages written so far, and their checksum trailers, to stable storage. Page writes otherwise only reach the
+   * operating system, which may lose them in a crash.
+   */
+  void SyncPages();
+
+  /**
+   * Take pages that do not match their checksum trailer as they are, and rewrite their trailers, for as long as
+   * recovery redoes the log. A page and its trailer are not written atomically, so a crash between the two leaves an
+   * intact page with a stale trailer; redo then brings the page up to date from the log.
+   */
+  void SetRepairChecksums(bool repair) { repair_checksums_ = repair; }
+
+  /** @return the backend serving the asynchronous calls, which may differ from the requested one */
+  auto GetIOBackend() const -> DiskIOBackend {
+    return io_engine_ == nullptr ? DiskIOBackend::SYNC : io_engine_->GetBackend();
+  }
+
+  /**
+   * Append the entire log buffer to the log and sync it to stable storage. The buffer goes into a new log segment if
+   * it does not fit into the current one.
    * @param log_data raw log data
    * @param size size of log entry
+   * @param first_lsn LSN of the first record in the buffer, which starts the segment if the buffer opens one
    */
-  void WriteLog(char *log_data, int size);
+  void WriteLog(char *log_data, int size, lsn_t first_lsn = INVALID_LSN);
 
   /**
-   * Read a log entry from the log file.
+   * Read a log entry from the log. Offsets count the log data of all segments ever written, without their headers, so
+   * they stay valid when older segments are deleted.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
-   * @return true if the read was successful, false otherwise
+   * @param offset offset of the log entry in the log
+   * @return true if the read was successful, false if the offset is past the end of the log or was truncated
+   */
+  auto ReadLog(char *log_data, int size, int64_t offset) -> bool;
+
+  /**
+   * Find where to start reading the log to see a record and everything after it.
+   * @param lsn LSN of the record, or INVALID_LSN for the oldest record kept
+   * @return the offset of the start of the log segment that holds the record
    */
-  auto ReadLog(char *log_data, int size, int offset) -> bool;
+  auto GetLogSegmentOffset(lsn_t lsn) -> int64_t;
+
+  /**
+   * Durably record the LSN that recovery starts reading the log from, and delete the log segments that lie wholly
+   * before it. The pages written so far are synced first, as the log they are no longer redone from goes away.
+   * @param restart_lsn the new restart LSN
+   */
+  void TruncateLog(lsn_t restart_lsn);
+
+  /** @return the LSN that recovery starts reading the log from, or INVALID_LSN for the start of the log */
+  auto GetLogRestartLSN() -> lsn_t;
+
+  /** @return the number of log segment files */
+  auto GetNumLogSegments() -> size_t;
 
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
@@ -80,6 +160,18 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of disk reads */
+  auto GetNumReads() const -> int;
+
+  /** @return the number of pages read back that did not match their checksum trailer */
+  auto GetNumChecksumFailures() const -> int { return num_checksum_failures_; }
+
+  /** @return true if the database file was opened with O_DIRECT */
+  auto IsDirectIO() const -> bool { return direct_io_; }
+
+  /** @return true if pages carry a checksum trailer */
+  auto ChecksumsEnabled() const -> bool { return enable_checksums_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -90,19 +182,142 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  private:
-  auto GetFileSize(const std::string &file_name) -> int;
-  // stream to write log file
-  std::fstream log_io_;
+  auto GetFileSize(const std::string &file_name) -> int64_t;
+
+  /**
+   * Zero the part of a page past the end of the file and verify its checksum, given the result of the pread.
+   * @return false if the pread failed or the page does not match its checksum
+   */
+  auto FinishRead(page_id_t page_id, char *page_data, ssize_t read_count) -> bool;
+
+  /** @return true if the buffer cannot be handed to O_DIRECT as is and has to be copied through an aligned one */
+  auto NeedsBounceBuffer(const char *page_data) const -> bool;
+
+  /** @return a PAGE_SIZE buffer aligned for O_DIRECT, to be released with free() */
+  static auto AllocateBounceBuffer() -> char *;
+
+  /** Raise the cached size of the database file to at least size. */
+  void GrowFileSize(off_t size);
+
+  /**
+   * The trailer of a page. Page layouts use all PAGE_SIZE bytes, so trailers are stored out of line in the checksum
+   * file, indexed by page id. A page is written before its trailer, so a page that was torn, or whose trailer did not
+   * make it to disk, fails verification; SyncPages syncs both files together, and recovery repairs the trailers of
+   * pages that a crash caught in between.
+   */
+  struct PageTrailer {
+    /** PAGE_TRAILER_MAGIC for a written trailer, so that pages written without checksums are not reported. */
+    uint32_t magic_;
+    /** CRC32C of the page data. */
+    uint32_t checksum_;
+  };
+  static constexpr uint32_t PAGE_TRAILER_MAGIC = 0x43524343;
+
+  /**
+   * Wait until no other write of the page is in flight, so that the trailer goes with the last write to reach the page.
+   * Only needed with checksums.
+   */
+  void BeginPageWrite(page_id_t page_id);
+
+  /** Write the trailer of a page if its write succeeded, and let the next write of the page start. */
+  void FinishPageWrite(page_id_t page_id, uint32_t checksum, bool written);
+
+  /** Write the trailer of a page. Requires checksum_latch_. */
+  void WriteTrailer(page_id_t page_id, uint32_t checksum);
+
+  /** @return true if the page matches its trailer or has none. */
+  auto VerifyTrailer(page_id_t page_id, const char *page_data) -> bool;
+
+  /**
+   * The header at the start of every log segment file. Segments are record aligned, so reading can start at any of
+   * them.
+   */
+  struct LogSegmentHeader {
+    /** LOG_SEGMENT_MAGIC, to tell a segment from a stray file. */
+    uint32_t magic_;
+    /** Sequence number of the segment, which is also in its file name. */
+    uint32_t seq_;
+    /** Offset in the log of the first byte of log data in the segment. */
+    int64_t start_offset_;
+    /** LSN of the first record in the segment, or INVALID_LSN if it is not known. */
+    lsn_t start_lsn_;
+    uint32_t reserved_;
+  };
+  static constexpr uint32_t LOG_SEGMENT_MAGIC = 0x4C4F4753;
+
+  /** The master record of the log, which the log file `<db>.log` holds. The segments are `<db>.log.<seq>`. */
+  struct LogMasterRecord {
+    /** LOG_MASTER_MAGIC for a written master record. */
+    uint32_t magic_;
+    /** Sequence number of the oldest segment kept. */
+    uint32_t first_seq_;
+    /** LSN that recovery starts reading from, or INVALID_LSN for the start of the log. */
+    lsn_t restart_lsn_;
+    uint32_t reserved_;
+  };
+  static constexpr uint32_t LOG_MASTER_MAGIC = 0x4C4F474D;
+
+  /** An open log segment. */
+  struct LogSegment {
+    uint32_t seq_;
+    int fd_;
+    off_t start_offset_;
+    lsn_t start_lsn_;
+    /** Bytes of log data in the segment, after the header. */
+    off_t size_;
+  };
+
+  /** Open the segments listed by the master record, or start a new log if there is none. */
+  void OpenLog();
+
+  /** @return the file name of the log segment with the given sequence number */
+  auto GetLogSegmentName(uint32_t seq) const -> std::string;
+
+  /** Start a new log segment after the last one. Requires log_latch_. */
+  void CreateLogSegment(lsn_t start_lsn);
+
+  /** Write the master record and sync it. Requires log_latch_. */
+  void WriteLogMasterRecord();
+
+  /** Sync the directory of the log, so that created and deleted segments survive a crash. */
+  void SyncLogDirectory();
+
+  // descriptor of the log master file
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  int log_segment_size_;
+  // the segments kept, oldest first; new ones are appended by the log flush thread
+  std::deque<LogSegment> log_segments_;
+  uint32_t log_first_seq_{0};
+  lsn_t log_restart_lsn_{INVALID_LSN};
+  // protects the log segments and the master record
+  std::mutex log_latch_;
+  // descriptor of the db file, used with pread/pwrite from any number of threads at once
+  int db_fd_{-1};
   std::string file_name_;
+  bool direct_io_{false};
+  // size of the db file, kept here so that reads need no stat() call
+  std::atomic<off_t> db_file_size_{0};
+  // descriptor of the checksum file, only open if checksums are enabled
+  int checksum_fd_{-1};
+  std::string checksum_name_;
+  bool enable_checksums_;
+  std::atomic<bool> repair_checksums_{false};
+  // in-memory copy of the checksum file
+  std::vector<PageTrailer> trailers_;
+  // pages with a write in flight, and the condition their next writer waits on
+  std::unordered_set<page_id_t> writing_pages_;
+  std::condition_variable page_written_cv_;
+  // engine for asynchronous page I/O, unset for the SYNC backend
+  std::unique_ptr<DiskIOEngine> io_engine_;
+  std::atomic<int> num_checksum_failures_{0};
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  // Page I/O needs no latch; the checksum file, trailers_ and writing_pages_ are shared by all threads
+  std::mutex checksum_latch_;
 };
 
 }  // namespace bustub
@@ -10,14 +10,23 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <optional>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "recovery/log_manager.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_overflow_page.h"
 
 namespace bustub {
 
@@ -28,19 +37,43 @@ namespace bustub {
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, or with unique_keys off, have any number of values each
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrent writers crab down the tree, keeping the latches from the lowest page that a split or merge cannot reach.
+ * Readers first descend optimistically, taking no latches and checking page versions instead, and only crab down with
+ * read latches after a few descents were spoiled by writers. With a log manager and logging enabled, every
+ * insert or remove appends one index log record covering all the pages it changed, so that redo restores the tree
+ * without rebuilding it from the table.
+ *
+ * An empty tree can also be bulk loaded, which fills leaves left to right and builds the internal levels above them
+ * as it goes, so that every page is written once and in allocation order.
+ *
+ * With VarKeys, pages are slotted and fill by bytes rather than by count: see BPlusTreeKeyTraits. With an
+ * IntegerComparator on a single column, pages keep their keys apart from their values: see BPlusTreeLayoutTraits.
+ * Changes to either are logged as page images, since entries no longer sit at fixed offsets as pairs.
+ *
+ * Without unique keys, a leaf keeps the values of a key in one entry, as a sorted posting list, so that a lookup finds
+ * them all in one leaf and the key is stored once; a key with more values than a leaf list holds keeps them in a chain
+ * of overflow pages. Only pages of pairs have posting lists. Their changes are logged as page images too.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using KeyTraits = BPlusTreeKeyTraits<KeyType>;
+  using LayoutTraits = BPlusTreeLayoutTraits<KeyType, KeyComparator>;
+  using OverflowPage = BPlusTreeOverflowPage<ValueType>;
+  /** Whether changes to pages are logged as page images rather than as entries moved as pairs. */
+  static constexpr bool LOG_PAGE_IMAGES = KeyTraits::IS_VARIABLE || LayoutTraits::SPLIT_KEYS;
 
  public:
+  /** @param unique_keys whether a key has one value, or any number of them, which only pages of pairs support */
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     LogManager *log_manager = nullptr, bool unique_keys = true);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -48,16 +81,57 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and its values from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove one value of a key, and the key with its last value.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key, in order
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
+  /**
+   * Build this tree bottom-up from key-value pairs, filling pages to fill_factor of their capacity. Input in key
+   * order is loaded in a single pass; otherwise it is sorted externally in runs spilled to pages of the buffer pool.
+   * With unique keys, only the first pair read for a key is kept.
+   * @param next produces the next pair, returning false at the end of the input
+   * @return false if the tree is not empty, in which case nothing is read
+   */
+  auto BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = BULK_LOAD_FILL_FACTOR,
+                Transaction *transaction = nullptr) -> bool;
+
+  // Bulk load the pairs in [first, last).
+  template <typename InputIterator>
+  auto BulkLoad(InputIterator first, InputIterator last, double fill_factor = BULK_LOAD_FILL_FACTOR,
+                Transaction *transaction = nullptr) -> bool {
+    return BulkLoad(
+        [&first, &last](KeyType *key, ValueType *value) {
+          if (first == last) {
+            return false;
+          }
+          *key = first->first;
+          *value = first->second;
+          ++first;
+          return true;
+        },
+        fill_factor, transaction);
+  }
+
   // index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
+  /** A reversed iterator, from the greatest key down to the smallest. */
+  auto RBegin() -> INDEXITERATOR_TYPE;
+  /** A reversed iterator, from the greatest key not greater than key down to the smallest. */
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
+  /**
+   * An iterator over the keys between low and high, either of which may be left open. It ends at the far bound
+   * without reading the leaf past it.
+   * @param reverse whether to go from high down to low rather than up from low
+   */
+  auto Scan(const std::optional<IndexKeyBound<KeyType>> &low, const std::optional<IndexKeyBound<KeyType>> &high,
+            bool reverse = false) -> INDEXITERATOR_TYPE;
 
   // print the B+ tree
   void Print(BufferPoolManager *bpm);
@@ -71,45 +145,242 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
-  auto FindLeafPage(const KeyType &key, bool leftMost = false) -> Page *;
+  auto FindLeafPage(const KeyType &key, bool leftMost = false, bool rightMost = false) -> Page *;
 
  private:
-  void StartNewTree(const KeyType &key, const ValueType &value);
+  /** What a traversal is for, which decides the latches it takes and when a page is safe to release. */
+  enum class Operation { FIND, INSERT, REMOVE };
+
+  /**
+   * The state of one insert or remove: the latched pages live in the transaction's page set, with nullptr standing
+   * for the root latch; the changes are collected into ops_ for the log record.
+   */
+  struct WriteContext {
+    Transaction *transaction_;
+    /** The changes to log, or nullptr if logging is off. */
+    std::vector<IndexLogOp> *ops_;
+    LogRecordType log_record_type_;
+    bool root_changed_{false};
+  };
+
+  /** Remove key, or only value of it if given. */
+  void RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction);
+
+  void StartNewTree(const KeyType &key, const ValueType &value, WriteContext *context);
+
+  auto InsertIntoLeaf(const KeyType &key, const ValueType &value, WriteContext *context) -> std::optional<bool>;
+
+  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node, WriteContext *context);
+
+  template <typename N>
+  auto Split(N *node, WriteContext *context) -> N *;
 
-  auto InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
+  /** Split a leaf that has no room left in bytes. @return the half that key goes into */
+  auto SplitForRoom(LeafPage *leaf, const KeyType &key, WriteContext *context) -> LeafPage *;
 
-  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+  /**
+   * Append the values of key in leaf that the leaf holds.
+   * @param[out] overflow_page_id the first overflow page holding the values instead, or INVALID_PAGE_ID
+   * @return whether leaf has key
+   */
+  auto LookupValues(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *values,
+                    page_id_t *overflow_page_id) const -> bool;
+
+  /** Add value to those of key, which leaf has. @return false if key has value already, nullopt as InsertIntoLeaf */
+  auto InsertIntoPostingList(LeafPage *leaf, const KeyType &key, const ValueType &value, WriteContext *context)
+      -> std::optional<bool>;
+
+  /** Remove value from the posting list of the entry at index of leaf. @return false if the list does not have it */
+  auto RemoveFromPostingList(LeafPage *leaf, int index, const ValueType &value, WriteContext *context) -> bool;
+
+  /** Write values, in order, to a new chain of overflow pages, which are write latched. @return its first page */
+  auto CreateOverflowList(const std::vector<ValueType> &values, WriteContext *context) -> page_id_t;
+
+  /** Add value to the chain of overflow pages at page_id. @return false if the chain has it already */
+  auto InsertIntoOverflowList(page_id_t page_id, const ValueType &value, WriteContext *context) -> bool;
+
+  /** Remove value from the chain of overflow pages at page_id. @return the values left, or -1 if it was not there */
+  auto RemoveFromOverflowList(page_id_t page_id, const ValueType &value, WriteContext *context) -> int;
+
+  /** Collect the chain of overflow pages at page_id, if any, in the deleted page set of transaction. */
+  void DeleteOverflowList(page_id_t page_id, Transaction *transaction);
+
+  /** Fetch and write latch an overflow page that changes, and add it to the page set. */
+  auto LatchOverflowPage(page_id_t page_id, WriteContext *context) -> OverflowPage *;
 
   template <typename N>
-  auto Split(N *node) -> N *;
+  auto CoalesceOrRedistribute(N *node, WriteContext *context) -> bool;
 
+  /** Whether right fits into left, the page before it, with middle_key between them if they are internal pages. */
   template <typename N>
-  auto CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr) -> bool;
+  auto CanCoalesce(N *left, N *right, const KeyType &middle_key) const -> bool;
 
   template <typename N>
   auto Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr) -> bool;
+                int index, WriteContext *context) -> bool;
 
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, int index, InternalPage *parent, WriteContext *context);
 
-  auto AdjustRoot(BPlusTreePage *node) -> bool;
+  auto AdjustRoot(BPlusTreePage *node, WriteContext *context) -> bool;
 
   void UpdateRootPageId(int insert_record = 0);
 
+  /** Read the root page id from the header page the first time the tree is used, so that a reopened tree finds it. */
+  void LoadRootPageId();
+
+  /**
+   * Descend from the root to the leaf for key. The caller holds the root latch, in write mode unless op is FIND.
+   * For FIND, the returned leaf is read latched and the root latch released; otherwise the leaf and the ancestors
+   * it may change are write latched and in the page set.
+   */
+  auto FindLeaf(const KeyType &key, Operation op, Transaction *transaction, bool left_most = false,
+                bool right_most = false) -> Page *;
+
+  /**
+   * Descend from the root to the leaf for key without latches, validating each page's version before trusting what
+   * was read from it. On success *leaf is the pinned leaf, or nullptr for an empty tree, and *version is the version
+   * the leaf must still have once the caller has read it.
+   * @return false if a writer got in the way, in which case nothing is left pinned and the descent should restart
+   */
+  auto FindLeafOptimistic(const KeyType &key, bool left_most, bool right_most, Page **leaf, uint64_t *version) -> bool;
+
+  /** The child of node to descend into for key, or its first or last child. */
+  auto ChildFor(const InternalPage *node, const KeyType &key, bool left_most, bool right_most) const -> page_id_t;
+
+  /** Whether an operation on node can leave its parent untouched. */
+  auto IsSafe(BPlusTreePage *node, Operation op, bool is_root) const -> bool;
+
+  /** Release the latches in the page set, unpin the pages and delete the ones emptied by merges. */
+  void ReleasePageSet(Transaction *transaction, bool is_dirty);
+
+  /** The parent of a page in the page set, which is the page latched before it. */
+  auto GetParentPage(BPlusTreePage *node, Transaction *transaction) -> InternalPage *;
+
+  /** Write latch the leaf after leaf, if any, and add it to the page set. @return false if another holds it */
+  auto TryLatchNextLeaf(LeafPage *leaf, Transaction *transaction) -> bool;
+
+  /** Point the leaf after leaf, latched by TryLatchNextLeaf, back at leaf. */
+  void SetPrevOfNextLeaf(LeafPage *leaf, WriteContext *context);
+
+  /** Fetch a page of the tree, throwing if the buffer pool is out of frames. */
+  auto FetchNodePage(page_id_t page_id) -> Page *;
+
+  /** Allocate a page for a split or a new root; it is write latched and added to the page set. */
+  auto NewNodePage(page_id_t *page_id, Transaction *transaction) -> Page *;
+
+  /** Append the record for the changes in context and stamp the changed pages, then publish a new root. */
+  void FinishWrite(WriteContext *context);
+
+  /** One level of a bulk load: the page being filled, and the one before it, kept so that the last can borrow. */
+  struct BulkLoadLevel {
+    Page *prev_page_{nullptr};
+    Page *page_{nullptr};
+  };
+
+  /** A tree, or with leaves_only_ just a chain of leaves holding a sorted run, being built bottom-up. */
+  struct BulkLoadState {
+    std::vector<BulkLoadLevel> levels_;
+    int leaf_fill_;
+    int internal_fill_;
+    /** The fill factor for pages that fill by bytes. */
+    double fill_factor_;
+    bool leaves_only_;
+    KeyType last_key_;
+    /** The values of last_key_, without unique keys, which are appended once the next key shows there are no more. */
+    std::vector<ValueType> values_;
+    /** The low fence of the next leaf to finish, for pages that have fences. */
+    KeyType low_key_;
+    size_t size_{0};
+    page_id_t first_leaf_page_id_{INVALID_PAGE_ID};
+    std::vector<page_id_t> internal_page_ids_;
+    std::vector<page_id_t> page_ids_;
+  };
+
+  auto NewBulkLoadState(double fill_factor, bool leaves_only) const -> BulkLoadState;
+
+  /** Append a pair after the ones loaded so far, skipping a repeated key. @return false if key is out of order */
+  auto BulkLoadAdd(BulkLoadState *state, const KeyType &key, const ValueType &value) -> bool;
+
+  /** Append a pair to a level, with list_bytes of a posting list to follow in a leaf. */
+  template <typename N, typename V>
+  void BulkLoadAppend(BulkLoadState *state, size_t level, const KeyType &key, const V &value, int list_bytes = 0);
+
+  /** Append last_key_ with the values collected for it. */
+  void BulkLoadAppendValues(BulkLoadState *state);
+
+  /**
+   * Whether a page has taken all that it should before the next page of its level starts, or has no room left for
+   * a pair with list_bytes of a posting list.
+   */
+  template <typename N>
+  auto BulkLoadIsFull(const BulkLoadState *state, N *node, int list_bytes = 0) const -> bool;
+
+  /** Add a full page to its parent and unpin it. next_page is the page after it, or nullptr for the last. */
+  template <typename N>
+  void BulkLoadFinishPage(BulkLoadState *state, size_t level, Page *page, Page *next_page);
+
+  /** Balance and finish the last pages of a level. @return the root if it is on this level, else INVALID_PAGE_ID */
+  template <typename N>
+  auto BulkLoadFinishLevel(BulkLoadState *state, size_t level) -> page_id_t;
+
+  /** Finish every level. @return the root, or the first leaf of a run */
+  auto BulkLoadFinish(BulkLoadState *state) -> page_id_t;
+
+  /** Turn a tree whose input turned out to be unsorted into a sorted run. @return the first leaf of the run */
+  auto BulkLoadAbandon(BulkLoadState *state) -> page_id_t;
+
+  /** Merge sorted runs, deleting their pages as they are read. */
+  void MergeRuns(const std::vector<page_id_t> &runs, BulkLoadState *state);
+
+  /** Point the children in [first, last) of an internal page at it, after they moved there. */
+  void AdoptChildren(InternalPage *node, int first, int last);
+
+  // Collect the changes to a page for its log record; they are no-ops while logging is off.
+  template <typename N>
+  void LogFormat(N *node, WriteContext *context);
+  template <typename N>
+  void LogInsertEntries(N *node, int slot, int count, WriteContext *context);
+  template <typename N>
+  void LogRemoveEntries(N *node, int slot, int count, WriteContext *context);
+  template <typename N>
+  void LogSetEntry(N *node, int slot, WriteContext *context);
+  void LogSetPage(IndexLogOpType type, page_id_t page_id, page_id_t value, WriteContext *context);
+  void LogSetRoot(WriteContext *context);
+  /** Whether changes to pages are logged as page images, as they are with posting lists. */
+  auto UsesPageImages() const -> bool { return LOG_PAGE_IMAGES || !unique_keys_; }
+  /** Mark a page to be logged as an image once the write is done. */
+  void LogPageImage(BPlusTreePage *node, WriteContext *context);
+  /** Replace the marks with images of the pages as they are now, one per page, after the other changes. */
+  void TakePageImages(WriteContext *context);
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
   void ToString(BPlusTreePage *page, BufferPoolManager *bpm) const;
 
+  /** The fill factor of bulk loaded pages, which leaves some room for inserts before pages split. */
+  static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;
+  /** How many leaves worth of pairs an unsorted bulk load sorts in memory at a time. */
+  static constexpr int BULK_LOAD_RUN_PAGES = 256;
+  /** How many sorted runs are merged at once, each keeping a page pinned. */
+  static constexpr size_t BULK_LOAD_MERGE_WAYS = 16;
+  /** How many optimistic descents a read tries before it falls back to latch crabbing. */
+  static constexpr int MAX_OPTIMISTIC_READS = 8;
+
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  /** Atomic for optimistic readers; only changed under the root latch, with the old root write latched if any. */
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  LogManager *log_manager_;
+  bool unique_keys_;
+  /** Serializes writers and the readers that fell back to crabbing; writers keep it until the root is known to stay. */
+  ReaderWriterLatch root_latch_;
+  std::once_flag root_loaded_;
 };
 
 }  // namespace bustub
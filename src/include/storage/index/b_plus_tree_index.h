@@ -26,7 +26,8 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 LogManager *log_manager = nullptr);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -34,6 +35,9 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  auto ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive, bool reverse,
+                 Transaction *transaction) -> std::unique_ptr<IndexCursor> override;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -41,6 +45,9 @@ class BPlusTreeIndex : public Index {
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
  protected:
+  /** The index key for a tuple of the key schema. */
+  auto ToIndexKey(const Tuple &key) const -> KeyType;
+
   // comparator for key
   KeyComparator comparator_;
   // container
@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
+#include <type_traits>
 
 #include "storage/table/tuple.h"
 #include "type/value.h"
@@ -103,4 +105,49 @@ class GenericComparator {
   Schema *key_schema_;
 };
 
+/**
+ * Function object that compares GenericKeys made of ColumnCount integer columns of IntType, read straight from the
+ * key bytes instead of deserialized into Values. A key tuple lays its inlined columns out back to back, so column i
+ * is the IntType at offset i * sizeof(IntType). NULLs are stored as the type's minimum and sort first.
+ */
+template <size_t KeySize, typename IntType, size_t ColumnCount = 1>
+class IntegerComparator {
+  static_assert(std::is_same_v<IntType, int32_t> || std::is_same_v<IntType, int64_t>, "INTEGER or BIGINT columns");
+  static_assert(sizeof(IntType) * ColumnCount <= KeySize, "key columns must fit in the key");
+
+ public:
+  inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    for (size_t i = 0; i < ColumnCount; i++) {
+      IntType lhs_value = ColumnOf(lhs, i);
+      IntType rhs_value = ColumnOf(rhs, i);
+      if (lhs_value != rhs_value) {
+        return lhs_value < rhs_value ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  /** The integer of column i of key. */
+  static inline auto ColumnOf(const GenericKey<KeySize> &key, size_t i = 0) -> IntType {
+    IntType value;
+    memcpy(&value, key.data_ + i * sizeof(IntType), sizeof(IntType));
+    return value;
+  }
+
+  /** Whether keys of key_schema are laid out the way this comparator reads them. */
+  static auto Accepts(const Schema &key_schema) -> bool {
+    if (key_schema.GetColumnCount() != ColumnCount) {
+      return false;
+    }
+    const TypeId type = sizeof(IntType) == sizeof(int32_t) ? TypeId::INTEGER : TypeId::BIGINT;
+    return std::all_of(key_schema.GetColumns().begin(), key_schema.GetColumns().end(),
+                       [type](const Column &column) { return column.GetType() == type; });
+  }
+
+  IntegerComparator() = default;
+
+  // The layout is fixed by the template arguments, so the key schema is not needed.
+  explicit IntegerComparator(Schema * /*key_schema*/) {}
+};
+
 }  // namespace bustub
@@ -43,10 +43,14 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param is_unique Whether a key maps to at most one tuple
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true)
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -72,6 +76,9 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
+  /** @return Whether a key maps to at most one tuple */
+  inline auto IsUnique() const -> bool { return is_unique_; }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -92,10 +99,27 @@ class IndexMetadata {
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
   const std::vector<uint32_t> key_attrs_;
+  /** Whether a key maps to at most one tuple */
+  bool is_unique_;
   /** The schema of the indexed key */
   Schema *key_schema_;
 };
 
+/**
+ * A cursor over the RIDs that a range scan of an index finds, in the order of the scan.
+ */
+class IndexCursor {
+ public:
+  virtual ~IndexCursor() = default;
+
+  /**
+   * Yield the next RID of the scan.
+   * @param[out] rid the next RID
+   * @return false once the scan is exhausted
+   */
+  virtual auto Next(RID *rid) -> bool = 0;
+};
+
 /////////////////////////////////////////////////////////////////////
 // Index class definition
 /////////////////////////////////////////////////////////////////////
@@ -175,6 +199,25 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  ///////////////////////////////////////////////////////////////////
+  // Range Scan
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * Scan the index in key order for the keys between two bounds, either of which may be left open.
+   * @param low The smallest key to scan, a tuple of the key schema, or nullptr to start at the first key
+   * @param low_inclusive Whether the scan includes low itself
+   * @param high The greatest key to scan, or nullptr to end at the last key
+   * @param high_inclusive Whether the scan includes high itself
+   * @param reverse Whether to scan from high down to low
+   * @param transaction The transaction context
+   * @return A cursor over the RIDs of the keys, or nullptr if the index keeps no key order
+   */
+  virtual auto ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive, bool reverse,
+                         Transaction *transaction) -> std::unique_ptr<IndexCursor> {
+    return nullptr;
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
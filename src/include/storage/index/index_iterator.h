@@ -13,31 +13,100 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <optional>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_overflow_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/** One end of a range of keys, which the range may or may not include. */
+template <typename KeyType>
+struct IndexKeyBound {
+  KeyType key_;
+  bool inclusive_{true};
+};
+
+/**
+ * Iterates over the entries of the leaves from a starting position, up the keys or, reversed, down them. The iterator
+ * keeps its leaf pinned but not latched, so it must not run concurrently with changes to the tree.
+ *
+ * An iterator with a stop bound ends at the first key past it. It also ends without fetching the next leaf when the
+ * last key of its leaf, the first for a reversed iterator, has reached the bound, since every key after it is past.
+ *
+ * A key with a posting list yields one pair for each of its values, in value order, or reversed.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** The end iterator. */
   IndexIterator();
+  /**
+   * @param buffer_pool_manager the buffer pool the tree lives in
+   * @param page a pinned leaf, released by the iterator
+   * @param index the position in the leaf, which may be one past its last entry, or -1 for a reversed iterator
+   * @param reverse whether to move from greater keys to smaller ones
+   * @param comparator the comparator of the tree, which must outlive the iterator if there is a stop bound
+   * @param stop the bound in the direction of travel that ends the iteration, if any
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index, bool reverse = false,
+                const KeyComparator *comparator = nullptr, std::optional<IndexKeyBound<KeyType>> stop = std::nullopt);
   ~IndexIterator();  // NOLINT
 
+  IndexIterator(const IndexIterator &) = delete;
+  auto operator=(const IndexIterator &) -> IndexIterator & = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
+
   auto IsEnd() -> bool;
 
   auto operator*() -> const MappingType &;
 
+  /** Move to the next entry in the direction of travel. */
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return GetPageId() == itr.GetPageId() &&
+           (page_ == nullptr || (index_ == itr.index_ && posting_index_ == itr.posting_index_));
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  auto GetPageId() const -> page_id_t { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+
+  /**
+   * Move on to the next leaf in the direction of travel while past the end of the current one, and become the end
+   * iterator once past the stop bound.
+   */
+  void SettleOnEntry();
+
+  /** Read the posting list of the current entry, if it has one, and start at its first value in the direction. */
+  void LoadPostings();
+
+  /** How key compares to the stop bound in the direction of travel: positive if it lies beyond. */
+  auto CompareToStop(const KeyType &key) const -> int;
+
+  /** Unpin the leaf and become the end iterator. */
+  void Finish();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  int index_{0};
+  bool reverse_{false};
+  const KeyComparator *comparator_{nullptr};
+  std::optional<IndexKeyBound<KeyType>> stop_;
+  /** The pair last dereferenced, copied out since leaves of VarKeys do not store whole keys. */
+  MappingType item_;
+  /** The values of the current entry when it has a posting list, and the one to return next. */
+  std::vector<ValueType> postings_;
+  int posting_index_{0};
 };
 
 }  // namespace bustub
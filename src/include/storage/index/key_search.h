@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * KeySearch finds keys in the sorted integer key arrays of B+ tree pages that keep their keys apart from their
+ * values. A branchless binary search narrows the array down to a window of a few cache lines, and a count of the keys
+ * in the window that are less than the key finishes it: with AVX2 or SSE 4.2 compares when the CPU has them, and a
+ * scalar loop otherwise.
+ */
+class KeySearch {
+ public:
+  /**
+   * @param keys keys in ascending order
+   * @param size number of keys
+   * @param key the key to look for
+   * @return the index of the first key that is not less than key, size if there is none
+   */
+  static auto LowerBound(const int32_t *keys, int size, int32_t key) -> int;
+  static auto LowerBound(const int64_t *keys, int size, int64_t key) -> int;
+
+  /** @return the index of the first key that is greater than key, size if there is none */
+  static auto UpperBound(const int32_t *keys, int size, int32_t key) -> int;
+  static auto UpperBound(const int64_t *keys, int size, int64_t key) -> int;
+
+  /** Same as LowerBound, but never uses SIMD instructions. */
+  static auto LowerBoundScalar(const int32_t *keys, int size, int32_t key) -> int;
+  static auto LowerBoundScalar(const int64_t *keys, int size, int64_t key) -> int;
+
+  /** @return true if LowerBound and UpperBound compare keys with the SIMD instructions of this CPU */
+  static auto HasSimdSupport() -> bool;
+};
+
+}  // namespace bustub
@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// var_key.h
+//
+// Identification: src/include/storage/index/var_key.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * A key of up to KeySize bytes whose byte order is its key order, so that keys compare with memcmp and pages can
+ * store only the bytes that tell neighboring keys apart.
+ *
+ * Each column is encoded after a flag byte that sorts NULL first. Integers are stored big-endian with the sign bit
+ * flipped, decimals as their bits with the sign bit flipped, or all bits if negative, and strings with each 0x00
+ * escaped as 0x00 0xFF and terminated by 0x00 0x00, so that a string sorts before its extensions. Keys longer than
+ * KeySize are cut, and then compare equal to the keys they share their first KeySize bytes with.
+ */
+template <size_t KeySize>
+class VarKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
+    size_ = 0;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      Value value = tuple.GetValue(key_schema, i);
+      if (value.IsNull()) {
+        Append('\0');
+        continue;
+      }
+      Append('\1');
+      switch (value.GetTypeId()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          AppendInteger(value.GetAs<int8_t>(), 1);
+          break;
+        case TypeId::SMALLINT:
+          AppendInteger(value.GetAs<int16_t>(), 2);
+          break;
+        case TypeId::INTEGER:
+          AppendInteger(value.GetAs<int32_t>(), 4);
+          break;
+        case TypeId::BIGINT:
+        case TypeId::TIMESTAMP:
+          AppendInteger(value.GetAs<int64_t>(), 8);
+          break;
+        case TypeId::DECIMAL: {
+          double decimal = value.GetAs<double>();
+          uint64_t bits;
+          memcpy(&bits, &decimal, sizeof(bits));
+          bits = (bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63);
+          AppendInteger(static_cast<int64_t>(bits ^ (uint64_t{1} << 63)), 8);
+          break;
+        }
+        case TypeId::VARCHAR: {
+          const char *data = value.GetData();
+          size_t length = strnlen(data, value.GetLength());
+          for (size_t j = 0; j < length; j++) {
+            Append(data[j]);
+            if (data[j] == '\0') {
+              Append('\xff');
+            }
+          }
+          Append('\0');
+          Append('\0');
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+
+  // NOTE: for test purpose only
+  inline void SetFromInteger(int64_t key) {
+    size_ = 0;
+    AppendInteger(key, sizeof(int64_t));
+  }
+
+  inline void SetFromBytes(const char *data, size_t size) {
+    size_ = static_cast<uint16_t>(std::min(size, KeySize));
+    memcpy(data_, data, size_);
+  }
+
+  inline auto GetData() const -> const char * { return data_; }
+  inline auto GetSize() const -> size_t { return size_; }
+
+  /** The shortest key that sorts after left and no later than right, which must sort after left. */
+  static inline auto Separator(const VarKey &left, const VarKey &right) -> VarKey {
+    size_t common = CommonPrefix(left, right, 0);
+    VarKey separator;
+    separator.SetFromBytes(right.data_, std::min<size_t>(common + 1, right.size_));
+    return separator;
+  }
+
+  /** The number of leading bytes that a and b share, at most limit if that is not 0. */
+  static inline auto CommonPrefix(const VarKey &a, const VarKey &b, size_t limit) -> size_t {
+    size_t size = std::min(a.size_, b.size_);
+    if (limit != 0) {
+      size = std::min(size, limit);
+    }
+    size_t common = 0;
+    while (common < size && a.data_[common] == b.data_[common]) {
+      common++;
+    }
+    return common;
+  }
+
+  // NOTE: for test purpose only
+  // a key set from an integer prints as that integer, any other key as hex
+  inline auto ToString() const -> std::string {
+    if (size_ == sizeof(int64_t)) {
+      uint64_t bits = 0;
+      for (size_t i = 0; i < sizeof(int64_t); i++) {
+        bits = bits << 8 | static_cast<uint8_t>(data_[i]);
+      }
+      return std::to_string(static_cast<int64_t>(bits ^ (uint64_t{1} << 63)));
+    }
+    std::ostringstream os;
+    for (size_t i = 0; i < size_; i++) {
+      os << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(static_cast<uint8_t>(data_[i]));
+    }
+    return os.str();
+  }
+
+  friend auto operator<<(std::ostream &os, const VarKey &key) -> std::ostream & {
+    os << key.ToString();
+    return os;
+  }
+
+  uint16_t size_{0};
+  char data_[KeySize];
+
+ private:
+  inline void Append(char byte) {
+    if (size_ < KeySize) {
+      data_[size_++] = byte;
+    }
+  }
+
+  inline void AppendInteger(int64_t value, int width) {
+    uint64_t bits = static_cast<uint64_t>(value) ^ (uint64_t{1} << (width * 8 - 1));
+    for (int i = width - 1; i >= 0; i--) {
+      Append(static_cast<char>(bits >> (i * 8)));
+    }
+  }
+};
+
+/**
+ * Orders VarKeys by their bytes, a key before its extensions.
+ */
+template <size_t KeySize>
+class VarKeyComparator {
+ public:
+  inline auto operator()(const VarKey<KeySize> &lhs, const VarKey<KeySize> &rhs) const -> int {
+    int cmp = memcmp(lhs.data_, rhs.data_, std::min(lhs.size_, rhs.size_));
+    if (cmp != 0) {
+      return cmp < 0 ? -1 : 1;
+    }
+    return lhs.size_ < rhs.size_ ? -1 : (lhs.size_ > rhs.size_ ? 1 : 0);
+  }
+
+  VarKeyComparator() = default;
+
+  // The key schema is only needed to encode keys, which VarKey does itself.
+  explicit VarKeyComparator(Schema * /*key_schema*/) {}
+};
+
+}  // namespace bustub
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <queue>
+#include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
 
@@ -18,7 +19,9 @@ namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_SIZE \
+  (BPlusTreeLayoutTraits<KeyType, KeyComparator>::MaxEntries(PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE, \
+                                                              sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -42,6 +45,7 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void SetKeyAt(int index, const KeyType &key);
   auto ValueIndex(const ValueType &value) const -> int;
   auto ValueAt(int index) const -> ValueType;
+  auto GetItem(int index) -> const MappingType &;
 
   auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
@@ -49,19 +53,161 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void Remove(int index);
   auto RemoveAndReturnOnlyChild() -> ValueType;
 
-  // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                        BufferPoolManager *buffer_pool_manager);
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                         BufferPoolManager *buffer_pool_manager);
+  // Split and Merge utility methods. Moved children are not told about their new parent; see BPlusTreePage.
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+
+  // Bulk loading appends children in key order, with the first child's key kept as the key of the whole page.
+  void CopyLastFrom(const MappingType &pair);
+
+  // The free space after the entries, which page images leave out.
+  auto GetFreeSpaceBegin() const -> int;
+  auto GetFreeSpaceEnd() const -> int;
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  void CopyNFrom(MappingType *items, int size);
+  void CopyFirstFrom(const MappingType &pair);
   // Flexible array member for page data.
   MappingType array_[1];
 };
+
+#define VAR_KEY_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<VarKey<KeySize>, ValueType, VarKeyComparator<KeySize>>
+
+/**
+ * Internal page for VarKeys, slotted so that every key takes only the bytes it has. The keys are the separators
+ * that leaf splits chose, the shortest that tell two leaves apart, so the page holds as many children as their length
+ * allows. The first key is invalid as on any internal page, but kept as it was given.
+ *
+ * Internal page format (slots are stored in key order, entries anywhere below the free space):
+ *  --------------------------------------------------------------------------------------------------
+ * | HEADER | SLOT(0) | ... | SLOT(n) | free space | KEY + PAGE_ID | ... | KEY + PAGE_ID |
+ *  --------------------------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 32 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | Capacity (4) | DataStart (2) | Unused (2) |
+ *  ---------------------------------------------------------------------
+ *
+ * As for leaves of VarKeys, the max size is what the page has plus what its free space takes of the longest entries.
+ */
+VAR_KEY_TEMPLATE_ARGUMENTS
+class BPlusTreeInternalPage<VarKey<KeySize>, ValueType, VarKeyComparator<KeySize>> : public BPlusTreePage {
+  using KeyType = VarKey<KeySize>;
+  using KeyComparator = VarKeyComparator<KeySize>;
+
+ public:
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+
+  auto KeyAt(int index) const -> KeyType;
+  void SetKeyAt(int index, const KeyType &key);
+  /** Whether the key at index can be replaced by key, which may be longer. */
+  auto CanSetKeyAt(int index, const KeyType &key) const -> bool;
+  auto ValueIndex(const ValueType &value) const -> int;
+  auto ValueAt(int index) const -> ValueType;
+  auto GetItem(int index) -> MappingType;
+
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
+  void Remove(int index);
+  auto RemoveAndReturnOnlyChild() -> ValueType;
+
+  // Split and Merge utility methods. Moved children are not told about their new parent; see BPlusTreePage.
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  /** Whether the children of sibling, the page after this one, fit into this page with middle_key between. */
+  auto CanMergeFrom(const BPlusTreeInternalPage *sibling, const KeyType &middle_key) const -> bool;
+
+  // Bulk loading appends children in key order, with the first child's key kept as the key of the whole page.
+  void CopyLastFrom(const MappingType &pair);
+
+  /** The share of the space for entries that is in use. */
+  auto GetFillFactor() const -> double;
+  // The free space between the slots and the entries, which page images leave out.
+  auto GetFreeSpaceBegin() const -> int;
+  auto GetFreeSpaceEnd() const -> int;
+
+ private:
+  static constexpr int MAX_ENTRY_SIZE = sizeof(VarKeySlot) + KeySize + sizeof(ValueType);
+
+  /** Compare key with the key at index. */
+  auto CompareAt(const KeyType &key, int index) const -> int;
+  /** The slot at index, made safe to follow if an optimistic reader sees it torn. */
+  auto SlotAt(int index) const -> VarKeySlot;
+  auto GetItems() const -> std::vector<MappingType>;
+  void SetItems(const std::vector<MappingType> &items);
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void UpdateMaxSize();
+
+  int capacity_;
+  uint16_t data_start_;
+  uint16_t unused_;
+  // Flexible array member for page data.
+  VarKeySlot slots_[1];
+};
+
+#define SPLIT_KEY_INTERNAL_PAGE_TYPE \
+  BPlusTreeInternalPage<GenericKey<KeySize>, ValueType, IntegerComparator<KeySize, IntType>>
+
+/**
+ * Internal page for keys of a single integer column, with the keys in an array of their own that a lookup scans with
+ * SIMD compares, and the child page ids stored from the end of the page down as leaf values are.
+ *
+ * Internal page format (keys are stored in increasing order):
+ *  -----------------------------------------------------------------------------------------------------
+ * | HEADER | KEY(0) | KEY(1) | ... | KEY(n) | free space | PAGE_ID(n) | ... | PAGE_ID(1) | PAGE_ID(0) |
+ *  -----------------------------------------------------------------------------------------------------
+ */
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+class BPlusTreeInternalPage<GenericKey<KeySize>, ValueType, IntegerComparator<KeySize, IntType>>
+    : public BPlusTreePage {
+  using KeyType = GenericKey<KeySize>;
+  using KeyComparator = IntegerComparator<KeySize, IntType>;
+
+ public:
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+
+  /** The key at index, with the bytes after its integer zeroed as a key set from a tuple has them. */
+  auto KeyAt(int index) const -> KeyType;
+  void SetKeyAt(int index, const KeyType &key);
+  auto ValueIndex(const ValueType &value) const -> int;
+  auto ValueAt(int index) const -> ValueType;
+  auto GetItem(int index) -> MappingType;
+
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
+  void Remove(int index);
+  auto RemoveAndReturnOnlyChild() -> ValueType;
+
+  // Split and Merge utility methods. Moved children are not told about their new parent; see BPlusTreePage.
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+
+  // Bulk loading appends children in key order, with the first child's key kept as the key of the whole page.
+  void CopyLastFrom(const MappingType &pair);
+
+  // The free space between the keys and the child page ids, which page images leave out.
+  auto GetFreeSpaceBegin() const -> int;
+  auto GetFreeSpaceEnd() const -> int;
+
+ private:
+  auto ValueSlot(int index) -> ValueType &;
+  auto ValueSlot(int index) const -> const ValueType &;
+  void InsertAt(int index, IntType key, const ValueType &value);
+  /** Append count entries of source, starting at index. */
+  void CopyNFrom(const BPlusTreeInternalPage *source, int index, int count);
+
+  // Flexible array member for the keys.
+  IntType keys_[1];
+};
 }  // namespace bustub
@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -18,36 +19,51 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_SIZE \
+  (BPlusTreeLayoutTraits<KeyType, KeyComparator>::MaxEntries(PAGE_SIZE - LEAF_PAGE_HEADER_SIZE, \
+                                                              sizeof(MappingType)))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Keys are unique within a page.
  *
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------
+ * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n) | free space | POSTING LISTS |
+ *  ---------------------------------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ----------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4)
+ *  ----------------------------------------------------------------
+ *
+ * Leaves are linked both ways, so that a scan can run down the keys as well as up them.
+ *
+ * A key of a tree without unique keys may have several values. They are kept in order as a posting list, packed with
+ * the other lists at the end of the page, and the entry's value then points at its list instead: a RID with page id
+ * IN_PAGE_POSTINGS and the list's offset and length in its slot number. A list longer than MAX_POSTINGS moves to
+ * overflow pages, which the entry then points at with page id OVERFLOW_POSTINGS. A page with posting lists fills by
+ * bytes as well as by count.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
+  /** The most values a posting list keeps in the page, an eighth of it, before they move to overflow pages. */
+  static constexpr int MAX_POSTINGS = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / 8 / sizeof(ValueType);
+
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
   auto KeyAt(int index) const -> KeyType;
   auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
   auto GetItem(int index) -> const MappingType &;
@@ -57,18 +73,224 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
   auto RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int;
 
-  // Split and Merge utility methods
+  // Split and Merge utility methods, which move posting lists along with their entries
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  /** Whether the entries of sibling, the page after this one, fit into this page. */
+  auto CanMergeFrom(const BPlusTreeLeafPage *sibling) const -> bool;
 
- private:
-  void CopyNFrom(MappingType *items, int size);
+  // Bulk loading appends items in key order.
   void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item);
+
+  /** Whether the entry at index has a posting list, in the page or in overflow pages. */
+  auto HasPostingList(int index) const -> bool;
+  /**
+   * Append the values of the entry at index that the page holds, in order. An optimistic reader may see a torn entry,
+   * which only sends it to the wrong values within the page.
+   * @return the first overflow page holding the values instead, or INVALID_PAGE_ID
+   */
+  auto GetValues(int index, std::vector<ValueType> *values) const -> page_id_t;
+  /** Whether the entry at index has room for a posting list of count values in the page. */
+  auto CanSetValues(int index, int count) const -> bool;
+  /** Replace the values of the entry at index with values, in order, for which it must have room. */
+  void SetValues(int index, const std::vector<ValueType> &values);
+  /** Point the entry at index at the overflow pages that now hold its values. */
+  void SetOverflowPageId(int index, page_id_t page_id);
+  /** The bytes left for entries and posting lists. */
+  auto GetFreeBytes() const -> int;
+  /** The bytes the entry at index takes, with its posting list. */
+  auto EntrySizeAt(int index) const -> int;
+
+  // The free space between the entries and the posting lists, which page images leave out.
+  auto GetFreeSpaceBegin() const -> int;
+  auto GetFreeSpaceEnd() const -> int;
+
+ private:
+  static constexpr page_id_t IN_PAGE_POSTINGS = -2;
+  static constexpr page_id_t OVERFLOW_POSTINGS = -3;
+
+  /** The posting list of the entry at index, which is in the page. */
+  auto PostingsAt(int index) const -> const ValueType *;
+  auto PostingCount(int index) const -> int;
+  /** Where the posting lists start, at the end of the page if there are none. */
+  auto GetPostingsBegin() const -> int;
+  /** Write a posting list for the entry at index below the others, for which there must be room. */
+  void AddPostings(int index, const ValueType *values, int count);
+  /** Close the gaps that lists of entries gone or changed left among the posting lists. */
+  void RepackPostings();
+  /** Append count entries of source, starting at index, with their posting lists. */
+  void CopyNFrom(const BPlusTreeLeafPage *source, int index, int count);
+  /** Insert the entry of source at index at the front, with its posting list. */
+  void CopyFirstFrom(const BPlusTreeLeafPage *source, int index);
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
   // Flexible array member for page data.
   MappingType array_[1];
 };
+
+#define VAR_KEY_LEAF_PAGE_TYPE BPlusTreeLeafPage<VarKey<KeySize>, ValueType, VarKeyComparator<KeySize>>
+
+/**
+ * Leaf page for VarKeys, slotted so that every entry takes only the key bytes it needs. Keys on the page lie between
+ * two fence keys: the low fence is the key its parent has for it, and the high fence the key for the page after it.
+ * Entries leave out the prefix that the fences share, which every key between them shares too. A split picks the
+ * shortest key that tells the two halves apart as the fence between them, which keeps separators short as well.
+ *
+ * Leaf page format (slots are stored in key order, entries anywhere below the free space):
+ *  ------------------------------------------------------------------------------------------------
+ * | HEADER | LOW FENCE | HIGH FENCE | SLOT(1) | ... | SLOT(n) | free space | KEY + RID | ... | KEY + RID |
+ *  ------------------------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 44 bytes in total, followed by KeySize bytes for each fence):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4) | Capacity (4) | DataStart (2) | PrefixSize (2) |
+ *  ---------------------------------------------------------------------------------------------------------------
+ *  ---------------------------------
+ * | LowFenceSize (2) | HighFenceSize (2) |
+ *  ---------------------------------
+ *
+ * The max size is what the page has plus what its free space takes of the longest entries, at most the capacity it
+ * was created with. An empty low fence and a high fence of size OPEN_FENCE stand for the ends of the key space.
+ */
+VAR_KEY_TEMPLATE_ARGUMENTS
+class BPlusTreeLeafPage<VarKey<KeySize>, ValueType, VarKeyComparator<KeySize>> : public BPlusTreePage {
+  using KeyType = VarKey<KeySize>;
+  using KeyComparator = VarKeyComparator<KeySize>;
+
+ public:
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
+  auto KeyAt(int index) const -> KeyType;
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+  auto GetItem(int index) -> MappingType;
+
+  // insert and delete methods
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+  auto RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int;
+
+  // Split and Merge utility methods, which move the fences along with the entries
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  /** Whether the entries of sibling, the page after this one, fit into this page. */
+  auto CanMergeFrom(const BPlusTreeLeafPage *sibling) const -> bool;
+
+  // Bulk loading appends items in key order.
+  void CopyLastFrom(const MappingType &item);
+
+  /** The low fence, which is the key the parent has for this page, or an empty key for the first leaf. */
+  auto GetLowKey() const -> KeyType;
+  /** Move the fences, nullptr for an open end, and repack the entries for the prefix the new fences share. */
+  void SetFences(const KeyType *low_key, const KeyType *high_key);
+
+  /** The share of the space for entries that is in use. */
+  auto GetFillFactor() const -> double;
+  // The free space between the slots and the entries, which page images leave out.
+  auto GetFreeSpaceBegin() const -> int;
+  auto GetFreeSpaceEnd() const -> int;
+
+ private:
+  static constexpr uint16_t OPEN_FENCE = UINT16_MAX;
+  static constexpr int MAX_ENTRY_SIZE = sizeof(VarKeySlot) + KeySize + sizeof(ValueType);
+
+  /** Compare key with the prefix: 0 if key has it, else the order of key and every key between the fences. */
+  auto ComparePrefix(const KeyType &key) const -> int;
+  /** Compare key, which has the prefix, with the key at index. */
+  auto CompareAt(const KeyType &key, int index) const -> int;
+  /** The slot at index, made safe to follow if an optimistic reader sees it torn. */
+  auto SlotAt(int index) const -> VarKeySlot;
+  auto ValueAt(int index) const -> ValueType;
+  auto GetItems() const -> std::vector<MappingType>;
+  /** Repack the page with items, which lie between the fences, for the prefix the fences share. */
+  void SetItems(const std::vector<MappingType> &items);
+  /** The high fence, if the page has one. */
+  auto GetHighKey() const -> std::optional<KeyType>;
+  /** Only write the fences; the entries must be repacked after. */
+  void WriteFences(const KeyType *low_key, const KeyType *high_key);
+  void UpdateMaxSize();
+
+  page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  int capacity_;
+  uint16_t data_start_;
+  uint16_t prefix_size_;
+  uint16_t low_size_;
+  uint16_t high_size_;
+  char low_key_[KeySize];
+  char high_key_[KeySize];
+  // Flexible array member for page data.
+  VarKeySlot slots_[1];
+};
+
+#define SPLIT_KEY_LEAF_PAGE_TYPE BPlusTreeLeafPage<GenericKey<KeySize>, ValueType, IntegerComparator<KeySize, IntType>>
+
+/**
+ * Leaf page for keys of a single integer column. The keys are an array of integers of their own, which a search
+ * scans with SIMD compares a window at a time rather than probing pairs a cache miss apart. The values are stored
+ * from the end of the page down, the first value last, so the free space is a single gap that page images leave out.
+ *
+ * Leaf page format (keys are stored in order):
+ *  ---------------------------------------------------------------------------------------------
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(n) | free space | RID(n) | ... | RID(2) | RID(1) |
+ *  ---------------------------------------------------------------------------------------------
+ *
+ * The header is that of any leaf page, with the keys aligned to their size after it.
+ */
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+class BPlusTreeLeafPage<GenericKey<KeySize>, ValueType, IntegerComparator<KeySize, IntType>> : public BPlusTreePage {
+  using KeyType = GenericKey<KeySize>;
+  using KeyComparator = IntegerComparator<KeySize, IntType>;
+
+ public:
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
+  /** The key at index, with the bytes after its integer zeroed as a key set from a tuple has them. */
+  auto KeyAt(int index) const -> KeyType;
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+  auto GetItem(int index) -> MappingType;
+
+  // insert and delete methods
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+  auto RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int;
+
+  // Split and Merge utility methods
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+
+  // Bulk loading appends items in key order.
+  void CopyLastFrom(const MappingType &item);
+
+  // The free space between the keys and the values, which page images leave out.
+  auto GetFreeSpaceBegin() const -> int;
+  auto GetFreeSpaceEnd() const -> int;
+
+ private:
+  auto ValueSlot(int index) -> ValueType &;
+  auto ValueSlot(int index) const -> const ValueType &;
+  void InsertAt(int index, IntType key, const ValueType &value);
+  void RemoveAt(int index, int count);
+  /** Append count entries of source, starting at index. */
+  void CopyNFrom(const BPlusTreeLeafPage *source, int index, int count);
+
+  page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  // Flexible array member for the keys.
+  IntType keys_[1];
+};
 }  // namespace bustub
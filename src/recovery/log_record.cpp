@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_record.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void LogRecord::SetSize(int body_size) {
+  int rest = sizeof(lsn_t) + VarintSize(static_cast<uint32_t>(txn_id_ + 1)) +
+             VarintSize(static_cast<uint32_t>(prev_lsn_ + 1)) + sizeof(uint8_t) + body_size;
+  // The size counts its own varint, which may take one more byte once that is added.
+  int size_size = VarintSize(rest);
+  while (VarintSize(rest + size_size) > size_size) {
+    size_size++;
+  }
+  size_ = rest + size_size;
+}
+
+auto LogRecord::DiffTuples(const Tuple &old_tuple, const Tuple &new_tuple) -> std::vector<UpdateRange> {
+  const char *old_data = old_tuple.GetData();
+  const char *new_data = new_tuple.GetData();
+  uint32_t common = std::min(old_tuple.GetLength(), new_tuple.GetLength());
+  std::vector<UpdateRange> ranges;
+  uint32_t i = 0;
+  while (i < common) {
+    if (old_data[i] == new_data[i]) {
+      i++;
+      continue;
+    }
+    uint32_t start = i;
+    uint32_t end = ++i;
+    for (; i < common; i++) {
+      if (old_data[i] != new_data[i]) {
+        end = i + 1;
+      } else if (i + 1 - end > MAX_UPDATE_RANGE_GAP) {
+        break;
+      }
+    }
+    ranges.push_back({start, std::string(old_data + start, end - start), std::string(new_data + start, end - start)});
+  }
+  if (old_tuple.GetLength() != new_tuple.GetLength()) {
+    // The tails past the shorter tuple differ in length, so they make the last range.
+    uint32_t start = common;
+    if (!ranges.empty() && common - ranges.back().offset_ - ranges.back().old_data_.size() <= MAX_UPDATE_RANGE_GAP) {
+      start = ranges.back().offset_;
+      ranges.pop_back();
+    }
+    ranges.push_back({start, std::string(old_data + start, old_tuple.GetLength() - start),
+                      std::string(new_data + start, new_tuple.GetLength() - start)});
+  }
+  return ranges;
+}
+
+auto LogRecord::ApplyUpdateRanges(const Tuple &tuple, bool forward) const -> Tuple {
+  const char *data = tuple.GetData();
+  // Serialized like a tuple, with its size first, so that the result deserializes from it.
+  std::string result(sizeof(int32_t), '\0');
+  uint32_t pos = 0;
+  int64_t shift = 0;
+  for (const auto &range : update_ranges_) {
+    uint32_t offset = forward ? range.offset_ : range.offset_ + shift;
+    const std::string &from = forward ? range.old_data_ : range.new_data_;
+    const std::string &to = forward ? range.new_data_ : range.old_data_;
+    BUSTUB_ASSERT(offset >= pos && offset + from.size() <= tuple.GetLength(), "update ranges must fit the tuple");
+    result.append(data + pos, offset - pos);
+    result.append(to);
+    pos = offset + from.size();
+    shift += static_cast<int64_t>(range.new_data_.size()) - static_cast<int64_t>(range.old_data_.size());
+  }
+  result.append(data + pos, tuple.GetLength() - pos);
+  auto size = static_cast<int32_t>(result.size() - sizeof(int32_t));
+  memcpy(result.data(), &size, sizeof(int32_t));
+  Tuple rebuilt;
+  rebuilt.DeserializeFrom(result.data());
+  return rebuilt;
+}
+
+}  // namespace bustub
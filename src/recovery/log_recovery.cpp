@@ -12,6 +12,15 @@
 
 #include "recovery/log_recovery.h"
 
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <queue>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+#include "storage/page/header_page.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
@@ -20,7 +29,99 @@ namespace bustub {
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool { return false; }
+auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool {
+  // The log ends where the file was zero-padded by ReadLog, which reads as a size of 0.
+  uint32_t size;
+  uint32_t txn_id;
+  uint32_t prev_lsn;
+  const char *pos = LogRecord::DecodeVarint(data, &size);
+  memcpy(&log_record->lsn_, pos, sizeof(lsn_t));
+  pos = LogRecord::DecodeVarint(pos + sizeof(lsn_t), &txn_id);
+  pos = LogRecord::DecodeVarint(pos, &prev_lsn);
+  log_record->log_record_type_ = static_cast<LogRecordType>(static_cast<uint8_t>(*pos++));
+  log_record->size_ = static_cast<int32_t>(size);
+  log_record->txn_id_ = static_cast<txn_id_t>(txn_id) - 1;
+  log_record->prev_lsn_ = static_cast<lsn_t>(prev_lsn) - 1;
+  if (size < static_cast<uint32_t>(pos - data) || log_record->log_record_type_ == LogRecordType::INVALID) {
+    return false;
+  }
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(&log_record->insert_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->insert_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(&log_record->delete_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->delete_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::UPDATE: {
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      uint32_t count;
+      pos = LogRecord::DecodeVarint(pos, &count);
+      log_record->update_ranges_.resize(count);
+      for (auto &range : log_record->update_ranges_) {
+        uint32_t old_size;
+        uint32_t new_size;
+        pos = LogRecord::DecodeVarint(pos, &range.offset_);
+        pos = LogRecord::DecodeVarint(pos, &old_size);
+        pos = LogRecord::DecodeVarint(pos, &new_size);
+        range.old_data_.assign(pos, old_size);
+        range.new_data_.assign(pos + old_size, new_size);
+        pos += old_size + new_size;
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, pos, sizeof(page_id_t));
+      memcpy(&log_record->page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT:
+      for (auto *table : {&log_record->active_txn_table_, &log_record->dirty_page_table_}) {
+        int32_t count;
+        memcpy(&count, pos, sizeof(int32_t));
+        pos += sizeof(int32_t);
+        for (int32_t i = 0; i < count; ++i) {
+          int32_t id;
+          lsn_t lsn;
+          memcpy(&id, pos, sizeof(int32_t));
+          memcpy(&lsn, pos + sizeof(int32_t), sizeof(lsn_t));
+          (*table)[id] = lsn;
+          pos += sizeof(int32_t) + sizeof(lsn_t);
+        }
+      }
+      break;
+    case LogRecordType::INDEX_INSERT:
+    case LogRecordType::INDEX_DELETE:
+    case LogRecordType::INDEX_SPLIT:
+    case LogRecordType::INDEX_MERGE:
+    case LogRecordType::INDEX_REDISTRIBUTE: {
+      int32_t count;
+      memcpy(&count, pos, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      log_record->index_ops_.resize(count);
+      for (auto &op : log_record->index_ops_) {
+        int32_t data_size;
+        memcpy(&op.type_, pos, sizeof(int32_t));
+        memcpy(&op.page_id_, pos + 4, sizeof(int32_t));
+        memcpy(&op.slot_, pos + 8, sizeof(int32_t));
+        memcpy(&op.value_, pos + 12, sizeof(int32_t));
+        memcpy(&op.entry_size_, pos + 16, sizeof(int32_t));
+        memcpy(&data_size, pos + 20, sizeof(int32_t));
+        op.data_.assign(pos + IndexLogOp::HEADER_SIZE, data_size);
+        pos += IndexLogOp::HEADER_SIZE + data_size;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
@@ -29,12 +130,306 @@ auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record)
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must run before logging is enabled.");
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  // A crash between writing a page and its checksum trailer leaves a mismatch that redo repairs.
+  disk_manager_->SetRepairChecksums(true);
+
+  // Parse phase: read the log sequentially and partition the page records by page id.
+  std::vector<RedoPartition> partitions(num_redo_threads_);
+  auto dispatch = [this, &partitions](page_id_t page_id, const LogRecord &log_record) {
+    partitions[std::hash<page_id_t>()(page_id) % num_redo_threads_].emplace_back(page_id, log_record);
+  };
+  // Segments before the one holding the restart LSN of the last checkpoint are gone; the log starts where it is.
+  offset_ = disk_manager_->GetLogSegmentOffset(disk_manager_->GetLogRestartLSN());
+  lsn_t checkpoint_lsn = INVALID_LSN;
+  bool end_of_log = false;
+  while (!end_of_log && disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset_)) {
+    int pos = 0;
+    while (pos + LogRecord::MAX_HEADER_SIZE <= LOG_BUFFER_SIZE) {
+      uint32_t size;
+      LogRecord::DecodeVarint(log_buffer_ + pos, &size);
+      if (size > static_cast<uint32_t>(LOG_BUFFER_SIZE - pos)) {
+        // The record continues past the buffer; read it again from its start.
+        break;
+      }
+      LogRecord log_record;
+      if (!DeserializeLogRecord(log_buffer_ + pos, &log_record)) {
+        end_of_log = true;
+        break;
+      }
+      lsn_mapping_[log_record.lsn_] = offset_ + pos;
+      if (log_record.log_record_type_ == LogRecordType::BEGIN_CHECKPOINT) {
+        checkpoint_lsn = log_record.lsn_;
+      } else if (log_record.log_record_type_ == LogRecordType::END_CHECKPOINT) {
+        ApplyCheckpoint(checkpoint_lsn, &log_record, &partitions);
+      } else if (log_record.log_record_type_ == LogRecordType::COMMIT ||
+                 log_record.log_record_type_ == LogRecordType::ABORT) {
+        active_txn_.erase(log_record.txn_id_);
+      } else if (log_record.txn_id_ != INVALID_TXN_ID) {
+        // Index changes belong to no transaction: they are only redone, and undone logically by the table's owner.
+        active_txn_[log_record.txn_id_] = log_record.lsn_;
+      }
+      page_id_t page_id = GetLogRecordPageId(&log_record);
+      if (page_id != INVALID_PAGE_ID) {
+        dispatch(page_id, log_record);
+      }
+      if (LogRecord::IsIndexRecord(log_record.log_record_type_)) {
+        // Each page of an index change is redone on its own, with the changes to it in their logged order.
+        std::unordered_map<page_id_t, std::vector<IndexLogOp>> page_ops;
+        for (auto &op : log_record.index_ops_) {
+          page_ops[op.page_id_].push_back(std::move(op));
+        }
+        log_record.index_ops_.clear();
+        for (auto &[op_page_id, ops] : page_ops) {
+          LogRecord page_record = log_record;
+          page_record.index_ops_ = std::move(ops);
+          dispatch(op_page_id, page_record);
+        }
+      }
+      if (log_record.log_record_type_ == LogRecordType::NEWPAGE && log_record.prev_page_id_ != INVALID_PAGE_ID) {
+        // Linking the new page into the previous one is a change of the previous page, so it goes to its partition.
+        dispatch(log_record.prev_page_id_, log_record);
+      }
+      pos += size;
+    }
+    if (pos == 0) {
+      break;
+    }
+    offset_ += pos;
+  }
+
+  // Apply phase: each thread owns the pages hashed to its partition and applies their records in LSN order.
+  // A thread that cannot read its page stops with an exception, which is rethrown here once all threads are done.
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(partitions.size());
+  for (size_t i = 0; i < partitions.size(); ++i) {
+    if (partitions[i].empty()) {
+      continue;
+    }
+    threads.emplace_back([this, &partition = partitions[i], &error = errors[i]] {
+      try {
+        for (auto &[page_id, log_record] : partition) {
+          RedoLogRecord(page_id, &log_record);
+        }
+      } catch (...) {
+        error = std::current_exception();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  disk_manager_->SetRepairChecksums(false);
+  for (auto &error : errors) {
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+  }
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  // Roll back the records of all unfinished transactions together, newest first.
+  std::priority_queue<lsn_t> to_undo;
+  for (const auto &[txn_id, lsn] : active_txn_) {
+    to_undo.push(lsn);
+  }
+  while (!to_undo.empty()) {
+    lsn_t lsn = to_undo.top();
+    to_undo.pop();
+    auto it = lsn_mapping_.find(lsn);
+    BUSTUB_ASSERT(it != lsn_mapping_.end(), "Undo must follow redo over the same log.");
+    LogRecord log_record;
+    if (!disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, it->second) ||
+        !DeserializeLogRecord(log_buffer_, &log_record)) {
+      continue;
+    }
+    UndoLogRecord(&log_record);
+    if (log_record.prev_lsn_ != INVALID_LSN) {
+      to_undo.push(log_record.prev_lsn_);
+    }
+  }
+  active_txn_.clear();
+  lsn_mapping_.clear();
+}
+
+void LogRecovery::ApplyCheckpoint(lsn_t checkpoint_lsn, LogRecord *log_record,
+                                  std::vector<RedoPartition> *partitions) {
+  // The active transaction table is left alone: the log is read from no later than the BEGIN record of any
+  // transaction in it, so the parse has tracked them all already, and a transaction that finished after the table was
+  // collected must not come back to be undone.
+  if (checkpoint_lsn == INVALID_LSN) {
+    return;
+  }
+  // Before the checkpoint, a page that was clean then had all its changes on disk, and a dirty page had those older
+  // than its recLSN. Redo thus starts from the smallest recLSN in the table.
+  const auto &dirty_page_table = log_record->dirty_page_table_;
+  for (auto &partition : *partitions) {
+    auto on_disk = [checkpoint_lsn, &dirty_page_table](const std::pair<page_id_t, LogRecord> &entry) {
+      const auto &[page_id, record] = entry;
+      // The header page has no LSN to order its flushes after the index records that change it.
+      if (record.lsn_ >= checkpoint_lsn || page_id == HEADER_PAGE_ID) {
+        return false;
+      }
+      auto it = dirty_page_table.find(page_id);
+      return it == dirty_page_table.end() || record.lsn_ < it->second;
+    };
+    partition.erase(std::remove_if(partition.begin(), partition.end(), on_disk), partition.end());
+  }
+}
+
+auto LogRecovery::GetLogRecordPageId(LogRecord *log_record) -> page_id_t {
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      return log_record->insert_rid_.GetPageId();
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return log_record->delete_rid_.GetPageId();
+    case LogRecordType::UPDATE:
+      return log_record->update_rid_.GetPageId();
+    case LogRecordType::NEWPAGE:
+      return log_record->page_id_;
+    default:
+      return INVALID_PAGE_ID;
+  }
+}
+
+auto LogRecovery::FetchPage(page_id_t page_id) -> Page * {
+  uint64_t read_failures = buffer_pool_manager_->GetStats().read_failures_;
+  Page *page;
+  while ((page = buffer_pool_manager_->FetchPage(page_id)) == nullptr) {
+    // A page that cannot be read never will be, and a failure in another thread leaves its pages unrecovered too.
+    if (buffer_pool_manager_->GetStats().read_failures_ != read_failures) {
+      throw Exception("recovery cannot read page " + std::to_string(page_id));
+    }
+    // Otherwise the pool is full. Every redo thread pins at most one page, so a frame frees up once another thread is
+    // done with its record.
+    std::this_thread::yield();
+  }
+  return page;
+}
+
+auto LogRecovery::FetchTablePage(page_id_t page_id) -> TablePage * {
+  return reinterpret_cast<TablePage *>(FetchPage(page_id));
+}
+
+void LogRecovery::RedoLogRecord(page_id_t page_id, LogRecord *log_record) {
+  if (LogRecord::IsIndexRecord(log_record->log_record_type_)) {
+    RedoIndexLogRecord(page_id, log_record);
+    return;
+  }
+  TablePage *page = FetchTablePage(page_id);
+  page->WLatch();
+  bool redo = page->GetLSN() < log_record->lsn_;
+  if (redo) {
+    switch (log_record->log_record_type_) {
+      case LogRecordType::INSERT: {
+        // Slots are picked deterministically, so replaying in LSN order puts the tuple back into its slot.
+        RID rid;
+        page->InsertTuple(log_record->insert_tuple_, &rid, nullptr, nullptr, nullptr);
+        BUSTUB_ASSERT(rid == log_record->insert_rid_, "Redo must insert the tuple into its logged slot.");
+        break;
+      }
+      case LogRecordType::MARKDELETE:
+        page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+        break;
+      case LogRecordType::APPLYDELETE:
+        page->ApplyDelete(log_record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::ROLLBACKDELETE:
+        page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::UPDATE: {
+        // The page holds the tuple as it was before the update, which the record only has the changes to.
+        Tuple old_tuple;
+        page->GetTuple(log_record->update_rid_, &old_tuple, nullptr, nullptr);
+        page->UpdateTuple(log_record->GetUpdateTuple(old_tuple), &old_tuple, log_record->update_rid_, nullptr, nullptr,
+                          nullptr);
+        break;
+      }
+      case LogRecordType::NEWPAGE:
+        if (page_id == log_record->page_id_) {
+          page->Init(page_id, PAGE_SIZE, log_record->prev_page_id_, nullptr, nullptr);
+        } else {
+          // The previous page is latched while a page is appended, so a later LSN on it implies the link.
+          page->SetNextPageId(log_record->page_id_);
+        }
+        break;
+      default:
+        break;
+    }
+    page->SetLSN(log_record->lsn_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, redo);
+}
+
+void LogRecovery::RedoIndexLogRecord(page_id_t page_id, LogRecord *log_record) {
+  Page *page = FetchPage(page_id);
+  page->WLatch();
+  // The header page has no LSN, but setting a root is idempotent and the records are replayed in order.
+  bool is_header_page = page_id == HEADER_PAGE_ID;
+  bool redo = is_header_page || page->GetLSN() < log_record->lsn_;
+  if (redo) {
+    for (const IndexLogOp &op : log_record->GetIndexOps()) {
+      if (op.type_ == IndexLogOpType::SET_ROOT) {
+        auto *header_page = reinterpret_cast<HeaderPage *>(page);
+        if (!header_page->UpdateRecord(op.data_, op.value_)) {
+          header_page->InsertRecord(op.data_, op.value_);
+        }
+      } else {
+        reinterpret_cast<BPlusTreePage *>(page->GetData())->ApplyLogOp(op);
+      }
+    }
+    if (!is_header_page) {
+      page->SetLSN(log_record->lsn_);
+    }
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, redo);
+}
+
+void LogRecovery::UndoLogRecord(LogRecord *log_record) {
+  page_id_t page_id = GetLogRecordPageId(log_record);
+  if (page_id == INVALID_PAGE_ID || log_record->log_record_type_ == LogRecordType::NEWPAGE) {
+    return;
+  }
+  TablePage *page = FetchTablePage(page_id);
+  page->WLatch();
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      page->ApplyDelete(log_record->insert_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::MARKDELETE:
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE: {
+      RID rid;
+      page->InsertTuple(log_record->delete_tuple_, &rid, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::ROLLBACKDELETE:
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      Tuple new_tuple;
+      page->GetTuple(log_record->update_rid_, &new_tuple, nullptr, nullptr);
+      page->UpdateTuple(log_record->GetOriginalTuple(new_tuple), &new_tuple, log_record->update_rid_, nullptr, nullptr,
+                        nullptr);
+      break;
+    }
+    default:
+      break;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 }  // namespace bustub
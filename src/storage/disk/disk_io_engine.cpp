@@ -0,0 +1,356 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_io_engine.cpp
+//
+// Identification: src/storage/disk/disk_io_engine.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_io_engine.h"
+
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/config.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+auto DiskIOEngine::Create(DiskIOBackend backend) -> std::unique_ptr<DiskIOEngine> {
+  if (backend == DiskIOBackend::IO_URING) {
+    auto io_uring = std::make_unique<IoUringDiskIOEngine>(DISK_IO_QUEUE_DEPTH);
+    if (io_uring->IsReady()) {
+      return io_uring;
+    }
+    LOG_DEBUG("io_uring is not available, falling back to the pread/pwrite thread pool");
+  }
+  return std::make_unique<ThreadPoolDiskIOEngine>(DISK_IO_THREADS);
+}
+
+auto DiskIOEngine::ReadFully(int fd, char *data, size_t size, off_t offset) -> ssize_t {
+  // A short read only means that the file ends early.
+  size_t done = 0;
+  while (done < size) {
+    ssize_t result = pread(fd, data + done, size - done, offset + done);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      return -errno;
+    }
+    if (result == 0) {
+      break;
+    }
+    done += result;
+  }
+  return static_cast<ssize_t>(done);
+}
+
+auto DiskIOEngine::ReadvFully(int fd, std::vector<iovec> iov, off_t offset) -> ssize_t {
+  size_t done = 0;
+  size_t first = 0;
+  while (first < iov.size()) {
+    ssize_t result = preadv(fd, iov.data() + first, static_cast<int>(iov.size() - first), offset + done);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      return -errno;
+    }
+    if (result == 0) {
+      break;
+    }
+    done += result;
+    // Skip the buffers that are full, and go on in the one the read stopped in.
+    auto remaining = static_cast<size_t>(result);
+    while (first < iov.size() && remaining >= iov[first].iov_len) {
+      remaining -= iov[first].iov_len;
+      first++;
+    }
+    if (first < iov.size()) {
+      iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + remaining;
+      iov[first].iov_len -= remaining;
+    }
+  }
+  return static_cast<ssize_t>(done);
+}
+
+auto DiskIOEngine::WriteFully(int fd, const char *data, size_t size, off_t offset) -> ssize_t {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t result = pwrite(fd, data + done, size - done, offset + done);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      return -errno;
+    }
+    done += result;
+  }
+  return static_cast<ssize_t>(done);
+}
+
+/*****************************************************************************
+ * THREAD POOL
+ *****************************************************************************/
+
+ThreadPoolDiskIOEngine::ThreadPoolDiskIOEngine(size_t num_threads) {
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&ThreadPoolDiskIOEngine::Run, this);
+  }
+}
+
+ThreadPoolDiskIOEngine::~ThreadPoolDiskIOEngine() {
+  {
+    std::scoped_lock latch(latch_);
+    running_ = false;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPoolDiskIOEngine::SubmitRead(int fd, char *data, size_t size, off_t offset, Callback callback) {
+  Enqueue([fd, data, size, offset, callback = std::move(callback)] { callback(ReadFully(fd, data, size, offset)); });
+}
+
+void ThreadPoolDiskIOEngine::SubmitWrite(int fd, const char *data, size_t size, off_t offset, Callback callback) {
+  Enqueue([fd, data, size, offset, callback = std::move(callback)] { callback(WriteFully(fd, data, size, offset)); });
+}
+
+void ThreadPoolDiskIOEngine::Enqueue(std::function<void()> request) {
+  {
+    std::scoped_lock latch(latch_);
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+}
+
+void ThreadPoolDiskIOEngine::Run() {
+  std::unique_lock latch(latch_);
+  while (true) {
+    cv_.wait(latch, [this] { return !running_ || !queue_.empty(); });
+    // Requests queued before shutdown are still served.
+    if (queue_.empty()) {
+      return;
+    }
+    std::function<void()> request = std::move(queue_.front());
+    queue_.pop_front();
+    latch.unlock();
+    request();
+    latch.lock();
+  }
+}
+
+/*****************************************************************************
+ * IO_URING
+ *****************************************************************************/
+
+struct IoUringDiskIOEngine::Request {
+  uint8_t opcode_;
+  int fd_;
+  /** Offset of the part still to transfer, which iov_ points to. */
+  off_t offset_;
+  struct iovec iov_;
+  /** Bytes transferred by earlier submissions of this request. */
+  size_t done_;
+  Callback callback_;
+};
+
+#ifdef __linux__
+
+namespace {
+
+auto IoUringSetup(unsigned entries, struct io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+IoUringDiskIOEngine::IoUringDiskIOEngine(unsigned queue_depth) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(queue_depth, &params);
+  if (ring_fd < 0) {
+    return;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                  IORING_OFF_SQ_RING);
+  cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                  IORING_OFF_CQ_RING);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    for (auto [ring, size] : {std::pair{sq_ring_, sq_ring_size_}, {cq_ring_, cq_ring_size_}, {sqes_, sqes_size_}}) {
+      if (ring != MAP_FAILED) {
+        munmap(ring, size);
+      }
+    }
+    close(ring_fd);
+    return;
+  }
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  queue_depth_ = params.sq_entries;
+  ring_fd_ = ring_fd;
+  completion_thread_ = std::thread(&IoUringDiskIOEngine::ReapCompletions, this);
+}
+
+IoUringDiskIOEngine::~IoUringDiskIOEngine() {
+  if (!IsReady()) {
+    return;
+  }
+  {
+    std::unique_lock latch(latch_);
+    cv_.wait(latch, [this] { return in_flight_ == 0; });
+  }
+  // A no-op without a request tells the completion thread to stop.
+  Submit(IORING_OP_NOP, -1, nullptr, 0, 0, nullptr);
+  completion_thread_.join();
+  munmap(sqes_, sqes_size_);
+  munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+void IoUringDiskIOEngine::SubmitRead(int fd, char *data, size_t size, off_t offset, Callback callback) {
+  Submit(IORING_OP_READV, fd, data, size, offset, std::move(callback));
+}
+
+void IoUringDiskIOEngine::SubmitWrite(int fd, const char *data, size_t size, off_t offset, Callback callback) {
+  Submit(IORING_OP_WRITEV, fd, const_cast<char *>(data), size, offset, std::move(callback));
+}
+
+void IoUringDiskIOEngine::Submit(uint8_t opcode, int fd, char *data, size_t size, off_t offset, Callback callback) {
+  Request *request = nullptr;
+  if (callback != nullptr) {
+    request = new Request{opcode, fd, offset, {data, size}, 0, std::move(callback)};
+  }
+  std::unique_lock latch(latch_);
+  // The completion queue is twice as deep as the submission queue, so bounding the requests in flight by the
+  // submission queue depth means completions can never overflow.
+  cv_.wait(latch, [this] { return in_flight_ < queue_depth_; });
+  in_flight_++;
+  Enqueue(opcode, fd, request);
+}
+
+void IoUringDiskIOEngine::Enqueue(uint8_t opcode, int fd, Request *request) {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & sq_mask_;
+  auto *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  if (request != nullptr) {
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+    sqe->len = 1;
+    sqe->off = request->offset_;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  while (IoUringEnter(ring_fd_, 1, 0, 0) < 0) {
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      // The entry stays in the submission queue and goes out with the next submission.
+      LOG_DEBUG("io_uring_enter failed: %s", strerror(errno));
+      break;
+    }
+  }
+}
+
+auto IoUringDiskIOEngine::NeedsResubmit(Request *request, int result) -> bool {
+  if (result == -EAGAIN || result == -EINTR) {
+    return true;
+  }
+  // A read of 0 bytes means that the file ends early.
+  if (result <= 0 || static_cast<size_t>(result) == request->iov_.iov_len) {
+    return false;
+  }
+  request->done_ += result;
+  request->offset_ += result;
+  request->iov_.iov_base = static_cast<char *>(request->iov_.iov_base) + result;
+  request->iov_.iov_len -= result;
+  return true;
+}
+
+void IoUringDiskIOEngine::ReapCompletions() {
+  bool stopping = false;
+  while (!stopping) {
+    if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+      LOG_DEBUG("io_uring_enter failed: %s", strerror(errno));
+    }
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      auto *cqe = static_cast<struct io_uring_cqe *>(cqes_) + (head & cq_mask_);
+      auto *request = reinterpret_cast<Request *>(cqe->user_data);
+      int result = cqe->res;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      if (request == nullptr) {
+        stopping = true;
+      } else if (NeedsResubmit(request, result)) {
+        // The rest of the request goes out again and stays in flight, like ReadFully and WriteFully loop.
+        std::scoped_lock latch(latch_);
+        Enqueue(request->opcode_, request->fd_, request);
+        continue;
+      } else {
+        request->callback_(result < 0 ? result : static_cast<ssize_t>(request->done_ + result));
+        delete request;
+      }
+      {
+        std::scoped_lock latch(latch_);
+        in_flight_--;
+      }
+      cv_.notify_all();
+    }
+  }
+}
+
+#else
+
+IoUringDiskIOEngine::IoUringDiskIOEngine(unsigned queue_depth) {}
+
+IoUringDiskIOEngine::~IoUringDiskIOEngine() = default;
+
+void IoUringDiskIOEngine::SubmitRead(int fd, char *data, size_t size, off_t offset, Callback callback) {}
+
+void IoUringDiskIOEngine::SubmitWrite(int fd, const char *data, size_t size, off_t offset, Callback callback) {}
+
+void IoUringDiskIOEngine::Submit(uint8_t opcode, int fd, char *data, size_t size, off_t offset, Callback callback) {}
+
+void IoUringDiskIOEngine::Enqueue(uint8_t opcode, int fd, Request *request) {}
+
+auto IoUringDiskIOEngine::NeedsResubmit(Request *request, int result) -> bool { return false; }
+
+void IoUringDiskIOEngine::ReapCompletions() {}
+
+#endif
+
+}  // namespace bustub
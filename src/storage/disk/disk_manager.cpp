@@ -10,16 +10,28 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <numeric>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/crc32c_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -30,42 +42,55 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool enable_checksums, DiskIOBackend io_backend, bool direct_io,
+                         int log_segment_size)
+    : file_name_(db_file),
+      enable_checksums_(enable_checksums),
+      num_flushes_(0),
+      num_writes_(0),
+      num_reads_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  checksum_name_ = file_name_.substr(0, n) + ".crc";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
+  log_segment_size_ = log_segment_size;
+  OpenLog();
+
+  // create the file if it does not exist; O_DIRECT is not supported by every file system, e.g. tmpfs
+  int flags = O_RDWR | O_CREAT;
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+  }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
   }
+  struct stat stat_buf;
+  db_file_size_ = fstat(db_fd_, &stat_buf) == 0 ? stat_buf.st_size : 0;
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  if (enable_checksums_) {
+    checksum_fd_ = open(checksum_name_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (checksum_fd_ < 0) {
+      throw Exception("can't open checksum file");
     }
+    // Keep all trailers in memory, so that verifying a read costs no extra I/O.
+    trailers_.resize(std::max<int64_t>(GetFileSize(checksum_name_), 0) / sizeof(PageTrailer));
+    ssize_t read_count = DiskIOEngine::ReadFully(checksum_fd_, reinterpret_cast<char *>(trailers_.data()),
+                                                 trailers_.size() * sizeof(PageTrailer), 0);
+    trailers_.resize(std::max<ssize_t>(read_count, 0) / sizeof(PageTrailer));
+  }
+
+  if (io_backend != DiskIOBackend::SYNC) {
+    io_engine_ = DiskIOEngine::Create(io_backend);
   }
   buffer_used = nullptr;
 }
@@ -74,66 +99,304 @@ DiskManager::DiskManager(const std::string &db_file)
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  // Destroying the engine waits for the requests in flight.
+  io_engine_.reset();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+  if (enable_checksums_) {
+    std::scoped_lock scoped_checksum_latch(checksum_latch_);
+    if (checksum_fd_ >= 0) {
+      close(checksum_fd_);
+      checksum_fd_ = -1;
+    }
+  }
+  std::scoped_lock scoped_log_latch(log_latch_);
+  for (auto &segment : log_segments_) {
+    close(segment.fd_);
+  }
+  log_segments_.clear();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
   }
-  log_io_.close();
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+auto DiskManager::WritePage(page_id_t page_id, const char *page_data) -> bool {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
+  uint32_t checksum = 0;
+  if (enable_checksums_) {
+    checksum = Crc32cUtil::Crc32c(page_data, PAGE_SIZE);
+    BeginPageWrite(page_id);
+  }
+  ssize_t written;
+  if (NeedsBounceBuffer(page_data)) {
+    char *bounce = AllocateBounceBuffer();
+    memcpy(bounce, page_data, PAGE_SIZE);
+    written = DiskIOEngine::WriteFully(db_fd_, bounce, PAGE_SIZE, offset);
+    free(bounce);
+  } else {
+    written = DiskIOEngine::WriteFully(db_fd_, page_data, PAGE_SIZE, offset);
+  }
   // check for I/O error
-  if (db_io_.bad()) {
+  if (written < PAGE_SIZE) {
     LOG_DEBUG("I/O error while writing");
-    return;
+  } else {
+    GrowFileSize(offset + PAGE_SIZE);
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  // the trailer goes out after the page, so a crash in between leaves a mismatch that is detected on read
+  if (enable_checksums_) {
+    FinishPageWrite(page_id, checksum, written == PAGE_SIZE);
+  }
+  return written == PAGE_SIZE;
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+auto DiskManager::ReadPage(page_id_t page_id, char *page_data) -> bool {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset >= db_file_size_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
+    // the page was never written, so it reads as zeroes like with the asynchronous backends
+    memset(page_data, 0, PAGE_SIZE);
+    return true;
+  }
+  num_reads_ += 1;
+  ssize_t read_count;
+  if (NeedsBounceBuffer(page_data)) {
+    char *bounce = AllocateBounceBuffer();
+    read_count = DiskIOEngine::ReadFully(db_fd_, bounce, PAGE_SIZE, offset);
+    memcpy(page_data, bounce, std::max<ssize_t>(read_count, 0));
+    free(bounce);
   } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+    read_count = DiskIOEngine::ReadFully(db_fd_, page_data, PAGE_SIZE, offset);
+  }
+  return FinishRead(page_id, page_data, read_count);
+}
+
+/**
+ * Read a batch of pages, with one preadv per run of adjacent pages or all at once with an asynchronous backend
+ */
+auto DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data)
+    -> std::vector<bool> {
+  assert(page_ids.size() == page_data.size());
+  std::vector<bool> verified(page_ids.size());
+  if (io_engine_ != nullptr) {
+    // Keep the whole batch in flight at once.
+    std::vector<std::future<bool>> reads;
+    reads.reserve(page_ids.size());
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      reads.push_back(ReadPageAsync(page_ids[i], page_data[i]));
+    }
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      verified[i] = reads[i].get();
+    }
+    return verified;
+  }
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&page_ids](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  size_t begin = 0;
+  while (begin < order.size()) {
+    // A page that needs a bounce buffer, or has no neighbour in the batch, is read on its own.
+    size_t end = begin + 1;
+    if (!NeedsBounceBuffer(page_data[order[begin]])) {
+      while (end < order.size() && end - begin < static_cast<size_t>(IOV_MAX) &&
+             page_ids[order[end]] == page_ids[order[end - 1]] + 1 && !NeedsBounceBuffer(page_data[order[end]])) {
+        end++;
+      }
+    }
+    if (end - begin == 1) {
+      verified[order[begin]] = ReadPage(page_ids[order[begin]], page_data[order[begin]]);
+      begin = end;
+      continue;
+    }
+    std::vector<iovec> iov;
+    iov.reserve(end - begin);
+    for (size_t k = begin; k < end; ++k) {
+      iov.push_back(iovec{page_data[order[k]], PAGE_SIZE});
+    }
+    ssize_t read_count =
+        DiskIOEngine::ReadvFully(db_fd_, std::move(iov), static_cast<off_t>(page_ids[order[begin]]) * PAGE_SIZE);
+    num_reads_ += static_cast<int>(end - begin);
+    // Each page gets its share of the run, which is short for the pages at the end of the file, and its own checksum.
+    for (size_t k = begin; k < end; ++k) {
+      ssize_t page_read_count = read_count;
+      if (read_count >= 0) {
+        page_read_count = std::clamp<ssize_t>(read_count - static_cast<ssize_t>(k - begin) * PAGE_SIZE, 0, PAGE_SIZE);
+      }
+      verified[order[k]] = FinishRead(page_ids[order[k]], page_data[order[k]], page_read_count);
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    begin = end;
+  }
+  return verified;
+}
+
+/**
+ * Queue a write of the specified page to the I/O engine
+ */
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  if (io_engine_ == nullptr) {
+    WritePage(page_id, page_data);
+    std::promise<void> done;
+    done.set_value();
+    return done.get_future();
+  }
+  auto done = std::make_shared<std::promise<void>>();
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  uint32_t checksum = 0;
+  if (enable_checksums_) {
+    checksum = Crc32cUtil::Crc32c(page_data, PAGE_SIZE);
+    BeginPageWrite(page_id);
+  }
+  char *bounce = nullptr;
+  if (NeedsBounceBuffer(page_data)) {
+    bounce = AllocateBounceBuffer();
+    memcpy(bounce, page_data, PAGE_SIZE);
+  }
+  num_writes_ += 1;
+  io_engine_->SubmitWrite(db_fd_, bounce != nullptr ? bounce : page_data, PAGE_SIZE, offset,
+                          [this, page_id, checksum, offset, bounce, done](ssize_t result) {
+                            free(bounce);
+                            if (result < PAGE_SIZE) {
+                              LOG_DEBUG("I/O error while writing");
+                            } else {
+                              GrowFileSize(offset + PAGE_SIZE);
+                            }
+                            if (enable_checksums_) {
+                              FinishPageWrite(page_id, checksum, result == PAGE_SIZE);
+                            }
+                            done->set_value();
+                          });
+  return done->get_future();
+}
+
+/**
+ * Queue a read of the specified page to the I/O engine
+ */
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  if (io_engine_ == nullptr) {
+    std::promise<bool> done;
+    done.set_value(ReadPage(page_id, page_data));
+    return done.get_future();
+  }
+  auto done = std::make_shared<std::promise<bool>>();
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  if (offset >= db_file_size_) {
+    memset(page_data, 0, PAGE_SIZE);
+    done->set_value(true);
+    return done->get_future();
+  }
+  num_reads_ += 1;
+  char *bounce = NeedsBounceBuffer(page_data) ? AllocateBounceBuffer() : nullptr;
+  io_engine_->SubmitRead(db_fd_, bounce != nullptr ? bounce : page_data, PAGE_SIZE, offset,
+                         [this, page_id, page_data, bounce, done](ssize_t result) {
+                           if (bounce != nullptr) {
+                             memcpy(page_data, bounce, std::max<ssize_t>(result, 0));
+                             free(bounce);
+                           }
+                           done->set_value(FinishRead(page_id, page_data, result));
+                         });
+  return done->get_future();
+}
+
+auto DiskManager::FinishRead(page_id_t page_id, char *page_data, ssize_t read_count) -> bool {
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  return !enable_checksums_ || VerifyTrailer(page_id, page_data);
+}
+
+auto DiskManager::NeedsBounceBuffer(const char *page_data) const -> bool {
+  return direct_io_ && reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0;
+}
+
+auto DiskManager::AllocateBounceBuffer() -> char * {
+  return static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE));
+}
+
+void DiskManager::GrowFileSize(off_t size) {
+  off_t file_size = db_file_size_;
+  while (file_size < size && !db_file_size_.compare_exchange_weak(file_size, size)) {
+  }
+}
+
+void DiskManager::SyncPages() {
+  fdatasync(db_fd_);
+  if (enable_checksums_) {
+    std::scoped_lock scoped_checksum_latch(checksum_latch_);
+    fdatasync(checksum_fd_);
+  }
+}
+
+void DiskManager::BeginPageWrite(page_id_t page_id) {
+  std::unique_lock checksum_latch(checksum_latch_);
+  page_written_cv_.wait(checksum_latch, [this, page_id] { return writing_pages_.count(page_id) == 0; });
+  writing_pages_.insert(page_id);
+}
+
+void DiskManager::FinishPageWrite(page_id_t page_id, uint32_t checksum, bool written) {
+  {
+    std::scoped_lock scoped_checksum_latch(checksum_latch_);
+    if (written) {
+      WriteTrailer(page_id, checksum);
     }
+    writing_pages_.erase(page_id);
   }
+  page_written_cv_.notify_all();
+}
+
+void DiskManager::WriteTrailer(page_id_t page_id, uint32_t checksum) {
+  PageTrailer trailer{PAGE_TRAILER_MAGIC, checksum};
+  if (static_cast<size_t>(page_id) >= trailers_.size()) {
+    trailers_.resize(page_id + 1, PageTrailer{0, 0});
+  }
+  trailers_[page_id] = trailer;
+  if (DiskIOEngine::WriteFully(checksum_fd_, reinterpret_cast<const char *>(&trailer), sizeof(PageTrailer),
+                               static_cast<off_t>(page_id) * sizeof(PageTrailer)) <
+      static_cast<ssize_t>(sizeof(PageTrailer))) {
+    LOG_DEBUG("I/O error while writing checksum");
+  }
+}
+
+auto DiskManager::VerifyTrailer(page_id_t page_id, const char *page_data) -> bool {
+  uint32_t checksum = Crc32cUtil::Crc32c(page_data, PAGE_SIZE);
+  std::scoped_lock scoped_checksum_latch(checksum_latch_);
+  // A page without a trailer has never been written with checksums enabled.
+  if (static_cast<size_t>(page_id) >= trailers_.size()) {
+    return true;
+  }
+  const PageTrailer &trailer = trailers_[page_id];
+  if (trailer.magic_ != PAGE_TRAILER_MAGIC || trailer.checksum_ == checksum) {
+    return true;
+  }
+  LOG_DEBUG("checksum mismatch on page %d", page_id);
+  num_checksum_failures_ += 1;
+  if (repair_checksums_) {
+    WriteTrailer(page_id, checksum);
+    return true;
+  }
+  return false;
 }
 
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
  */
-void DiskManager::WriteLog(char *log_data, int size) {
+void DiskManager::WriteLog(char *log_data, int size, lsn_t first_lsn) {
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
@@ -150,45 +413,217 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
+  std::scoped_lock scoped_log_latch(log_latch_);
+  off_t capacity = log_segment_size_ - static_cast<off_t>(sizeof(LogSegmentHeader));
+  if (log_segments_.empty() || (log_segments_.back().size_ > 0 && log_segments_.back().size_ + size > capacity)) {
+    CreateLogSegment(first_lsn);
+  }
+  LogSegment &segment = log_segments_.back();
+  // sequence write; a buffer never spans two segments, so every segment starts with a whole record
+  ssize_t written =
+      DiskIOEngine::WriteFully(segment.fd_, log_data, size, sizeof(LogSegmentHeader) + segment.size_);
 
   // check for I/O error
-  if (log_io_.bad()) {
+  if (written < size) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  // the records only count as persistent once they are on stable storage
+  fdatasync(segment.fd_);
+  segment.size_ += size;
   flush_log_ = false;
 }
 
 /**
- * Read the contents of the log into the given memory area
- * Always read from the beginning and perform sequence read
- * @return: false means already reach the end
+ * Read the contents of the log into the given memory area, going on into the next segments as needed
+ * @return: false means already reach the end, or the offset lies in a deleted segment
  */
-auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
-  if (offset >= GetFileSize(log_name_)) {
-    // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+auto DiskManager::ReadLog(char *log_data, int size, int64_t offset) -> bool {
+  std::scoped_lock scoped_log_latch(log_latch_);
+  // the segment holding offset is the last one starting at or before it
+  auto it = std::upper_bound(log_segments_.begin(), log_segments_.end(), static_cast<off_t>(offset),
+                             [](off_t offset, const LogSegment &segment) { return offset < segment.start_offset_; });
+  if (it == log_segments_.begin() || offset >= (it - 1)->start_offset_ + (it - 1)->size_) {
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
+  --it;
+  int read_total = 0;
+  for (; it != log_segments_.end() && read_total < size; ++it) {
+    off_t segment_offset = offset + read_total - it->start_offset_;
+    int count = static_cast<int>(std::min<off_t>(size - read_total, it->size_ - segment_offset));
+    ssize_t read_count = DiskIOEngine::ReadFully(it->fd_, log_data + read_total, count,
+                                                 sizeof(LogSegmentHeader) + segment_offset);
+    if (read_count < 0) {
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    read_total += read_count;
+    if (read_count < count) {
+      break;
+    }
+  }
+  // if log ends before reading "size"
+  if (read_total < size) {
+    memset(log_data + read_total, 0, size - read_total);
+  }
+  return true;
+}
 
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+auto DiskManager::GetLogSegmentOffset(lsn_t lsn) -> int64_t {
+  std::scoped_lock scoped_log_latch(log_latch_);
+  if (log_segments_.empty()) {
+    return 0;
   }
-  // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
-    memset(log_data + read_count, 0, size - read_count);
+  off_t offset = log_segments_.front().start_offset_;
+  if (lsn == INVALID_LSN) {
+    return offset;
   }
+  for (const auto &segment : log_segments_) {
+    if (segment.start_lsn_ == INVALID_LSN || segment.start_lsn_ > lsn) {
+      break;
+    }
+    offset = segment.start_offset_;
+  }
+  return offset;
+}
 
-  return true;
+void DiskManager::TruncateLog(lsn_t restart_lsn) {
+  // the log before the restart LSN is all that redoes the pages written so far, so they reach the disk first
+  SyncPages();
+  std::scoped_lock scoped_log_latch(log_latch_);
+  log_restart_lsn_ = restart_lsn;
+  // a segment lies wholly before the restart LSN if the one after it starts no later than that
+  size_t num_deleted = 0;
+  while (restart_lsn != INVALID_LSN && num_deleted + 1 < log_segments_.size()) {
+    lsn_t next_start_lsn = log_segments_[num_deleted + 1].start_lsn_;
+    if (next_start_lsn == INVALID_LSN || next_start_lsn > restart_lsn) {
+      break;
+    }
+    num_deleted++;
+  }
+  if (!log_segments_.empty()) {
+    log_first_seq_ = log_segments_[num_deleted].seq_;
+  }
+  // the master record moves past the segments before they are deleted, so it never names a missing one
+  WriteLogMasterRecord();
+  for (size_t i = 0; i < num_deleted; ++i) {
+    close(log_segments_.front().fd_);
+    unlink(GetLogSegmentName(log_segments_.front().seq_).c_str());
+    log_segments_.pop_front();
+  }
+  if (num_deleted > 0) {
+    SyncLogDirectory();
+  }
+}
+
+auto DiskManager::GetLogRestartLSN() -> lsn_t {
+  std::scoped_lock scoped_log_latch(log_latch_);
+  return log_restart_lsn_;
+}
+
+auto DiskManager::GetNumLogSegments() -> size_t {
+  std::scoped_lock scoped_log_latch(log_latch_);
+  return log_segments_.size();
+}
+
+void DiskManager::OpenLog() {
+  log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
+  }
+  LogMasterRecord master;
+  if (pread(log_fd_, &master, sizeof(master), 0) == sizeof(master) && master.magic_ == LOG_MASTER_MAGIC) {
+    log_first_seq_ = master.first_seq_;
+    log_restart_lsn_ = master.restart_lsn_;
+    // the log goes on for as long as the segments follow each other
+    for (uint32_t seq = log_first_seq_;; ++seq) {
+      int fd = open(GetLogSegmentName(seq).c_str(), O_RDWR);
+      if (fd < 0) {
+        break;
+      }
+      LogSegmentHeader header;
+      struct stat stat_buf;
+      bool valid = pread(fd, &header, sizeof(header), 0) == sizeof(header) && header.magic_ == LOG_SEGMENT_MAGIC &&
+                   header.seq_ == seq && fstat(fd, &stat_buf) == 0 &&
+                   (log_segments_.empty() ||
+                    header.start_offset_ == log_segments_.back().start_offset_ + log_segments_.back().size_);
+      if (!valid) {
+        close(fd);
+        break;
+      }
+      log_segments_.push_back(LogSegment{seq, fd, static_cast<off_t>(header.start_offset_), header.start_lsn_,
+                                         stat_buf.st_size - static_cast<off_t>(sizeof(LogSegmentHeader))});
+    }
+    return;
+  }
+
+  // A new log. Segments left behind by an earlier log of the same name are not part of it.
+  std::string::size_type slash = log_name_.rfind('/');
+  std::string dir_name = slash == std::string::npos ? "." : log_name_.substr(0, slash + 1);
+  std::string prefix = log_name_.substr(slash == std::string::npos ? 0 : slash + 1) + ".";
+  DIR *dir = opendir(dir_name.c_str());
+  if (dir != nullptr) {
+    for (struct dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+          std::all_of(name.begin() + prefix.size(), name.end(), [](char c) { return isdigit(c) != 0; })) {
+        unlink((dir_name + "/" + name).c_str());
+      }
+    }
+    closedir(dir);
+  }
+  WriteLogMasterRecord();
+}
+
+auto DiskManager::GetLogSegmentName(uint32_t seq) const -> std::string {
+  char suffix[16];
+  snprintf(suffix, sizeof(suffix), ".%08u", seq);
+  return log_name_ + suffix;
+}
+
+void DiskManager::CreateLogSegment(lsn_t start_lsn) {
+  LogSegmentHeader header{};
+  header.magic_ = LOG_SEGMENT_MAGIC;
+  header.seq_ = log_segments_.empty() ? log_first_seq_ : log_segments_.back().seq_ + 1;
+  header.start_offset_ =
+      log_segments_.empty() ? 0 : log_segments_.back().start_offset_ + log_segments_.back().size_;
+  header.start_lsn_ = start_lsn;
+  int fd = open(GetLogSegmentName(header.seq_).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw Exception("can't create log segment file");
+  }
+  if (DiskIOEngine::WriteFully(fd, reinterpret_cast<const char *>(&header), sizeof(header), 0) <
+      static_cast<ssize_t>(sizeof(header))) {
+    LOG_DEBUG("I/O error while writing log segment header");
+  }
+  fdatasync(fd);
+  SyncLogDirectory();
+  log_segments_.push_back(
+      LogSegment{header.seq_, fd, static_cast<off_t>(header.start_offset_), header.start_lsn_, 0});
+}
+
+void DiskManager::WriteLogMasterRecord() {
+  LogMasterRecord master{};
+  master.magic_ = LOG_MASTER_MAGIC;
+  master.first_seq_ = log_first_seq_;
+  master.restart_lsn_ = log_restart_lsn_;
+  // the record is far smaller than a sector, so it is written atomically
+  if (DiskIOEngine::WriteFully(log_fd_, reinterpret_cast<const char *>(&master), sizeof(master), 0) <
+      static_cast<ssize_t>(sizeof(master))) {
+    LOG_DEBUG("I/O error while writing log master record");
+    return;
+  }
+  fdatasync(log_fd_);
+}
+
+void DiskManager::SyncLogDirectory() {
+  std::string::size_type slash = log_name_.rfind('/');
+  std::string dir_name = slash == std::string::npos ? "." : log_name_.substr(0, slash + 1);
+  int dir_fd = open(dir_name.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    close(dir_fd);
+  }
 }
 
 /**
@@ -201,6 +636,11 @@ auto DiskManager::GetNumFlushes() const -> int { return num_flushes_; }
  */
 auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
 
+/**
+ * Returns number of Reads made so far
+ */
+auto DiskManager::GetNumReads() const -> int { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -209,10 +649,10 @@ auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-auto DiskManager::GetFileSize(const std::string &file_name) -> int {
+auto DiskManager::GetFileSize(const std::string &file_name) -> int64_t {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
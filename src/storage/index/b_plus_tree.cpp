@@ -9,7 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -20,30 +26,80 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, LogManager *log_manager, bool unique_keys)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      log_manager_(log_manager),
+      unique_keys_(unique_keys) {
+  if (!unique_keys && !LayoutTraits::POSTING_LISTS) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "only b+ trees of key and value pairs support duplicate keys");
+  }
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values that associated with input key
  * This method is used for point query
  * @return : true means key exists
+ * Overflow pages are only read under the latch of their leaf, so an optimistic reader that finds a key with overflow
+ * pages latches the leaf and checks that it is still as it was read.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  return false;
+  LoadRootPageId();
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_READS; ++attempt) {
+    Page *page;
+    uint64_t version;
+    if (!FindLeafOptimistic(key, false, false, &page, &version)) {
+      continue;
+    }
+    if (page == nullptr) {
+      return false;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    std::vector<ValueType> values;
+    page_id_t overflow_page_id = INVALID_PAGE_ID;
+    bool found = LookupValues(leaf, key, &values, &overflow_page_id);
+    bool valid = page->ValidateVersion(version);
+    if (valid && overflow_page_id != INVALID_PAGE_ID) {
+      page->RLatch();
+      valid = page->ValidateVersion(version);
+      if (valid) {
+        OverflowPage::ReadList(buffer_pool_manager_, overflow_page_id, &values);
+      }
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (valid) {
+      result->insert(result->end(), values.begin(), values.end());
+      return found;
+    }
+  }
+
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return false;
+  }
+  Page *page = FindLeaf(key, Operation::FIND, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_t overflow_page_id = INVALID_PAGE_ID;
+  bool found = LookupValues(leaf, key, result, &overflow_page_id);
+  OverflowPage::ReadList(buffer_pool_manager_, overflow_page_id, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
 }
 
 /*****************************************************************************
@@ -53,12 +109,34 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: with unique keys, if user try to insert duplicate keys return false;
+ * otherwise false only if the key has the value already.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+  LoadRootPageId();
+  Transaction local_transaction(INVALID_TXN_ID);
+  std::vector<IndexLogOp> ops;
+  WriteContext context{transaction == nullptr ? &local_transaction : transaction,
+                       enable_logging && log_manager_ != nullptr ? &ops : nullptr, LogRecordType::INDEX_INSERT};
+  while (true) {
+    root_latch_.WLock();
+    context.transaction_->AddIntoPageSet(nullptr);
+    std::optional<bool> inserted = true;
+    if (IsEmpty()) {
+      StartNewTree(key, value, &context);
+    } else {
+      inserted = InsertIntoLeaf(key, value, &context);
+    }
+    if (inserted.has_value()) {
+      FinishWrite(&context);
+      ReleasePageSet(context.transaction_, *inserted);
+      return *inserted;
+    }
+    // Nothing has changed yet, so the insert starts over and gives the writer in its way a chance to finish.
+    ReleasePageSet(context.transaction_, false);
+    std::this_thread::yield();
+  }
 }
 /*
  * Insert constant key & value pair into an empty tree
@@ -67,19 +145,70 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value, WriteContext *context) {
+  page_id_t root_page_id;
+  Page *page = NewNodePage(&root_page_id, context->transaction_);
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(root_page_id, INVALID_PAGE_ID, leaf_max_size_);
+  LogFormat(root, context);
+  root->Insert(key, value, comparator_);
+  LogInsertEntries(root, 0, 1, context);
+  root_page_id_ = root_page_id;
+  LogSetRoot(context);
+}
 
 /*
  * Insert constant key & value pair into leaf page
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: with unique keys, if user try to insert duplicate keys return false,
+ * otherwise return true. Without them, the value joins those of the key.
+ * A leaf that may split needs the leaf after it too; if another writer holds that one, nothing is changed and
+ * nullopt returned, for the caller to start over.
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, WriteContext *context)
+    -> std::optional<bool> {
+  Page *page = FindLeaf(key, Operation::INSERT, context->transaction_);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    return unique_keys_ ? std::optional<bool>(false) : InsertIntoPostingList(leaf, key, value, context);
+  }
+  if (!IsSafe(leaf, Operation::INSERT, false) && !TryLatchNextLeaf(leaf, context->transaction_)) {
+    return std::nullopt;
+  }
+  if constexpr (KeyTraits::IS_VARIABLE) {
+    if (leaf->GetSize() >= leaf->GetMaxSize()) {
+      // A redistribution that shortened the prefix can leave a leaf without room for the longest key.
+      LeafPage *new_leaf = Split(leaf, context);
+      InsertIntoParent(leaf, new_leaf->GetLowKey(), new_leaf, context);
+      leaf = comparator_(key, new_leaf->GetLowKey()) < 0 ? leaf : new_leaf;
+    }
+  }
+  if constexpr (LayoutTraits::POSTING_LISTS) {
+    if (leaf->GetFreeBytes() < static_cast<int>(sizeof(MappingType))) {
+      // Posting lists can fill a leaf by bytes before it fills up by count.
+      leaf = SplitForRoom(leaf, key, context);
+    }
+  }
+  int slot = leaf->KeyIndex(key, comparator_);
+  if (leaf->Insert(key, value, comparator_) < leaf->GetMaxSize()) {
+    LogInsertEntries(leaf, slot, 1, context);
+    return true;
+  }
+  LogInsertEntries(leaf, slot, 1, context);
+  int size = leaf->GetSize();
+  LeafPage *new_leaf = Split(leaf, context);
+  LogRemoveEntries(leaf, leaf->GetSize(), size - leaf->GetSize(), context);
+  if constexpr (KeyTraits::IS_VARIABLE) {
+    // The parent gets the fence that the split chose, which may be shorter than the first key.
+    InsertIntoParent(leaf, new_leaf->GetLowKey(), new_leaf, context);
+  } else {
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, context);
+  }
+  return true;
 }
 
 /*
@@ -88,11 +217,38 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The caller logs what left the input page, since it may be a scratch copy of an overflowing internal page.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-auto BPLUSTREE_TYPE::Split(N *node) -> N * {
-  return nullptr;
+auto BPLUSTREE_TYPE::Split(N *node, WriteContext *context) -> N * {
+  page_id_t page_id;
+  Page *page = NewNodePage(&page_id, context->transaction_);
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  new_node->Init(page_id, node->GetParentPageId(), node->IsLeafPage() ? leaf_max_size_ : internal_max_size_);
+  LogFormat(new_node, context);
+  node->MoveHalfTo(new_node);
+  LogInsertEntries(new_node, 0, new_node->GetSize(), context);
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->SetNextPageId(node->GetNextPageId());
+    new_node->SetPrevPageId(node->GetPageId());
+    node->SetNextPageId(page_id);
+    LogSetPage(IndexLogOpType::SET_NEXT_PAGE, page_id, new_node->GetNextPageId(), context);
+    LogSetPage(IndexLogOpType::SET_PREV_PAGE, page_id, node->GetPageId(), context);
+    LogSetPage(IndexLogOpType::SET_NEXT_PAGE, node->GetPageId(), page_id, context);
+    SetPrevOfNextLeaf(new_node, context);
+  }
+  context->log_record_type_ = LogRecordType::INDEX_SPLIT;
+  return new_node;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SplitForRoom(LeafPage *leaf, const KeyType &key, WriteContext *context) -> LeafPage * {
+  int size = leaf->GetSize();
+  LeafPage *new_leaf = Split(leaf, context);
+  LogRemoveEntries(leaf, leaf->GetSize(), size - leaf->GetSize(), context);
+  InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, context);
+  return comparator_(key, new_leaf->KeyAt(0)) < 0 ? leaf : new_leaf;
 }
 
 /*
@@ -106,7 +262,55 @@ auto BPLUSTREE_TYPE::Split(N *node) -> N * {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      WriteContext *context) {
+  if (old_node->GetPageId() == root_page_id_) {
+    page_id_t root_page_id;
+    Page *page = NewNodePage(&root_page_id, context->transaction_);
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    LogFormat(root, context);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    LogInsertEntries(root, 0, 2, context);
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    LogSetPage(IndexLogOpType::SET_PARENT_PAGE, old_node->GetPageId(), root_page_id, context);
+    LogSetPage(IndexLogOpType::SET_PARENT_PAGE, new_node->GetPageId(), root_page_id, context);
+    root_page_id_ = root_page_id;
+    LogSetRoot(context);
+    return;
+  }
+
+  InternalPage *parent = GetParentPage(old_node, context->transaction_);
+  int slot = parent->ValueIndex(old_node->GetPageId()) + 1;
+  if (parent->GetSize() < parent->GetMaxSize()) {
+    parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    LogInsertEntries(parent, slot, 1, context);
+    return;
+  }
+
+  if constexpr (LOG_PAGE_IMAGES) {
+    // A full page may have no room for one more key, and an overflow copy would not keep entries at page offsets.
+    InternalPage *new_parent = Split(parent, context);
+    InternalPage *target = comparator_(key, new_parent->KeyAt(0)) < 0 ? parent : new_parent;
+    target->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    LogInsertEntries(target, 0, 1, context);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, context);
+    return;
+  }
+
+  // A full parent may have no room for one more entry in the page, so it overflows into a scratch copy.
+  int size = parent->GetSize();
+  std::vector<char> buffer(PAGE_SIZE + sizeof(std::pair<KeyType, page_id_t>));
+  memcpy(buffer.data(), reinterpret_cast<char *>(parent), PAGE_SIZE);
+  auto *overflow = reinterpret_cast<InternalPage *>(buffer.data());
+  overflow->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  InternalPage *new_parent = Split(overflow, context);
+  memcpy(reinterpret_cast<char *>(parent), buffer.data(),
+         INTERNAL_PAGE_HEADER_SIZE + overflow->GetSize() * sizeof(std::pair<KeyType, page_id_t>));
+  LogRemoveEntries(parent, 0, size, context);
+  LogInsertEntries(parent, 0, parent->GetSize(), context);
+  InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, context);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -119,7 +323,58 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) { RemoveEntry(key, nullptr, transaction); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  RemoveEntry(key, &value, transaction);
+}
+
+/*
+ * Removing one value of a posting list leaves the entry, and so the shape of the tree, as it is.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction) {
+  LoadRootPageId();
+  Transaction local_transaction(INVALID_TXN_ID);
+  std::vector<IndexLogOp> ops;
+  WriteContext context{transaction == nullptr ? &local_transaction : transaction,
+                       enable_logging && log_manager_ != nullptr ? &ops : nullptr, LogRecordType::INDEX_DELETE};
+  root_latch_.WLock();
+  context.transaction_->AddIntoPageSet(nullptr);
+  if (IsEmpty()) {
+    ReleasePageSet(context.transaction_, false);
+    return;
+  }
+  Page *page = FindLeaf(key, Operation::REMOVE, context.transaction_);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int slot = leaf->KeyIndex(key, comparator_);
+  ValueType existing;
+  bool found = leaf->Lookup(key, &existing, comparator_);
+  if constexpr (LayoutTraits::POSTING_LISTS) {
+    if (found && leaf->HasPostingList(slot)) {
+      if (value != nullptr) {
+        bool removed = RemoveFromPostingList(leaf, slot, *value, &context);
+        if (removed) {
+          FinishWrite(&context);
+        }
+        ReleasePageSet(context.transaction_, removed);
+        return;
+      }
+      std::vector<ValueType> values;
+      DeleteOverflowList(leaf->GetValues(slot, &values), context.transaction_);
+    }
+  }
+  if (!found || (value != nullptr && !(existing == *value))) {
+    ReleasePageSet(context.transaction_, false);
+    return;
+  }
+  leaf->RemoveAndDeleteRecord(key, comparator_);
+  LogRemoveEntries(leaf, slot, 1, &context);
+  CoalesceOrRedistribute(leaf, &context);
+  FinishWrite(&context);
+  ReleasePageSet(context.transaction_, true);
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -127,13 +382,69 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
  * Using template N to represent either internal page or leaf page.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
+ * Pages are not deleted here but collected in the transaction's deleted page set, to be deleted once unlatched.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) -> bool {
+auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, WriteContext *context) -> bool {
+  if (node->GetPageId() == root_page_id_) {
+    return AdjustRoot(node, context);
+  }
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+  InternalPage *parent = GetParentPage(node, context->transaction_);
+  int index = parent->ValueIndex(node->GetPageId());
+  Page *page = FetchNodePage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  page->WLatch();
+  context->transaction_->AddIntoPageSet(page);
+  auto *neighbor_node = reinterpret_cast<N *>(page->GetData());
+
+  KeyType middle_key = parent->KeyAt(index == 0 ? 1 : index);
+  if (index == 0 ? CanCoalesce(node, neighbor_node, middle_key) : CanCoalesce(neighbor_node, node, middle_key)) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      // A writer holding the leaf after the two may be waiting for a page held here, so rather than wait for it,
+      // the leaf stays underfull.
+      if (!TryLatchNextLeaf(index == 0 ? neighbor_node : node, context->transaction_)) {
+        return false;
+      }
+    }
+    return Coalesce(&neighbor_node, &node, &parent, index, context);
+  }
+  if constexpr (KeyTraits::IS_VARIABLE) {
+    // The key the parent gets may be longer than the one it replaces; without room, the page stays underfull.
+    KeyType new_key = neighbor_node->KeyAt(index == 0 ? 1 : neighbor_node->GetSize() - 1);
+    if (!parent->CanSetKeyAt(index == 0 ? 1 : index, new_key)) {
+      return false;
+    }
+  }
+  if constexpr (std::is_same_v<N, LeafPage> && LayoutTraits::POSTING_LISTS) {
+    // The entry that moves takes its posting list along; without room for it, the page stays underfull.
+    if (node->GetFreeBytes() < neighbor_node->EntrySizeAt(index == 0 ? 0 : neighbor_node->GetSize() - 1)) {
+      return false;
+    }
+  }
+  Redistribute(neighbor_node, node, index, parent, context);
   return false;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::CanCoalesce(N *left, N *right, const KeyType &middle_key) const -> bool {
+  if constexpr (KeyTraits::IS_VARIABLE) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      return left->CanMergeFrom(right);
+    } else {
+      return left->CanMergeFrom(right, middle_key);
+    }
+  }
+  if constexpr (std::is_same_v<N, LeafPage> && LayoutTraits::POSTING_LISTS) {
+    return left->CanMergeFrom(right);
+  }
+  int size = left->GetSize() + right->GetSize();
+  return left->IsLeafPage() ? size < left->GetMaxSize() : size <= left->GetMaxSize();
+}
+
 /*
  * Move all the key & value pairs from one page to its sibling page, and notify
  * buffer pool manager to delete this page. Parent page must be adjusted to
@@ -145,13 +456,33 @@ auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) -
  * @param   parent             parent page of input "node"
  * @return  true means parent node should be deleted, false means no deletion
  * happend
+ * The right page of the two always moves into the left one, so on return *neighbor_node is the page that remains.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 auto BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction) -> bool {
-  return false;
+                              WriteContext *context) -> bool {
+  if (index == 0) {
+    std::swap(*neighbor_node, *node);
+    index = 1;
+  }
+  N *recipient = *neighbor_node;
+  int size = recipient->GetSize();
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    (*node)->MoveAllTo(recipient);
+    LogSetPage(IndexLogOpType::SET_NEXT_PAGE, recipient->GetPageId(), recipient->GetNextPageId(), context);
+    SetPrevOfNextLeaf(recipient, context);
+  } else {
+    (*node)->MoveAllTo(recipient, (*parent)->KeyAt(index));
+  }
+  LogInsertEntries(recipient, size, recipient->GetSize() - size, context);
+  context->transaction_->AddIntoDeletedPageSet((*node)->GetPageId());
+  context->log_record_type_ = LogRecordType::INDEX_MERGE;
+
+  (*parent)->Remove(index);
+  LogRemoveEntries(*parent, index, 1, context);
+  return CoalesceOrRedistribute(*parent, context);
 }
 
 /*
@@ -165,7 +496,36 @@ auto BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index, InternalPage *parent, WriteContext *context) {
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveFirstToEndOf(node);
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1));
+    }
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    LogRemoveEntries(neighbor_node, 0, 1, context);
+    LogInsertEntries(node, node->GetSize() - 1, 1, context);
+    LogSetEntry(parent, 1, context);
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveLastToFrontOf(node);
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index));
+    }
+    parent->SetKeyAt(index, node->KeyAt(0));
+    LogRemoveEntries(neighbor_node, neighbor_node->GetSize(), 1, context);
+    LogInsertEntries(node, 0, 1, context);
+    if constexpr (!std::is_same_v<N, LeafPage>) {
+      // The old first child of an internal page now carries the separator key.
+      LogSetEntry(node, 1, context);
+    }
+    LogSetEntry(parent, index, context);
+  }
+  if (context->log_record_type_ == LogRecordType::INDEX_DELETE) {
+    context->log_record_type_ = LogRecordType::INDEX_REDISTRIBUTE;
+  }
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -177,7 +537,613 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return false; }
+auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node, WriteContext *context) -> bool {
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    root_page_id_ = INVALID_PAGE_ID;
+  } else {
+    if (old_root_node->GetSize() > 1) {
+      return false;
+    }
+    root_page_id_ = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+    // The only child is latched already, as one of the pages that merged into it.
+    Page *page = FetchNodePage(root_page_id_);
+    reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    LogSetPage(IndexLogOpType::SET_PARENT_PAGE, root_page_id_, INVALID_PAGE_ID, context);
+  }
+  context->transaction_->AddIntoDeletedPageSet(old_root_node->GetPageId());
+  LogSetRoot(context);
+  return true;
+}
+
+/*****************************************************************************
+ * POSTING LISTS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LookupValues(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *values,
+                                  page_id_t *overflow_page_id) const -> bool {
+  if constexpr (LayoutTraits::POSTING_LISTS) {
+    if (!unique_keys_) {
+      int index = leaf->KeyIndex(key, comparator_);
+      if (index >= leaf->GetSize() || comparator_(leaf->KeyAt(index), key) != 0) {
+        return false;
+      }
+      *overflow_page_id = leaf->GetValues(index, values);
+      return true;
+    }
+  }
+  ValueType value;
+  if (!leaf->Lookup(key, &value, comparator_)) {
+    return false;
+  }
+  values->push_back(value);
+  return true;
+}
+
+/*
+ * The leaf is safe for an insert only with room for the largest change a value makes to it, so a list that outgrows
+ * the leaf has its parent latched to split under.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertIntoPostingList(LeafPage *leaf, const KeyType &key, const ValueType &value,
+                                           WriteContext *context) -> std::optional<bool> {
+  if constexpr (LayoutTraits::POSTING_LISTS) {
+    int index = leaf->KeyIndex(key, comparator_);
+    std::vector<ValueType> values;
+    page_id_t overflow_page_id = leaf->GetValues(index, &values);
+    if (overflow_page_id != INVALID_PAGE_ID) {
+      return InsertIntoOverflowList(overflow_page_id, value, context);
+    }
+    auto it = std::lower_bound(values.begin(), values.end(), value, OverflowPage::ValueLess);
+    if (it != values.end() && *it == value) {
+      return false;
+    }
+    values.insert(it, value);
+    if (values.size() > static_cast<size_t>(LeafPage::MAX_POSTINGS)) {
+      leaf->SetOverflowPageId(index, CreateOverflowList(values, context));
+      LogPageImage(leaf, context);
+      return true;
+    }
+    if (!leaf->CanSetValues(index, values.size())) {
+      if (!TryLatchNextLeaf(leaf, context->transaction_)) {
+        return std::nullopt;
+      }
+      leaf = SplitForRoom(leaf, key, context);
+      index = leaf->KeyIndex(key, comparator_);
+      BUSTUB_ASSERT(leaf->CanSetValues(index, values.size()), "a split leaves room for a posting list to grow");
+    }
+    leaf->SetValues(index, values);
+    LogPageImage(leaf, context);
+    return true;
+  }
+  return false;
+}
+
+/*
+ * A list in overflow pages moves back into the leaf once it is down to half of what a leaf list holds, if it fits.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveFromPostingList(LeafPage *leaf, int index, const ValueType &value, WriteContext *context)
+    -> bool {
+  if constexpr (LayoutTraits::POSTING_LISTS) {
+    std::vector<ValueType> values;
+    page_id_t overflow_page_id = leaf->GetValues(index, &values);
+    if (overflow_page_id != INVALID_PAGE_ID) {
+      int size = RemoveFromOverflowList(overflow_page_id, value, context);
+      if (size < 0) {
+        return false;
+      }
+      if (size <= LeafPage::MAX_POSTINGS / 2 && leaf->CanSetValues(index, size)) {
+        OverflowPage::ReadList(buffer_pool_manager_, overflow_page_id, &values);
+        DeleteOverflowList(overflow_page_id, context->transaction_);
+        leaf->SetValues(index, values);
+        LogPageImage(leaf, context);
+      }
+      return true;
+    }
+    auto it = std::lower_bound(values.begin(), values.end(), value, OverflowPage::ValueLess);
+    if (it == values.end() || !(*it == value)) {
+      return false;
+    }
+    values.erase(it);
+    leaf->SetValues(index, values);
+    LogPageImage(leaf, context);
+    return true;
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::CreateOverflowList(const std::vector<ValueType> &values, WriteContext *context) -> page_id_t {
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  OverflowPage *prev = nullptr;
+  for (size_t i = 0; i < values.size(); i += OVERFLOW_PAGE_SIZE) {
+    page_id_t page_id;
+    auto *overflow = reinterpret_cast<OverflowPage *>(NewNodePage(&page_id, context->transaction_)->GetData());
+    overflow->Init(page_id);
+    overflow->CopyNFrom(values.data() + i, static_cast<int>(std::min(values.size() - i, OVERFLOW_PAGE_SIZE)));
+    if (prev == nullptr) {
+      first_page_id = page_id;
+      overflow->SetListSize(static_cast<int>(values.size()));
+    } else {
+      prev->SetNextPageId(page_id);
+    }
+    LogPageImage(overflow, context);
+    prev = overflow;
+  }
+  return first_page_id;
+}
+
+/*
+ * The values of each page come after those of the page before, so a value goes into the first page whose last value
+ * is not less than it, or the last page. A full page splits in two first.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertIntoOverflowList(page_id_t page_id, const ValueType &value, WriteContext *context)
+    -> bool {
+  OverflowPage *first = LatchOverflowPage(page_id, context);
+  OverflowPage *overflow = first;
+  while (overflow->GetNextPageId() != INVALID_PAGE_ID &&
+         OverflowPage::ValueLess(overflow->ValueAt(overflow->GetSize() - 1), value)) {
+    overflow = LatchOverflowPage(overflow->GetNextPageId(), context);
+  }
+  int index = overflow->ValueIndex(value);
+  if (index < overflow->GetSize() && overflow->ValueAt(index) == value) {
+    return false;
+  }
+  if (overflow->GetSize() == overflow->GetMaxSize()) {
+    page_id_t new_page_id;
+    auto *new_overflow = reinterpret_cast<OverflowPage *>(NewNodePage(&new_page_id, context->transaction_)->GetData());
+    new_overflow->Init(new_page_id);
+    overflow->MoveHalfTo(new_overflow);
+    new_overflow->SetNextPageId(overflow->GetNextPageId());
+    overflow->SetNextPageId(new_page_id);
+    LogPageImage(overflow, context);
+    if (!OverflowPage::ValueLess(value, new_overflow->ValueAt(0))) {
+      overflow = new_overflow;
+    }
+  }
+  overflow->Insert(value);
+  first->SetListSize(first->GetListSize() + 1);
+  LogPageImage(overflow, context);
+  LogPageImage(first, context);
+  return true;
+}
+
+/*
+ * A page left empty leaves the chain; the first page, which the leaf points at, takes the values of the next instead.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveFromOverflowList(page_id_t page_id, const ValueType &value, WriteContext *context)
+    -> int {
+  OverflowPage *first = LatchOverflowPage(page_id, context);
+  OverflowPage *prev = nullptr;
+  OverflowPage *overflow = first;
+  while (overflow->GetNextPageId() != INVALID_PAGE_ID &&
+         OverflowPage::ValueLess(overflow->ValueAt(overflow->GetSize() - 1), value)) {
+    prev = overflow;
+    overflow = LatchOverflowPage(overflow->GetNextPageId(), context);
+  }
+  if (!overflow->Remove(value)) {
+    return -1;
+  }
+  first->SetListSize(first->GetListSize() - 1);
+  LogPageImage(overflow, context);
+  LogPageImage(first, context);
+  if (overflow->GetSize() == 0 && prev != nullptr) {
+    prev->SetNextPageId(overflow->GetNextPageId());
+    LogPageImage(prev, context);
+    context->transaction_->AddIntoDeletedPageSet(overflow->GetPageId());
+  } else if (overflow->GetSize() == 0 && overflow->GetNextPageId() != INVALID_PAGE_ID) {
+    OverflowPage *next = LatchOverflowPage(overflow->GetNextPageId(), context);
+    next->MoveAllTo(overflow);
+    overflow->SetNextPageId(next->GetNextPageId());
+    context->transaction_->AddIntoDeletedPageSet(next->GetPageId());
+  }
+  return first->GetListSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeleteOverflowList(page_id_t page_id, Transaction *transaction) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = FetchNodePage(page_id);
+    page_id_t next_page_id = reinterpret_cast<OverflowPage *>(page->GetData())->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    transaction->AddIntoDeletedPageSet(page_id);
+    page_id = next_page_id;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchOverflowPage(page_id_t page_id, WriteContext *context) -> OverflowPage * {
+  Page *page = FetchNodePage(page_id);
+  page->WLatch();
+  context->transaction_->AddIntoPageSet(page);
+  return reinterpret_cast<OverflowPage *>(page->GetData());
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+/*
+ * Input in key order goes straight into the tree. The first pair out of order turns what was loaded so far into the
+ * first sorted run, and the rest of the input is sorted in runs of BULK_LOAD_RUN_PAGES leaves, which are merged
+ * BULK_LOAD_MERGE_WAYS at a time until a single merge can feed the tree. No log records are written for the pages of
+ * the tree: with logging, they are flushed before the record that publishes the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor,
+                              Transaction *transaction) -> bool {
+  LoadRootPageId();
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+
+  BulkLoadState state = NewBulkLoadState(fill_factor, false);
+  KeyType key;
+  ValueType value;
+  bool more;
+  while ((more = next(&key, &value)) && BulkLoadAdd(&state, key, value)) {
+  }
+  if (more) {
+    std::vector<page_id_t> runs{BulkLoadAbandon(&state)};
+    std::vector<std::pair<KeyType, ValueType>> buffer{{key, value}};
+    auto run_size = static_cast<size_t>(BULK_LOAD_RUN_PAGES * std::max(leaf_max_size_ - 1, 1));
+    do {
+      more = next(&key, &value);
+      if (more) {
+        buffer.emplace_back(key, value);
+      }
+      if (buffer.size() == run_size || (!more && !buffer.empty())) {
+        std::stable_sort(buffer.begin(), buffer.end(),
+                         [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; });
+        BulkLoadState run = NewBulkLoadState(1, true);
+        for (const auto &[run_key, run_value] : buffer) {
+          BulkLoadAdd(&run, run_key, run_value);
+        }
+        runs.push_back(BulkLoadFinish(&run));
+        buffer.clear();
+      }
+    } while (more);
+
+    size_t first = 0;
+    while (runs.size() - first > BULK_LOAD_MERGE_WAYS) {
+      BulkLoadState run = NewBulkLoadState(1, true);
+      MergeRuns(std::vector<page_id_t>(runs.begin() + first, runs.begin() + first + BULK_LOAD_MERGE_WAYS), &run);
+      runs.push_back(BulkLoadFinish(&run));
+      first += BULK_LOAD_MERGE_WAYS;
+    }
+    state = NewBulkLoadState(fill_factor, false);
+    MergeRuns(std::vector<page_id_t>(runs.begin() + first, runs.end()), &state);
+  }
+  root_page_id_ = BulkLoadFinish(&state);
+
+  Transaction local_transaction(INVALID_TXN_ID);
+  std::vector<IndexLogOp> ops;
+  WriteContext context{transaction == nullptr ? &local_transaction : transaction,
+                       enable_logging && log_manager_ != nullptr ? &ops : nullptr, LogRecordType::INDEX_INSERT};
+  if (context.ops_ != nullptr) {
+    for (page_id_t page_id : state.page_ids_) {
+      buffer_pool_manager_->FlushPage(page_id);
+    }
+    // Only the root change is logged, so the pages must be on disk before it.
+    buffer_pool_manager_->SyncPages();
+  }
+  if (!IsEmpty()) {
+    LogSetRoot(&context);
+  }
+  FinishWrite(&context);
+  root_latch_.WUnlock();
+  return true;
+}
+
+/*
+ * Pages other than the root start at least half full, like after any split or merge, and no fuller than a page that
+ * has not split yet. Internal pages take at least two children, so that every level has fewer pages than the last.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewBulkLoadState(double fill_factor, bool leaves_only) const -> BulkLoadState {
+  BulkLoadState state;
+  state.leaf_fill_ = std::clamp(static_cast<int>(fill_factor * (leaf_max_size_ - 1)), std::max(leaf_max_size_ / 2, 1),
+                                std::max(leaf_max_size_ - 1, 1));
+  state.internal_fill_ = std::clamp(static_cast<int>(fill_factor * internal_max_size_),
+                                    std::max((internal_max_size_ + 1) / 2, 2), std::max(internal_max_size_, 2));
+  state.fill_factor_ = std::clamp(fill_factor, 0.5, 1.0);
+  state.leaves_only_ = leaves_only;
+  return state;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadAdd(BulkLoadState *state, const KeyType &key, const ValueType &value) -> bool {
+  if (state->size_ > 0) {
+    int cmp = comparator_(key, state->last_key_);
+    if (cmp < 0) {
+      return false;
+    }
+    if (cmp == 0) {
+      if (!unique_keys_) {
+        state->values_.push_back(value);
+      }
+      return true;
+    }
+  }
+  if (unique_keys_) {
+    BulkLoadAppend<LeafPage>(state, 0, key, value);
+  } else {
+    // The values of a key are only appended once the next key shows there are no more of them.
+    BulkLoadAppendValues(state);
+    state->values_.push_back(value);
+  }
+  state->last_key_ = key;
+  state->size_++;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N, typename V>
+void BPLUSTREE_TYPE::BulkLoadAppend(BulkLoadState *state, size_t level, const KeyType &key, const V &value,
+                                    int list_bytes) {
+  constexpr bool is_leaf = std::is_same_v<N, LeafPage>;
+  if (level == state->levels_.size()) {
+    state->levels_.emplace_back();
+  }
+  Page *page = state->levels_[level].page_;
+  if (page == nullptr || BulkLoadIsFull(state, reinterpret_cast<N *>(page->GetData()), list_bytes)) {
+    if (state->levels_[level].prev_page_ != nullptr) {
+      BulkLoadFinishPage<N>(state, level, state->levels_[level].prev_page_, page);
+    }
+    page_id_t page_id;
+    Page *new_page = buffer_pool_manager_->NewPage(&page_id);
+    if (new_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a b+ tree page");
+    }
+    reinterpret_cast<N *>(new_page->GetData())
+        ->Init(page_id, INVALID_PAGE_ID, is_leaf ? leaf_max_size_ : internal_max_size_);
+    if constexpr (is_leaf) {
+      if (page != nullptr) {
+        reinterpret_cast<LeafPage *>(page->GetData())->SetNextPageId(page_id);
+        reinterpret_cast<LeafPage *>(new_page->GetData())->SetPrevPageId(page->GetPageId());
+      } else {
+        state->first_leaf_page_id_ = page_id;
+      }
+    } else {
+      state->internal_page_ids_.push_back(page_id);
+    }
+    state->page_ids_.push_back(page_id);
+    state->levels_[level].prev_page_ = page;
+    state->levels_[level].page_ = new_page;
+    page = new_page;
+  }
+  reinterpret_cast<N *>(page->GetData())->CopyLastFrom(std::make_pair(key, value));
+}
+
+/*
+ * The values gathered for the last key go in as one entry: a posting list in the leaf, or in overflow pages once it
+ * has more values than a leaf keeps.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAppendValues(BulkLoadState *state) {
+  if constexpr (LayoutTraits::POSTING_LISTS) {
+    std::vector<ValueType> &values = state->values_;
+    if (values.empty()) {
+      return;
+    }
+    std::sort(values.begin(), values.end(), OverflowPage::ValueLess);
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    bool in_page = values.size() > 1 && values.size() <= static_cast<size_t>(LeafPage::MAX_POSTINGS);
+    BulkLoadAppend<LeafPage>(state, 0, state->last_key_, values[0],
+                             in_page ? static_cast<int>(values.size() * sizeof(ValueType)) : 0);
+    auto *leaf = reinterpret_cast<LeafPage *>(state->levels_[0].page_->GetData());
+    if (in_page) {
+      leaf->SetValues(leaf->GetSize() - 1, values);
+    } else if (values.size() > 1) {
+      Transaction transaction(INVALID_TXN_ID);
+      WriteContext context{&transaction, nullptr, LogRecordType::INDEX_INSERT};
+      leaf->SetOverflowPageId(leaf->GetSize() - 1, CreateOverflowList(values, &context));
+      for (Page *page : *transaction.GetPageSet()) {
+        state->page_ids_.push_back(page->GetPageId());
+      }
+      ReleasePageSet(&transaction, true);
+    }
+    values.clear();
+  }
+}
+
+/*
+ * Pages of VarKeys fill by bytes, up to the fill factor and no further than they can take one more of the longest
+ * entries, as a page that has not split yet.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::BulkLoadIsFull(const BulkLoadState *state, N *node, int list_bytes) const -> bool {
+  constexpr bool is_leaf = std::is_same_v<N, LeafPage>;
+  if constexpr (is_leaf && LayoutTraits::POSTING_LISTS) {
+    if (node->GetFreeBytes() < static_cast<int>(sizeof(MappingType)) + list_bytes) {
+      return true;
+    }
+  }
+  if constexpr (KeyTraits::IS_VARIABLE) {
+    return node->GetSize() + (is_leaf ? 1 : 0) >= node->GetMaxSize() ||
+           (node->GetSize() >= (is_leaf ? 1 : 2) && node->GetFillFactor() >= state->fill_factor_);
+  }
+  return node->GetSize() == (is_leaf ? state->leaf_fill_ : state->internal_fill_);
+}
+
+/*
+ * A leaf of VarKeys gets its fences here, once the first key of the next leaf is known: the fence between the two is
+ * the shortest key that tells them apart, and it is also the key the parent gets.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+void BPLUSTREE_TYPE::BulkLoadFinishPage(BulkLoadState *state, size_t level, Page *page, Page *next_page) {
+  auto *node = reinterpret_cast<N *>(page->GetData());
+  KeyType key = node->KeyAt(0);
+  if constexpr (KeyTraits::IS_VARIABLE && std::is_same_v<N, LeafPage>) {
+    KeyType low_key = page->GetPageId() == state->first_leaf_page_id_ ? KeyType() : state->low_key_;
+    if (next_page != nullptr) {
+      state->low_key_ =
+          KeyType::Separator(node->KeyAt(node->GetSize() - 1), reinterpret_cast<N *>(next_page->GetData())->KeyAt(0));
+    }
+    node->SetFences(&low_key, next_page == nullptr ? nullptr : &state->low_key_);
+    key = low_key;
+  }
+  if (!state->leaves_only_) {
+    BulkLoadAppend<InternalPage>(state, level + 1, key, node->GetPageId());
+    node->SetParentPageId(state->levels_[level + 1].page_->GetPageId());
+  }
+  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+}
+
+/*
+ * Every page of a level but the last was filled, so only the last may be short of its minimum size. It then takes
+ * pairs or children from the page before it, or all of it moves into that page if they fit together.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::BulkLoadFinishLevel(BulkLoadState *state, size_t level) -> page_id_t {
+  Page *prev_page = state->levels_[level].prev_page_;
+  Page *page = state->levels_[level].page_;
+  state->levels_[level] = BulkLoadLevel{};
+  auto *node = reinterpret_cast<N *>(page->GetData());
+  if (prev_page != nullptr && node->GetSize() < node->GetMinSize()) {
+    auto *prev_node = reinterpret_cast<N *>(prev_page->GetData());
+    int size = prev_node->GetSize();
+    if (CanCoalesce(prev_node, node, node->KeyAt(0))) {
+      if constexpr (std::is_same_v<N, LeafPage>) {
+        node->MoveAllTo(prev_node);
+      } else {
+        node->MoveAllTo(prev_node, node->KeyAt(0));
+        AdoptChildren(prev_node, size, prev_node->GetSize());
+      }
+      page_id_t page_id = node->GetPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page = prev_page;
+      prev_page = nullptr;
+    } else {
+      while (node->GetSize() < node->GetMinSize()) {
+        if constexpr (std::is_same_v<N, LeafPage>) {
+          if constexpr (LayoutTraits::POSTING_LISTS) {
+            if (node->GetFreeBytes() < prev_node->EntrySizeAt(prev_node->GetSize() - 1)) {
+              break;
+            }
+          }
+          prev_node->MoveLastToFrontOf(node);
+        } else {
+          prev_node->MoveLastToFrontOf(node, node->KeyAt(0));
+          AdoptChildren(node, 0, 1);
+        }
+      }
+    }
+  }
+
+  if (prev_page == nullptr && level + 1 == state->levels_.size()) {
+    // Nothing was added to a level above, so this is the only page on the top level.
+    page_id_t page_id = page->GetPageId();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return page_id;
+  }
+  if (prev_page != nullptr) {
+    BulkLoadFinishPage<N>(state, level, prev_page, page);
+  }
+  BulkLoadFinishPage<N>(state, level, page, nullptr);
+  return INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadFinish(BulkLoadState *state) -> page_id_t {
+  BulkLoadAppendValues(state);
+  // Finishing a level adds its last pages to the level above, which may add a level.
+  page_id_t root_page_id = INVALID_PAGE_ID;
+  for (size_t level = 0; level < state->levels_.size() && root_page_id == INVALID_PAGE_ID; ++level) {
+    root_page_id = level == 0 ? BulkLoadFinishLevel<LeafPage>(state, level)
+                              : BulkLoadFinishLevel<InternalPage>(state, level);
+  }
+  return state->leaves_only_ ? state->first_leaf_page_id_ : root_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadAbandon(BulkLoadState *state) -> page_id_t {
+  BulkLoadAppendValues(state);
+  for (const BulkLoadLevel &level : state->levels_) {
+    for (Page *page : {level.prev_page_, level.page_}) {
+      if (page != nullptr) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      }
+    }
+  }
+  state->levels_.clear();
+  // The leaves stay linked in key order, which is all a run needs.
+  for (page_id_t page_id : state->internal_page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  return state->first_leaf_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MergeRuns(const std::vector<page_id_t> &runs, BulkLoadState *state) {
+  Transaction transaction(INVALID_TXN_ID);
+  // The page and the index in it of the next pair of each run.
+  std::vector<std::pair<Page *, int>> cursors;
+  for (page_id_t page_id : runs) {
+    cursors.emplace_back(FetchNodePage(page_id), 0);
+  }
+  auto key_at = [&cursors](size_t run) {
+    return reinterpret_cast<LeafPage *>(cursors[run].first->GetData())->KeyAt(cursors[run].second);
+  };
+  auto greater = [this, &key_at](size_t a, size_t b) { return comparator_(key_at(a), key_at(b)) > 0; };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+  for (size_t run = 0; run < runs.size(); ++run) {
+    heap.push(run);
+  }
+
+  while (!heap.empty()) {
+    size_t run = heap.top();
+    heap.pop();
+    auto &[page, index] = cursors[run];
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    const MappingType &item = leaf->GetItem(index);
+    if constexpr (LayoutTraits::POSTING_LISTS) {
+      // A run keeps the values of a key together, in a posting list or in overflow pages it gives up here.
+      std::vector<ValueType> values;
+      page_id_t overflow_page_id = leaf->GetValues(index, &values);
+      OverflowPage::ReadList(buffer_pool_manager_, overflow_page_id, &values);
+      DeleteOverflowList(overflow_page_id, &transaction);
+      for (const ValueType &value : values) {
+        BulkLoadAdd(state, item.first, value);
+      }
+    } else {
+      BulkLoadAdd(state, item.first, item.second);
+    }
+    if (++index == leaf->GetSize()) {
+      page_id_t page_id = page->GetPageId();
+      page_id_t next_page_id = leaf->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      if (next_page_id == INVALID_PAGE_ID) {
+        continue;
+      }
+      page = FetchNodePage(next_page_id);
+      index = 0;
+    }
+    heap.push(run);
+  }
+  ReleasePageSet(&transaction, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AdoptChildren(InternalPage *node, int first, int last) {
+  for (int i = first; i < last; ++i) {
+    Page *page = FetchNodePage(node->ValueAt(i));
+    reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(node->GetPageId());
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -188,7 +1154,10 @@ auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return f
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafPage(KeyType(), true);
+  return page == nullptr ? End() : INDEXITERATOR_TYPE(buffer_pool_manager_, page, 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -196,7 +1165,14 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE()
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return End();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -206,16 +1182,452 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return IN
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE { return Scan(std::nullopt, std::nullopt, true); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  return Scan(std::nullopt, IndexKeyBound<KeyType>{key, true}, true);
+}
+
+/*
+ * The iterator starts at the near bound and is handed the far one to stop at. An iterator that starts inside a leaf
+ * at one past its last entry, or before its first when reversed, moves on to the next leaf by itself.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Scan(const std::optional<IndexKeyBound<KeyType>> &low,
+                          const std::optional<IndexKeyBound<KeyType>> &high, bool reverse) -> INDEXITERATOR_TYPE {
+  const std::optional<IndexKeyBound<KeyType>> &start = reverse ? high : low;
+  Page *page = start.has_value() ? FindLeafPage(start->key_) : FindLeafPage(KeyType(), !reverse, reverse);
+  if (page == nullptr) {
+    return End();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index;
+  if (!start.has_value()) {
+    index = reverse ? leaf->GetSize() - 1 : 0;
+  } else {
+    // The first key not less than the start: a scan up begins there, one down just before it, unless the start key
+    // itself is there and which way it goes says otherwise.
+    index = leaf->KeyIndex(start->key_, comparator_);
+    bool on_start = index < leaf->GetSize() && comparator_(leaf->KeyAt(index), start->key_) == 0;
+    if (reverse) {
+      index -= on_start && start->inclusive_ ? 0 : 1;
+    } else {
+      index += on_start && !start->inclusive_ ? 1 : 0;
+    }
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, reverse, &comparator_, reverse ? low : high);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * The leaf is returned pinned but not latched, or nullptr if the tree is empty.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, bool rightMost) -> Page * {
+  LoadRootPageId();
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_READS; ++attempt) {
+    Page *page;
+    uint64_t version;
+    if (FindLeafOptimistic(key, leftMost, rightMost, &page, &version)) {
+      return page;
+    }
+  }
+
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FindLeaf(key, Operation::FIND, nullptr, leftMost, rightMost);
+  page->RUnlatch();
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeaf(const KeyType &key, Operation op, Transaction *transaction, bool left_most,
+                              bool right_most) -> Page * {
+  Page *page = FetchNodePage(root_page_id_);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (op == Operation::FIND) {
+    page->RLatch();
+    root_latch_.RUnlock();
+  } else {
+    page->WLatch();
+    if (IsSafe(node, op, true)) {
+      ReleasePageSet(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+  }
+
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    Page *child_page = FetchNodePage(ChildFor(internal, key, left_most, right_most));
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (op == Operation::FIND) {
+      child_page->RLatch();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    } else {
+      child_page->WLatch();
+      if (IsSafe(child, op, false)) {
+        ReleasePageSet(transaction, false);
+      }
+      transaction->AddIntoPageSet(child_page);
+    }
+    page = child_page;
+    node = child;
+  }
+  return page;
+}
+
+/*
+ * A page read as the root or as a child is only known to be that once its parent, or the root page id, is seen
+ * unchanged after the page's version was read: until then a split or merge may have moved the key elsewhere.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key, bool left_most, bool right_most, Page **leaf,
+                                        uint64_t *version) -> bool {
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    *leaf = nullptr;
+    return true;
+  }
+  Page *page = FetchNodePage(page_id);
+  uint64_t page_version;
+  if (!page->ReadVersion(&page_version) || root_page_id_ != page_id) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+
+  while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    page_id_t child_page_id = ChildFor(internal, key, left_most, right_most);
+    // The child page id may be torn by a writer, so it is checked before it is fetched.
+    if (!page->ValidateVersion(page_version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return false;
+    }
+    Page *child_page = FetchNodePage(child_page_id);
+    uint64_t child_version;
+    bool valid = child_page->ReadVersion(&child_version) && page->ValidateVersion(page_version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(child_page_id, false);
+      return false;
+    }
+    page = child_page;
+    page_version = child_version;
+  }
+  *leaf = page;
+  *version = page_version;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ChildFor(const InternalPage *node, const KeyType &key, bool left_most, bool right_most) const
+    -> page_id_t {
+  if (left_most) {
+    return node->ValueAt(0);
+  }
+  // A size torn by a writer is caught by the reader's validation, but must not send it outside the page first.
+  return right_most ? node->ValueAt(std::clamp(node->GetSize() - 1, 0, node->GetMaxSize()))
+                    : node->Lookup(key, comparator_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op, bool is_root) const -> bool {
+  switch (op) {
+    case Operation::INSERT:
+      if constexpr (LayoutTraits::POSTING_LISTS) {
+        // A value takes at most a new entry, or a posting list of two in place of a single value.
+        if (!unique_keys_ && node->IsLeafPage() &&
+            reinterpret_cast<LeafPage *>(node)->GetFreeBytes() <
+                static_cast<int>(sizeof(MappingType) + 2 * sizeof(ValueType))) {
+          return false;
+        }
+      }
+      // A leaf splits as it fills up, an internal page only when it overflows.
+      return node->IsLeafPage() ? node->GetSize() + 1 < node->GetMaxSize() : node->GetSize() < node->GetMaxSize();
+    case Operation::REMOVE:
+      if (is_root) {
+        return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+      }
+      return node->GetSize() > node->GetMinSize();
+    default:
+      return true;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePageSet(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+      continue;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  page_set->clear();
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetParentPage(BPlusTreePage *node, Transaction *transaction) -> InternalPage * {
+  auto page_set = transaction->GetPageSet();
+  for (auto it = page_set->begin() + 1; it != page_set->end(); ++it) {
+    if (*it != nullptr && (*it)->GetPageId() == node->GetPageId()) {
+      BUSTUB_ASSERT(*(it - 1) != nullptr, "the parent of a page that may change is latched");
+      return reinterpret_cast<InternalPage *>((*(it - 1))->GetData());
+    }
+  }
+  UNREACHABLE("page is not on the latched path");
+}
+
+/*
+ * Latches otherwise go down the tree, and sideways only under a latched parent. The next leaf is latched sideways
+ * across parents, so a writer holding it may be one waiting for a page held here, and only a free latch is taken.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryLatchNextLeaf(LeafPage *leaf, Transaction *transaction) -> bool {
+  page_id_t next_page_id = leaf->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  Page *page = FetchNodePage(next_page_id);
+  if (!page->TryWLatch()) {
+    buffer_pool_manager_->UnpinPage(next_page_id, false);
+    return false;
+  }
+  transaction->AddIntoPageSet(page);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetPrevOfNextLeaf(LeafPage *leaf, WriteContext *context) {
+  page_id_t next_page_id = leaf->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  auto page_set = context->transaction_->GetPageSet();
+  auto it = std::find_if(page_set->begin(), page_set->end(),
+                         [next_page_id](Page *page) { return page != nullptr && page->GetPageId() == next_page_id; });
+  BUSTUB_ASSERT(it != page_set->end(), "the leaf after a split or merge is latched");
+  reinterpret_cast<LeafPage *>((*it)->GetData())->SetPrevPageId(leaf->GetPageId());
+  LogSetPage(IndexLogOpType::SET_PREV_PAGE, next_page_id, leaf->GetPageId(), context);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchNodePage(page_id_t page_id) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a b+ tree page");
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewNodePage(page_id_t *page_id, Transaction *transaction) -> Page * {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a b+ tree page");
+  }
+  page->WLatch();
+  transaction->AddIntoPageSet(page);
+  return page;
+}
+
+/*
+ * The record is appended while every page it covers is still latched, so records of a page are in LSN order. A new
+ * root is only published once its record is durable: the header page has no LSN to hold it back until then.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FinishWrite(WriteContext *context) {
+  if (context->ops_ != nullptr && UsesPageImages()) {
+    TakePageImages(context);
+  }
+  if (context->ops_ != nullptr && !context->ops_->empty()) {
+    std::unordered_set<page_id_t> changed_pages;
+    for (const IndexLogOp &op : *context->ops_) {
+      changed_pages.insert(op.page_id_);
+    }
+    LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, context->log_record_type_, std::move(*context->ops_));
+    lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
+    for (Page *page : *context->transaction_->GetPageSet()) {
+      if (page != nullptr && changed_pages.count(page->GetPageId()) != 0) {
+        page->SetLSN(lsn);
+      }
+    }
+    if (context->root_changed_) {
+      log_manager_->WaitForFlush(lsn).get();
+    }
+  }
+  if (context->root_changed_) {
+    UpdateRootPageId();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+void BPLUSTREE_TYPE::LogFormat(N *node, WriteContext *context) {
+  if (UsesPageImages()) {
+    LogPageImage(node, context);
+  } else if (context->ops_ != nullptr) {
+    IndexLogOp op;
+    op.type_ = IndexLogOpType::FORMAT;
+    op.page_id_ = node->GetPageId();
+    op.data_.assign(reinterpret_cast<char *>(node),
+                    node->IsLeafPage() ? LEAF_PAGE_HEADER_SIZE : INTERNAL_PAGE_HEADER_SIZE);
+    context->ops_->push_back(std::move(op));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+void BPLUSTREE_TYPE::LogInsertEntries(N *node, int slot, int count, WriteContext *context) {
+  if (UsesPageImages()) {
+    LogPageImage(node, context);
+  } else if constexpr (!LOG_PAGE_IMAGES) {
+    if (context->ops_ == nullptr || count == 0) {
+      return;
+    }
+    IndexLogOp op;
+    op.type_ = IndexLogOpType::INSERT_ENTRIES;
+    op.page_id_ = node->GetPageId();
+    op.slot_ = slot;
+    op.entry_size_ = sizeof(node->GetItem(slot));
+    op.data_.assign(reinterpret_cast<const char *>(&node->GetItem(slot)), count * op.entry_size_);
+    context->ops_->push_back(std::move(op));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+void BPLUSTREE_TYPE::LogRemoveEntries(N *node, int slot, int count, WriteContext *context) {
+  if (UsesPageImages()) {
+    LogPageImage(node, context);
+  } else if constexpr (!LOG_PAGE_IMAGES) {
+    if (context->ops_ == nullptr || count == 0) {
+      return;
+    }
+    IndexLogOp op;
+    op.type_ = IndexLogOpType::REMOVE_ENTRIES;
+    op.page_id_ = node->GetPageId();
+    op.slot_ = slot;
+    op.value_ = count;
+    op.entry_size_ = sizeof(node->GetItem(slot));
+    context->ops_->push_back(std::move(op));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+void BPLUSTREE_TYPE::LogSetEntry(N *node, int slot, WriteContext *context) {
+  LogRemoveEntries(node, slot, 1, context);
+  LogInsertEntries(node, slot, 1, context);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LogSetPage(IndexLogOpType type, page_id_t page_id, page_id_t value, WriteContext *context) {
+  if (context->ops_ != nullptr) {
+    IndexLogOp op;
+    op.type_ = type;
+    op.page_id_ = page_id;
+    op.value_ = value;
+    context->ops_->push_back(std::move(op));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LogSetRoot(WriteContext *context) {
+  context->root_changed_ = true;
+  if (context->ops_ != nullptr) {
+    IndexLogOp op;
+    op.type_ = IndexLogOpType::SET_ROOT;
+    op.page_id_ = HEADER_PAGE_ID;
+    op.value_ = root_page_id_;
+    op.data_ = index_name_;
+    context->ops_->push_back(std::move(op));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LogPageImage(BPlusTreePage *node, WriteContext *context) {
+  if (context->ops_ != nullptr) {
+    IndexLogOp op;
+    op.type_ = IndexLogOpType::PAGE_IMAGE;
+    op.page_id_ = node->GetPageId();
+    context->ops_->push_back(std::move(op));
+  }
+}
+
+/*
+ * Every page marked is latched in the page set until the record is appended, so its image is taken from there.
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+void BPLUSTREE_TYPE::TakePageImages(WriteContext *context) {
+  std::unordered_set<page_id_t> marked_pages;
+  std::vector<IndexLogOp> ops;
+  for (IndexLogOp &op : *context->ops_) {
+    if (op.type_ == IndexLogOpType::PAGE_IMAGE) {
+      marked_pages.insert(op.page_id_);
+    } else {
+      ops.push_back(std::move(op));
+    }
+  }
+  for (Page *page : *context->transaction_->GetPageSet()) {
+    if (page == nullptr || marked_pages.erase(page->GetPageId()) == 0) {
+      continue;
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    int begin;
+    int end;
+    if (node->IsLeafPage()) {
+      begin = reinterpret_cast<LeafPage *>(node)->GetFreeSpaceBegin();
+      end = reinterpret_cast<LeafPage *>(node)->GetFreeSpaceEnd();
+    } else if (node->IsOverflowPage()) {
+      begin = reinterpret_cast<OverflowPage *>(node)->GetFreeSpaceBegin();
+      end = reinterpret_cast<OverflowPage *>(node)->GetFreeSpaceEnd();
+    } else {
+      begin = reinterpret_cast<InternalPage *>(node)->GetFreeSpaceBegin();
+      end = reinterpret_cast<InternalPage *>(node)->GetFreeSpaceEnd();
+    }
+    IndexLogOp op;
+    op.type_ = IndexLogOpType::PAGE_IMAGE;
+    op.page_id_ = page->GetPageId();
+    op.slot_ = begin;
+    op.value_ = end;
+    op.data_.assign(page->GetData(), begin);
+    op.data_.append(page->GetData() + end, PAGE_SIZE - end);
+    ops.push_back(std::move(op));
+  }
+  BUSTUB_ASSERT(marked_pages.empty(), "pages logged as images are latched");
+  *context->ops_ = std::move(ops);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LoadRootPageId() {
+  std::call_once(root_loaded_, [this] {
+    Page *page = FetchNodePage(HEADER_PAGE_ID);
+    page->RLatch();
+    page_id_t root_page_id;
+    if (reinterpret_cast<HeaderPage *>(page)->GetRootId(index_name_, &root_page_id)) {
+      root_page_id_ = root_page_id;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+  });
 }
 
 /*
@@ -225,17 +1637,23 @@ auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
  * @parameter: insert_record      defualt value is false. When set to true,
  * insert a record <index_name, root_page_id> into header page instead of
  * updating it.
+ * Either way falls back to the other when the record turns out to exist, or not to.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  Page *page = FetchNodePage(HEADER_PAGE_ID);
+  auto *header_page = reinterpret_cast<HeaderPage *>(page);
+  page->WLatch();
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+    if (!header_page->InsertRecord(index_name_, root_page_id_)) {
+      header_page->UpdateRecord(index_name_, root_page_id_);
+    }
+  } else if (!header_page->UpdateRecord(index_name_, root_page_id_)) {
     // update root_page_id in header_page
-    header_page->UpdateRecord(index_name_, root_page_id_);
+    header_page->InsertRecord(index_name_, root_page_id_);
   }
+  page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -339,11 +1757,6 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
       out << "{rank=same " << leaf_prefix << leaf->GetPageId() << " " << leaf_prefix << leaf->GetNextPageId() << "};\n";
     }
 
-    // Print parent links if there is a parent
-    if (leaf->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << leaf->GetParentPageId() << ":p" << leaf->GetPageId() << " -> " << leaf_prefix
-          << leaf->GetPageId() << ";\n";
-    }
   } else {
     InternalPage *inner = reinterpret_cast<InternalPage *>(page);
     // Print node name
@@ -370,14 +1783,12 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
     out << "</TR>";
     // Print table end
     out << "</TABLE>>];\n";
-    // Print Parent link
-    if (inner->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << inner->GetParentPageId() << ":p" << inner->GetPageId() << " -> " << internal_prefix
-          << inner->GetPageId() << ";\n";
-    }
     // Print leaves
     for (int i = 0; i < inner->GetSize(); i++) {
       auto child_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i))->GetData());
+      // Print child links from this side, since the parent page ids of children are only hints
+      out << internal_prefix << inner->GetPageId() << ":p" << inner->ValueAt(i) << " -> "
+          << (child_page->IsLeafPage() ? leaf_prefix : internal_prefix) << inner->ValueAt(i) << ";\n";
       ToGraph(child_page, bpm, out);
       if (i > 0) {
         auto sibling_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i - 1))->GetData());
@@ -431,5 +1842,16 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<GenericKey<4>, RID, IntegerComparator<4, int32_t>>;
+template class BPlusTree<GenericKey<8>, RID, IntegerComparator<8, int32_t>>;
+template class BPlusTree<GenericKey<8>, RID, IntegerComparator<8, int64_t>>;
+template class BPlusTree<GenericKey<8>, RID, IntegerComparator<8, int32_t, 2>>;
+template class BPlusTree<GenericKey<16>, RID, IntegerComparator<16, int32_t>>;
+template class BPlusTree<GenericKey<16>, RID, IntegerComparator<16, int64_t>>;
+template class BPlusTree<GenericKey<16>, RID, IntegerComparator<16, int32_t, 2>>;
+template class BPlusTree<GenericKey<16>, RID, IntegerComparator<16, int64_t, 2>>;
+template class BPlusTree<VarKey<16>, RID, VarKeyComparator<16>>;
+template class BPlusTree<VarKey<32>, RID, VarKeyComparator<32>>;
+template class BPlusTree<VarKey<64>, RID, VarKeyComparator<64>>;
 
 }  // namespace bustub
@@ -11,21 +11,49 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <optional>
+#include <utility>
+
 namespace bustub {
+
+namespace {
+
+/** A cursor over the entries of a tree iterator, which stops at the bound of the scan by itself. */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeIndexCursor : public IndexCursor {
+ public:
+  explicit BPlusTreeIndexCursor(INDEXITERATOR_TYPE &&iterator) : iterator_(std::move(iterator)) {}
+
+  auto Next(RID *rid) -> bool override {
+    if (iterator_.IsEnd()) {
+      return false;
+    }
+    *rid = (*iterator_).second;
+    ++iterator_;
+    return true;
+  }
+
+ private:
+  INDEXITERATOR_TYPE iterator_;
+};
+
+}  // namespace
+
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     LogManager *log_manager)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+                 log_manager, GetMetadata()->IsUnique()) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = ToIndexKey(key);
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -33,21 +61,50 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = ToIndexKey(key);
 
-  container_.Remove(index_key, transaction);
+  if (GetMetadata()->IsUnique()) {
+    container_.Remove(index_key, transaction);
+  } else {
+    container_.Remove(index_key, rid, transaction);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = ToIndexKey(key);
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                                     bool reverse, Transaction *transaction) -> std::unique_ptr<IndexCursor> {
+  std::optional<IndexKeyBound<KeyType>> low_bound;
+  std::optional<IndexKeyBound<KeyType>> high_bound;
+  if (low != nullptr) {
+    low_bound = IndexKeyBound<KeyType>{ToIndexKey(*low), low_inclusive};
+  }
+  if (high != nullptr) {
+    high_bound = IndexKeyBound<KeyType>{ToIndexKey(*high), high_inclusive};
+  }
+  return std::make_unique<BPlusTreeIndexCursor<KeyType, ValueType, KeyComparator>>(
+      container_.Scan(low_bound, high_bound, reverse));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ToIndexKey(const Tuple &key) const -> KeyType {
+  KeyType index_key;
+  if constexpr (BPlusTreeKeyTraits<KeyType>::IS_VARIABLE) {
+    // VarKeys are encoded column by column, which takes the key schema.
+    index_key.SetFromKey(key, GetKeySchema());
+  } else {
+    index_key.SetFromKey(key);
+  }
+  return index_key;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
@@ -62,5 +119,16 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<4>, RID, IntegerComparator<4, int32_t>>;
+template class BPlusTreeIndex<GenericKey<8>, RID, IntegerComparator<8, int32_t>>;
+template class BPlusTreeIndex<GenericKey<8>, RID, IntegerComparator<8, int64_t>>;
+template class BPlusTreeIndex<GenericKey<8>, RID, IntegerComparator<8, int32_t, 2>>;
+template class BPlusTreeIndex<GenericKey<16>, RID, IntegerComparator<16, int32_t>>;
+template class BPlusTreeIndex<GenericKey<16>, RID, IntegerComparator<16, int64_t>>;
+template class BPlusTreeIndex<GenericKey<16>, RID, IntegerComparator<16, int32_t, 2>>;
+template class BPlusTreeIndex<GenericKey<16>, RID, IntegerComparator<16, int64_t, 2>>;
+template class BPlusTreeIndex<VarKey<16>, RID, VarKeyComparator<16>>;
+template class BPlusTreeIndex<VarKey<32>, RID, VarKeyComparator<32>>;
+template class BPlusTreeIndex<VarKey<64>, RID, VarKeyComparator<64>>;
 
 }  // namespace bustub
@@ -45,5 +45,13 @@ template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>
 template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExtendibleHashTableIndex<GenericKey<4>, RID, IntegerComparator<4, int32_t>>;
+template class ExtendibleHashTableIndex<GenericKey<8>, RID, IntegerComparator<8, int32_t>>;
+template class ExtendibleHashTableIndex<GenericKey<8>, RID, IntegerComparator<8, int64_t>>;
+template class ExtendibleHashTableIndex<GenericKey<8>, RID, IntegerComparator<8, int32_t, 2>>;
+template class ExtendibleHashTableIndex<GenericKey<16>, RID, IntegerComparator<16, int32_t>>;
+template class ExtendibleHashTableIndex<GenericKey<16>, RID, IntegerComparator<16, int64_t>>;
+template class ExtendibleHashTableIndex<GenericKey<16>, RID, IntegerComparator<16, int32_t, 2>>;
+template class ExtendibleHashTableIndex<GenericKey<16>, RID, IntegerComparator<16, int64_t, 2>>;
 
 }  // namespace bustub
@@ -2,29 +2,145 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index, bool reverse,
+                                  const KeyComparator *comparator, std::optional<IndexKeyBound<KeyType>> stop)
+    : buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      index_(index),
+      reverse_(reverse),
+      comparator_(comparator),
+      stop_(std::move(stop)) {
+  assert(!stop_.has_value() || comparator_ != nullptr);
+  SettleOnEntry();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() {  // NOLINT
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(other.page_),
+      leaf_(other.leaf_),
+      index_(other.index_),
+      reverse_(other.reverse_),
+      comparator_(other.comparator_),
+      stop_(std::move(other.stop_)),
+      postings_(std::move(other.postings_)),
+      posting_index_(other.posting_index_) {
+  other.page_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> INDEXITERATOR_TYPE & {
+  if (this != &other) {
+    if (page_ != nullptr) {
+      buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    }
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    index_ = other.index_;
+    reverse_ = other.reverse_;
+    comparator_ = other.comparator_;
+    stop_ = std::move(other.stop_);
+    postings_ = std::move(other.postings_);
+    posting_index_ = other.posting_index_;
+    other.page_ = nullptr;
+  }
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_ == nullptr; }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  item_ = leaf_->GetItem(index_);
+  if (!postings_.empty()) {
+    item_.second = postings_[posting_index_];
+  }
+  return item_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  posting_index_ += reverse_ ? -1 : 1;
+  if (posting_index_ >= 0 && posting_index_ < static_cast<int>(postings_.size())) {
+    return *this;
+  }
+  index_ += reverse_ ? -1 : 1;
+  SettleOnEntry();
+  return *this;
+}
+
+/*
+ * The keys of the leaves ahead all lie beyond the last key of this leaf in the direction of travel, so once that key
+ * has reached the stop bound, the next leaf has nothing to return and is never fetched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SettleOnEntry() {
+  while (page_ != nullptr && (reverse_ ? index_ < 0 : index_ >= leaf_->GetSize())) {
+    int size = leaf_->GetSize();
+    if (stop_.has_value() && size > 0 && CompareToStop(leaf_->KeyAt(reverse_ ? 0 : size - 1)) >= 0) {
+      Finish();
+      return;
+    }
+    page_id_t page_id = reverse_ ? leaf_->GetPrevPageId() : leaf_->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(page_id);
+    leaf_ = page_ == nullptr ? nullptr : reinterpret_cast<LeafPage *>(page_->GetData());
+    index_ = reverse_ && leaf_ != nullptr ? leaf_->GetSize() - 1 : 0;
+  }
+  if (page_ != nullptr && stop_.has_value()) {
+    int cmp = CompareToStop(leaf_->KeyAt(index_));
+    if (cmp > 0 || (cmp == 0 && !stop_->inclusive_)) {
+      Finish();
+    }
+  }
+  LoadPostings();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadPostings() {
+  postings_.clear();
+  posting_index_ = 0;
+  if constexpr (BPlusTreeLayoutTraits<KeyType, KeyComparator>::POSTING_LISTS) {
+    if (page_ != nullptr && leaf_->HasPostingList(index_)) {
+      page_id_t overflow_page_id = leaf_->GetValues(index_, &postings_);
+      BPlusTreeOverflowPage<ValueType>::ReadList(buffer_pool_manager_, overflow_page_id, &postings_);
+      posting_index_ = reverse_ ? static_cast<int>(postings_.size()) - 1 : 0;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::CompareToStop(const KeyType &key) const -> int {
+  int cmp = (*comparator_)(key, stop_->key_);
+  return reverse_ ? -cmp : cmp;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Finish() {
+  buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  page_ = nullptr;
+  leaf_ = nullptr;
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -36,4 +152,26 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<GenericKey<4>, RID, IntegerComparator<4, int32_t>>;
+
+template class IndexIterator<GenericKey<8>, RID, IntegerComparator<8, int32_t>>;
+
+template class IndexIterator<GenericKey<8>, RID, IntegerComparator<8, int64_t>>;
+
+template class IndexIterator<GenericKey<8>, RID, IntegerComparator<8, int32_t, 2>>;
+
+template class IndexIterator<GenericKey<16>, RID, IntegerComparator<16, int32_t>>;
+
+template class IndexIterator<GenericKey<16>, RID, IntegerComparator<16, int64_t>>;
+
+template class IndexIterator<GenericKey<16>, RID, IntegerComparator<16, int32_t, 2>>;
+
+template class IndexIterator<GenericKey<16>, RID, IntegerComparator<16, int64_t, 2>>;
+
+template class IndexIterator<VarKey<16>, RID, VarKeyComparator<16>>;
+
+template class IndexIterator<VarKey<32>, RID, VarKeyComparator<32>>;
+
+template class IndexIterator<VarKey<64>, RID, VarKeyComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.cpp
+//
+// Identification: src/storage/index/key_search.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_search.h"
+
+#include <limits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The binary search stops at this many bytes of keys, two cache lines, which one pass of compares covers. */
+constexpr int WINDOW_BYTES = 128;
+
+template <typename IntType>
+auto CountLessScalar(const IntType *keys, int size, IntType key) -> int {
+  int count = 0;
+  for (int i = 0; i < size; ++i) {
+    count += keys[i] < key ? 1 : 0;
+  }
+  return count;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) auto CountLessAvx2(const int32_t *keys, int size, int32_t key) -> int {
+  const __m256i needle = _mm256_set1_epi32(key);
+  int count = 0;
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    __m256i less = _mm256_cmpgt_epi32(needle, block);
+    count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(less)));
+  }
+  return count + CountLessScalar(keys + i, size - i, key);
+}
+
+__attribute__((target("avx2"))) auto CountLessAvx2(const int64_t *keys, int size, int64_t key) -> int {
+  const __m256i needle = _mm256_set1_epi64x(key);
+  int count = 0;
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    __m256i less = _mm256_cmpgt_epi64(needle, block);
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+  }
+  return count + CountLessScalar(keys + i, size - i, key);
+}
+
+__attribute__((target("sse4.2"))) auto CountLessSse42(const int32_t *keys, int size, int32_t key) -> int {
+  const __m128i needle = _mm_set1_epi32(key);
+  int count = 0;
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    __m128i less = _mm_cmpgt_epi32(needle, block);
+    count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(less)));
+  }
+  return count + CountLessScalar(keys + i, size - i, key);
+}
+
+__attribute__((target("sse4.2"))) auto CountLessSse42(const int64_t *keys, int size, int64_t key) -> int {
+  const __m128i needle = _mm_set1_epi64x(key);
+  int count = 0;
+  int i = 0;
+  for (; i + 2 <= size; i += 2) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    __m128i less = _mm_cmpgt_epi64(needle, block);
+    count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(less)));
+  }
+  return count + CountLessScalar(keys + i, size - i, key);
+}
+#endif
+
+enum class SimdLevel { NONE, SSE42, AVX2 };
+
+auto DetectSimdLevel() -> SimdLevel {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("avx2") != 0) {
+    return SimdLevel::AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.2") != 0) {
+    return SimdLevel::SSE42;
+  }
+#endif
+  return SimdLevel::NONE;
+}
+
+template <typename IntType>
+auto CountLess(const IntType *keys, int size, IntType key) -> int {
+#if defined(__x86_64__)
+  static const SimdLevel simd_level = DetectSimdLevel();
+  switch (simd_level) {
+    case SimdLevel::AVX2:
+      return CountLessAvx2(keys, size, key);
+    case SimdLevel::SSE42:
+      return CountLessSse42(keys, size, key);
+    case SimdLevel::NONE:
+      break;
+  }
+#endif
+  return CountLessScalar(keys, size, key);
+}
+
+/*
+ * The first key not less than key lies in [base, base + size]. Each step halves size and moves base past the lower
+ * half if its last key is less than key, with a conditional move rather than a branch that mispredicts half the time.
+ */
+template <typename IntType, typename Count>
+auto LowerBoundWith(const IntType *keys, int size, IntType key, Count count_less) -> int {
+  constexpr int WINDOW = WINDOW_BYTES / sizeof(IntType);
+  const IntType *base = keys;
+  while (size > WINDOW) {
+    int half = size / 2;
+    base = base[half - 1] < key ? base + half : base;
+    size -= half;
+  }
+  return static_cast<int>(base - keys) + count_less(base, size, key);
+}
+
+}  // namespace
+
+auto KeySearch::LowerBound(const int32_t *keys, int size, int32_t key) -> int {
+  return LowerBoundWith(keys, size, key, CountLess<int32_t>);
+}
+
+auto KeySearch::LowerBound(const int64_t *keys, int size, int64_t key) -> int {
+  return LowerBoundWith(keys, size, key, CountLess<int64_t>);
+}
+
+auto KeySearch::UpperBound(const int32_t *keys, int size, int32_t key) -> int {
+  return key == std::numeric_limits<int32_t>::max() ? size : LowerBound(keys, size, key + 1);
+}
+
+auto KeySearch::UpperBound(const int64_t *keys, int size, int64_t key) -> int {
+  return key == std::numeric_limits<int64_t>::max() ? size : LowerBound(keys, size, key + 1);
+}
+
+auto KeySearch::LowerBoundScalar(const int32_t *keys, int size, int32_t key) -> int {
+  return LowerBoundWith(keys, size, key, CountLessScalar<int32_t>);
+}
+
+auto KeySearch::LowerBoundScalar(const int64_t *keys, int size, int64_t key) -> int {
+  return LowerBoundWith(keys, size, key, CountLessScalar<int64_t>);
+}
+
+auto KeySearch::HasSimdSupport() -> bool { return DetectSimdLevel() != SimdLevel::NONE; }
+
+}  // namespace bustub
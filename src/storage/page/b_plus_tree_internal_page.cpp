@@ -9,10 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -25,34 +28,51 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+}
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType { return array_[index].first; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
 
 /*
  * Helper method to find and return array index(or offset), so that its value
  * equals to input "value"
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (array_[i].second == value) {
+      return i;
+    }
+  }
+  return -1;
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+
+/*
+ * Helper method to find and return the key & value pair associated with input
+ * "index"(a.k.a array offset)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetItem(int index) -> const MappingType & { return array_[index]; }
 
 /*****************************************************************************
  * LOOKUP
@@ -64,7 +84,18 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { ret
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
-  return INVALID_PAGE_ID;
+  // Find the last key <= key; the invalid first key stands for minus infinity.
+  int low = 1;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator(array_[mid].first, key) <= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return array_[low - 1].second;
 }
 
 /*****************************************************************************
@@ -78,7 +109,12 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCompara
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
-                                                     const ValueType &new_value) {}
+                                                     const ValueType &new_value) {
+  array_[0].second = old_value;
+  array_[1] = MappingType(new_key, new_value);
+  SetSize(2);
+}
+
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -87,7 +123,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) -> int {
-  return 0;
+  int index = ValueIndex(old_value) + 1;
+  std::move_backward(array_ + index, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[index] = MappingType(new_key, new_value);
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -97,15 +137,19 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  * Remove half of key & value pairs from this page to "recipient" page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient) {
+  int keep = (GetSize() + 1) / 2;
+  recipient->CopyNFrom(array_ + keep, GetSize() - keep);
+  SetSize(keep);
+}
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
- * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
+  std::copy(items, items + size, array_ + GetSize());
+  IncreaseSize(size);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,14 +160,21 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+}
 
 /*
  * Remove the only key & value pair in internal page and return the value
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType { return INVALID_PAGE_ID; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
+  SetSize(0);
+  return array_[0].second;
+}
+
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -131,12 +182,13 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType { r
  * Remove all of key & value pairs from this page to "recipient" page.
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  SetKeyAt(0, middle_key);
+  recipient->CopyNFrom(array_, GetSize());
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -146,37 +198,427 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  *
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->CopyLastFrom(MappingType(middle_key, array_[0].second));
+  Remove(0);
+}
 
 /* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair) {
+  array_[GetSize()] = pair;
+  IncreaseSize(1);
+}
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
  * You need to handle the original dummy key properly, e.g. updating recipient’s array to position the middle_key at the
  * right place.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
- * moved to the recipient
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->SetKeyAt(0, middle_key);
+  recipient->CopyFirstFrom(array_[GetSize() - 1]);
+  IncreaseSize(-1);
+}
 
 /* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair) {
+  std::move_backward(array_, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[0] = pair;
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetFreeSpaceBegin() const -> int {
+  return INTERNAL_PAGE_HEADER_SIZE + GetSize() * static_cast<int>(sizeof(MappingType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetFreeSpaceEnd() const -> int { return PAGE_SIZE; }
+
+/*****************************************************************************
+ * VARKEY INTERNAL PAGE
+ *****************************************************************************/
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+  capacity_ = max_size;
+  data_start_ = PAGE_SIZE;
+  unused_ = 0;
+  UpdateMaxSize();
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  VarKeySlot slot = SlotAt(index);
+  KeyType key;
+  key.SetFromBytes(reinterpret_cast<const char *>(this) + slot.offset_, slot.key_size_);
+  return key;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  BUSTUB_ASSERT(CanSetKeyAt(index, key), "a new key must fit");
+  ValueType value = ValueAt(index);
+  RemoveVarKeyEntry(reinterpret_cast<char *>(this), slots_, GetSize(), index, &data_start_, sizeof(ValueType));
+  IncreaseSize(-1);
+  InsertAt(index, key, value);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const -> bool {
+  return GetFreeSpaceEnd() - GetFreeSpaceBegin() + SlotAt(index).key_size_ >= key.size_;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  VarKeySlot slot = SlotAt(index);
+  ValueType value;
+  memcpy(&value, reinterpret_cast<const char *>(this) + slot.offset_ + slot.key_size_, sizeof(ValueType));
+  return value;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::GetItem(int index) -> MappingType {
+  return MappingType(KeyAt(index), ValueAt(index));
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator & /*comparator*/) const
+    -> ValueType {
+  // Find the last key <= key; the invalid first key stands for minus infinity.
+  int low = 1;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (CompareAt(key, mid) >= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return ValueAt(low - 1);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                 const ValueType &new_value) {
+  SetItems({MappingType(KeyType(), old_value), MappingType(new_key, new_value)});
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                 const ValueType &new_value) -> int {
+  InsertAt(ValueIndex(old_value) + 1, new_key, new_value);
+  return GetSize();
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::Remove(int index) {
+  RemoveVarKeyEntry(reinterpret_cast<char *>(this), slots_, GetSize(), index, &data_start_, sizeof(ValueType));
+  IncreaseSize(-1);
+  UpdateMaxSize();
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
+  ValueType value = ValueAt(0);
+  SetItems({});
+  return value;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  std::vector<MappingType> items = GetItems();
+  items.front().first = middle_key;
+  for (const auto &item : items) {
+    recipient->CopyLastFrom(item);
+  }
+  SetItems({});
+}
+
+/*
+ * The split point halves the key bytes rather than the children, so that long keys do not crowd one half.
+ */
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient) {
+  std::vector<MappingType> items = GetItems();
+  int keep = 0;
+  for (int kept = 0; keep < GetSize() && kept * 2 < PAGE_SIZE - data_start_; keep++) {
+    kept += items[keep].first.size_ + sizeof(ValueType);
+  }
+  keep = std::clamp(keep, 1, GetSize() - 1);
+  recipient->SetItems(std::vector<MappingType>(items.begin() + keep, items.end()));
+  items.resize(keep);
+  SetItems(items);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->CopyLastFrom(MappingType(middle_key, ValueAt(0)));
+  Remove(0);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->SetKeyAt(0, middle_key);
+  recipient->InsertAt(0, KeyAt(GetSize() - 1), ValueAt(GetSize() - 1));
+  Remove(GetSize() - 1);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::CanMergeFrom(const BPlusTreeInternalPage *sibling, const KeyType &middle_key) const
+    -> bool {
+  int size = PAGE_SIZE - data_start_ + PAGE_SIZE - sibling->data_start_ - sibling->SlotAt(0).key_size_ +
+             middle_key.size_ + (GetSize() + sibling->GetSize()) * static_cast<int>(sizeof(VarKeySlot));
+  return size <= PAGE_SIZE - static_cast<int>(reinterpret_cast<const char *>(slots_) -
+                                              reinterpret_cast<const char *>(this));
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair) { InsertAt(GetSize(), pair.first, pair.second); }
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::GetFillFactor() const -> double {
+  int space = PAGE_SIZE - static_cast<int>(reinterpret_cast<const char *>(slots_) -
+                                           reinterpret_cast<const char *>(this));
+  return 1.0 - static_cast<double>(GetFreeSpaceEnd() - GetFreeSpaceBegin()) / space;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::GetFreeSpaceBegin() const -> int {
+  return reinterpret_cast<const char *>(slots_ + GetSize()) - reinterpret_cast<const char *>(this);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::GetFreeSpaceEnd() const -> int { return data_start_; }
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::CompareAt(const KeyType &key, int index) const -> int {
+  VarKeySlot slot = SlotAt(index);
+  int cmp = memcmp(key.data_, reinterpret_cast<const char *>(this) + slot.offset_,
+                   std::min<size_t>(key.size_, slot.key_size_));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return key.size_ < slot.key_size_ ? -1 : (key.size_ > slot.key_size_ ? 1 : 0);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::SlotAt(int index) const -> VarKeySlot {
+  VarKeySlot slot = slots_[index];
+  if (slot.key_size_ > KeySize || slot.offset_ + slot.key_size_ + sizeof(ValueType) > PAGE_SIZE) {
+    return VarKeySlot{static_cast<uint16_t>(PAGE_SIZE - sizeof(ValueType)), 0};
+  }
+  return slot;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_INTERNAL_PAGE_TYPE::GetItems() const -> std::vector<MappingType> {
+  std::vector<MappingType> items;
+  items.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    items.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return items;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::SetItems(const std::vector<MappingType> &items) {
+  data_start_ = PAGE_SIZE;
+  SetSize(0);
+  for (const auto &item : items) {
+    CopyLastFrom(item);
+  }
+  UpdateMaxSize();
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(GetFreeSpaceEnd() - GetFreeSpaceBegin() >=
+                    static_cast<int>(sizeof(VarKeySlot) + key.size_ + sizeof(ValueType)),
+                "an internal page below its max size has room for any key");
+  InsertVarKeyEntry(reinterpret_cast<char *>(this), slots_, GetSize(), index, &data_start_, key.data_, key.size_,
+                    &value, sizeof(ValueType));
+  IncreaseSize(1);
+  UpdateMaxSize();
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_INTERNAL_PAGE_TYPE::UpdateMaxSize() {
+  SetMaxSize(std::min(capacity_, GetSize() + (GetFreeSpaceEnd() - GetFreeSpaceBegin()) / MAX_ENTRY_SIZE));
+}
+
+/*****************************************************************************
+ * SPLIT KEY INTERNAL PAGE
+ *****************************************************************************/
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+  BUSTUB_ASSERT(GetFreeSpaceBegin() + max_size * static_cast<int>(sizeof(IntType) + sizeof(ValueType)) <= PAGE_SIZE,
+                "max size entries fit in the page");
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  KeyType key;
+  memset(key.data_, 0, KeySize);
+  memcpy(key.data_, &keys_[index], sizeof(IntType));
+  return key;
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  keys_[index] = KeyComparator::ColumnOf(key);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueSlot(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return ValueSlot(index); }
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::GetItem(int index) -> MappingType {
+  return MappingType(KeyAt(index), ValueSlot(index));
+}
+
+/*
+ * The child is the one before the first key greater than key, skipping the invalid first key.
+ */
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+  int index = KeySearch::UpperBound(keys_ + 1, GetSize() - 1, KeyComparator::ColumnOf(key));
+  return ValueSlot(index);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                   const ValueType &new_value) {
+  ValueSlot(0) = old_value;
+  keys_[1] = KeyComparator::ColumnOf(new_key);
+  ValueSlot(1) = new_value;
+  SetSize(2);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                   const ValueType &new_value) -> int {
+  InsertAt(ValueIndex(old_value) + 1, KeyComparator::ColumnOf(new_key), new_value);
+  return GetSize();
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::Remove(int index) {
+  RemoveSplitKeyEntries(reinterpret_cast<char *>(this), reinterpret_cast<char *>(keys_), GetSize(), index, 1,
+                        sizeof(IntType), sizeof(ValueType));
+  IncreaseSize(-1);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
+  SetSize(0);
+  return ValueSlot(0);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  SetKeyAt(0, middle_key);
+  recipient->CopyNFrom(this, 0, GetSize());
+  SetSize(0);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient) {
+  int keep = (GetSize() + 1) / 2;
+  recipient->CopyNFrom(this, keep, GetSize() - keep);
+  SetSize(keep);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->InsertAt(recipient->GetSize(), KeyComparator::ColumnOf(middle_key), ValueSlot(0));
+  Remove(0);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->SetKeyAt(0, middle_key);
+  recipient->InsertAt(0, keys_[GetSize() - 1], ValueSlot(GetSize() - 1));
+  IncreaseSize(-1);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair) {
+  InsertAt(GetSize(), KeyComparator::ColumnOf(pair.first), pair.second);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::GetFreeSpaceBegin() const -> int {
+  return reinterpret_cast<const char *>(keys_ + GetSize()) - reinterpret_cast<const char *>(this);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::GetFreeSpaceEnd() const -> int {
+  return PAGE_SIZE - GetSize() * static_cast<int>(sizeof(ValueType));
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::ValueSlot(int index) -> ValueType & {
+  return reinterpret_cast<ValueType *>(reinterpret_cast<char *>(this) + PAGE_SIZE)[-1 - index];
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_INTERNAL_PAGE_TYPE::ValueSlot(int index) const -> const ValueType & {
+  return reinterpret_cast<const ValueType *>(reinterpret_cast<const char *>(this) + PAGE_SIZE)[-1 - index];
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::InsertAt(int index, IntType key, const ValueType &value) {
+  InsertSplitKeyEntry(reinterpret_cast<char *>(this), reinterpret_cast<char *>(keys_), GetSize(), index, &key,
+                      sizeof(IntType), &value, sizeof(ValueType));
+  IncreaseSize(1);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_INTERNAL_PAGE_TYPE::CopyNFrom(const BPlusTreeInternalPage *source, int index, int count) {
+  AppendSplitKeyEntries(reinterpret_cast<char *>(this), reinterpret_cast<char *>(keys_), GetSize(),
+                        reinterpret_cast<const char *>(source), reinterpret_cast<const char *>(source->keys_), index,
+                        count, sizeof(IntType), sizeof(ValueType));
+  IncreaseSize(count);
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -184,4 +626,15 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, IntegerComparator<4, int32_t>>;
+template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, IntegerComparator<8, int32_t>>;
+template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, IntegerComparator<8, int64_t>>;
+template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, IntegerComparator<8, int32_t, 2>>;
+template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, IntegerComparator<16, int32_t>>;
+template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, IntegerComparator<16, int64_t>>;
+template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, IntegerComparator<16, int32_t, 2>>;
+template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, IntegerComparator<16, int64_t, 2>>;
+template class BPlusTreeInternalPage<VarKey<16>, page_id_t, VarKeyComparator<16>>;
+template class BPlusTreeInternalPage<VarKey<32>, page_id_t, VarKeyComparator<32>>;
+template class BPlusTreeInternalPage<VarKey<64>, page_id_t, VarKeyComparator<64>>;
 }  // namespace bustub
@@ -9,10 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -24,19 +27,34 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+  next_page_id_ = INVALID_PAGE_ID;
+  prev_page_id_ = INVALID_PAGE_ID;
+}
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next and previous page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return INVALID_PAGE_ID; }
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
 
 /**
  * Helper method to find the first index i so that array[i].first >= key
@@ -44,7 +62,17 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
-  return 0;
+  int low = 0;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator(array_[mid].first, key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
 }
 
 /*
@@ -52,21 +80,14 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparato
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType { return array_[index].first; }
 
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) -> const MappingType & {
-  // replace with your own code
-  return array_[0];
-}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) -> const MappingType & { return array_[index]; }
 
 /*****************************************************************************
  * INSERTION
@@ -78,7 +99,11 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) -> const MappingType & {
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
     -> int {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  std::move_backward(array_ + index, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[index] = MappingType(key, value);
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -86,15 +111,44 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &val
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * With posting lists, the halves are balanced by bytes rather than by count.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  int keep = GetSize() / 2;
+  if (GetPostingsBegin() < PAGE_SIZE) {
+    int half = (PAGE_SIZE - GetFreeBytes() - LEAF_PAGE_HEADER_SIZE) / 2;
+    int bytes = 0;
+    for (keep = 0; keep < GetSize() && bytes < half; keep++) {
+      bytes += EntrySizeAt(keep);
+    }
+    keep = std::clamp(keep, 1, GetSize() - 1);
+  }
+  recipient->CopyNFrom(this, keep, GetSize() - keep);
+  SetSize(keep);
+  RepackPostings();
+}
 
 /*
  * Copy starting from items, and copy {size} number of elements into me.
+ * Copied entries point into the posting lists of source until theirs are written here, so they are cleared first.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const BPlusTreeLeafPage *source, int index, int count) {
+  int size = GetSize();
+  std::copy(source->array_ + index, source->array_ + index + count, array_ + size);
+  IncreaseSize(count);
+  for (int i = 0; i < count; i++) {
+    if (source->PostingCount(index + i) > 0) {
+      array_[size + i].second = ValueType();
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    if (source->PostingCount(index + i) > 0) {
+      AddPostings(size + i, source->PostingsAt(index + i), source->PostingCount(index + i));
+    }
+  }
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -107,7 +161,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
     -> bool {
-  return false;
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array_[index].first, key) != 0) {
+    return false;
+  }
+  *value = array_[index].second;
+  return true;
 }
 
 /*****************************************************************************
@@ -121,7 +180,14 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array_[index].first, key) != 0) {
+    return GetSize();
+  }
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+  RepackPostings();
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -132,7 +198,17 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  * to update the next_page id in the sibling page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  recipient->CopyNFrom(this, 0, GetSize());
+  recipient->SetNextPageId(next_page_id_);
+  SetSize(0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanMergeFrom(const BPlusTreeLeafPage *sibling) const -> bool {
+  int bytes = PAGE_SIZE - sibling->GetFreeBytes() - LEAF_PAGE_HEADER_SIZE;
+  return GetSize() + sibling->GetSize() < GetMaxSize() && bytes <= GetFreeBytes();
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -141,29 +217,656 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
  * Remove the first key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyNFrom(this, 0, 1);
+  std::move(array_ + 1, array_ + GetSize(), array_);
+  IncreaseSize(-1);
+  RepackPostings();
+}
 
 /*
  * Copy the item into the end of my item list. (Append item to my array)
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  array_[GetSize()] = item;
+  IncreaseSize(1);
+}
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyFirstFrom(this, GetSize() - 1);
+  IncreaseSize(-1);
+  RepackPostings();
+}
 
 /*
  * Insert item at the front of my items. Move items accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const BPlusTreeLeafPage *source, int index) {
+  std::move_backward(array_, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[0] = source->array_[index];
+  IncreaseSize(1);
+  if (source->PostingCount(index) > 0) {
+    array_[0].second = ValueType();
+    AddPostings(0, source->PostingsAt(index), source->PostingCount(index));
+  }
+}
+
+/*****************************************************************************
+ * POSTING LISTS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::HasPostingList(int index) const -> bool {
+  page_id_t page_id = array_[index].second.GetPageId();
+  return page_id == IN_PAGE_POSTINGS || page_id == OVERFLOW_POSTINGS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetValues(int index, std::vector<ValueType> *values) const -> page_id_t {
+  const ValueType &value = array_[index].second;
+  if (value.GetPageId() == OVERFLOW_POSTINGS) {
+    return static_cast<page_id_t>(value.GetSlotNum());
+  }
+  if (value.GetPageId() != IN_PAGE_POSTINGS) {
+    values->push_back(value);
+    return INVALID_PAGE_ID;
+  }
+  const ValueType *postings = PostingsAt(index);
+  values->insert(values->end(), postings, postings + PostingCount(index));
+  return INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanSetValues(int index, int count) const -> bool {
+  int bytes = count > 1 ? count * static_cast<int>(sizeof(ValueType)) : 0;
+  return bytes <= GetFreeBytes() + PostingCount(index) * static_cast<int>(sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValues(int index, const std::vector<ValueType> &values) {
+  array_[index].second = values[0];
+  RepackPostings();
+  if (values.size() > 1) {
+    AddPostings(index, values.data(), static_cast<int>(values.size()));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetOverflowPageId(int index, page_id_t page_id) {
+  array_[index].second = ValueType(OVERFLOW_POSTINGS, static_cast<uint32_t>(page_id));
+  RepackPostings();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetFreeBytes() const -> int { return GetFreeSpaceEnd() - GetFreeSpaceBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::EntrySizeAt(int index) const -> int {
+  return static_cast<int>(sizeof(MappingType) + PostingCount(index) * sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetFreeSpaceBegin() const -> int {
+  return LEAF_PAGE_HEADER_SIZE + GetSize() * static_cast<int>(sizeof(MappingType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetFreeSpaceEnd() const -> int { return GetPostingsBegin(); }
+
+/*
+ * The offset and length are clamped to the page, so that a torn entry seen by an optimistic reader stays inside it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::PostingsAt(int index) const -> const ValueType * {
+  int offset = static_cast<int>(array_[index].second.GetSlotNum() >> 16);
+  offset = std::clamp(offset, LEAF_PAGE_HEADER_SIZE,
+                      PAGE_SIZE - PostingCount(index) * static_cast<int>(sizeof(ValueType)));
+  return reinterpret_cast<const ValueType *>(reinterpret_cast<const char *>(this) + offset);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::PostingCount(int index) const -> int {
+  const ValueType &value = array_[index].second;
+  if (value.GetPageId() != IN_PAGE_POSTINGS) {
+    return 0;
+  }
+  return std::min(static_cast<int>(value.GetSlotNum() & 0xffff), MAX_POSTINGS);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPostingsBegin() const -> int {
+  int begin = PAGE_SIZE;
+  for (int i = 0; i < GetSize(); i++) {
+    if (array_[i].second.GetPageId() == IN_PAGE_POSTINGS) {
+      begin = std::min(begin, static_cast<int>(array_[i].second.GetSlotNum() >> 16));
+    }
+  }
+  return begin;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::AddPostings(int index, const ValueType *values, int count) {
+  int offset = GetPostingsBegin() - count * static_cast<int>(sizeof(ValueType));
+  memmove(reinterpret_cast<char *>(this) + offset, values, count * sizeof(ValueType));
+  array_[index].second = ValueType(IN_PAGE_POSTINGS, static_cast<uint32_t>(offset) << 16 | count);
+}
+
+/*
+ * The lists are rewritten from the end of the page down in entry order, out of a copy of the area they were in.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RepackPostings() {
+  int begin = GetPostingsBegin();
+  if (begin == PAGE_SIZE) {
+    return;
+  }
+  char *page = reinterpret_cast<char *>(this);
+  std::vector<char> postings(page + begin, page + PAGE_SIZE);
+  int offset = PAGE_SIZE;
+  for (int i = 0; i < GetSize(); i++) {
+    int count = PostingCount(i);
+    if (count == 0) {
+      continue;
+    }
+    int old_offset = static_cast<int>(array_[i].second.GetSlotNum() >> 16);
+    offset -= count * static_cast<int>(sizeof(ValueType));
+    memcpy(page + offset, postings.data() + old_offset - begin, count * sizeof(ValueType));
+    array_[i].second = ValueType(IN_PAGE_POSTINGS, static_cast<uint32_t>(offset) << 16 | count);
+  }
+}
+
+/*****************************************************************************
+ * VARKEY LEAF PAGE
+ *****************************************************************************/
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+  next_page_id_ = INVALID_PAGE_ID;
+  prev_page_id_ = INVALID_PAGE_ID;
+  capacity_ = max_size;
+  data_start_ = PAGE_SIZE;
+  prefix_size_ = 0;
+  low_size_ = 0;
+  high_size_ = OPEN_FENCE;
+  UpdateMaxSize();
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  VarKeySlot slot = SlotAt(index);
+  size_t prefix_size = std::min<size_t>(prefix_size_, KeySize);
+  KeyType key;
+  key.size_ = prefix_size + std::min<size_t>(slot.key_size_, KeySize - prefix_size);
+  memcpy(key.data_, low_key_, prefix_size);
+  memcpy(key.data_ + prefix_size, reinterpret_cast<const char *>(this) + slot.offset_, key.size_ - prefix_size);
+  return key;
+}
+
+/*
+ * VarKeys compare by their bytes, so the search compares the bytes on the page instead of whole keys.
+ */
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator & /*comparator*/) const -> int {
+  int cmp = ComparePrefix(key);
+  if (cmp != 0) {
+    return cmp < 0 ? 0 : GetSize();
+  }
+  int low = 0;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (CompareAt(key, mid) > 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetItem(int index) -> MappingType { return MappingType(KeyAt(index), ValueAt(index)); }
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
+    -> int {
+  BUSTUB_ASSERT(ComparePrefix(key) == 0, "keys of a leaf lie between its fences");
+  int entry_size = key.size_ - prefix_size_ + sizeof(ValueType);
+  BUSTUB_ASSERT(GetFreeSpaceEnd() - GetFreeSpaceBegin() >= static_cast<int>(sizeof(VarKeySlot)) + entry_size,
+                "a leaf below its max size has room for any key");
+  InsertVarKeyEntry(reinterpret_cast<char *>(this), slots_, GetSize(), KeyIndex(key, comparator), &data_start_,
+                    key.data_ + prefix_size_, key.size_ - prefix_size_, &value, sizeof(ValueType));
+  IncreaseSize(1);
+  UpdateMaxSize();
+  return GetSize();
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
+    -> bool {
+  if (ComparePrefix(key) != 0) {
+    return false;
+  }
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || CompareAt(key, index) != 0) {
+    return false;
+  }
+  *value = ValueAt(index);
+  return true;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int {
+  if (ComparePrefix(key) != 0) {
+    return GetSize();
+  }
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || CompareAt(key, index) != 0) {
+    return GetSize();
+  }
+  RemoveVarKeyEntry(reinterpret_cast<char *>(this), slots_, GetSize(), index, &data_start_, sizeof(ValueType));
+  IncreaseSize(-1);
+  UpdateMaxSize();
+  return GetSize();
+}
+
+/*
+ * The split point halves the key bytes rather than the entries, so that long keys do not crowd one half.
+ */
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> items = GetItems();
+  size_t total = 0;
+  for (const auto &item : items) {
+    total += item.first.size_ + sizeof(ValueType);
+  }
+  int keep = 0;
+  for (size_t kept = 0; keep < static_cast<int>(items.size()) && kept * 2 < total; keep++) {
+    kept += items[keep].first.size_ + sizeof(ValueType);
+  }
+  keep = std::clamp(keep, 1, static_cast<int>(items.size()) - 1);
+
+  KeyType separator = KeyType::Separator(items[keep - 1].first, items[keep].first);
+  std::optional<KeyType> high_key = GetHighKey();
+  recipient->WriteFences(&separator, high_key ? &*high_key : nullptr);
+  recipient->SetItems(std::vector<MappingType>(items.begin() + keep, items.end()));
+  KeyType low_key = GetLowKey();
+  WriteFences(&low_key, &separator);
+  items.resize(keep);
+  SetItems(items);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> items = recipient->GetItems();
+  for (auto &item : GetItems()) {
+    items.push_back(std::move(item));
+  }
+  KeyType low_key = recipient->GetLowKey();
+  std::optional<KeyType> high_key = GetHighKey();
+  recipient->WriteFences(&low_key, high_key ? &*high_key : nullptr);
+  recipient->SetItems(items);
+  recipient->SetNextPageId(next_page_id_);
+  SetItems({});
+}
+
+/*
+ * Either way the key that moves, or the one that becomes first, is the new fence between the pages, since it is
+ * the key their parent gets.
+ */
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> items = GetItems();
+  std::vector<MappingType> recipient_items = recipient->GetItems();
+  recipient_items.push_back(items.front());
+  items.erase(items.begin());
+
+  KeyType fence = items.front().first;
+  KeyType recipient_low_key = recipient->GetLowKey();
+  recipient->WriteFences(&recipient_low_key, &fence);
+  recipient->SetItems(recipient_items);
+  std::optional<KeyType> high_key = GetHighKey();
+  WriteFences(&fence, high_key ? &*high_key : nullptr);
+  SetItems(items);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> items = GetItems();
+  std::vector<MappingType> recipient_items = recipient->GetItems();
+  recipient_items.insert(recipient_items.begin(), items.back());
+  items.pop_back();
+
+  KeyType fence = recipient_items.front().first;
+  std::optional<KeyType> recipient_high_key = recipient->GetHighKey();
+  recipient->WriteFences(&fence, recipient_high_key ? &*recipient_high_key : nullptr);
+  recipient->SetItems(recipient_items);
+  KeyType low_key = GetLowKey();
+  WriteFences(&low_key, &fence);
+  SetItems(items);
+}
+
+/*
+ * Both pages give up the part of their prefix that the merged fences no longer share, which each entry then stores.
+ */
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::CanMergeFrom(const BPlusTreeLeafPage *sibling) const -> bool {
+  std::optional<KeyType> high_key = sibling->GetHighKey();
+  size_t prefix_size = high_key ? KeyType::CommonPrefix(GetLowKey(), *high_key, 0) : 0;
+  int size = 0;
+  for (const BPlusTreeLeafPage *page : {this, sibling}) {
+    size += PAGE_SIZE - page->data_start_ +
+            page->GetSize() * static_cast<int>(sizeof(VarKeySlot) + page->prefix_size_ - prefix_size);
+  }
+  return size <= PAGE_SIZE - static_cast<int>(reinterpret_cast<const char *>(slots_) -
+                                              reinterpret_cast<const char *>(this));
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  BUSTUB_ASSERT(ComparePrefix(item.first) == 0, "keys of a leaf lie between its fences");
+  InsertVarKeyEntry(reinterpret_cast<char *>(this), slots_, GetSize(), GetSize(), &data_start_,
+                    item.first.data_ + prefix_size_, item.first.size_ - prefix_size_, &item.second, sizeof(ValueType));
+  IncreaseSize(1);
+  UpdateMaxSize();
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetLowKey() const -> KeyType {
+  KeyType key;
+  key.SetFromBytes(low_key_, low_size_);
+  return key;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::SetFences(const KeyType *low_key, const KeyType *high_key) {
+  std::vector<MappingType> items = GetItems();
+  WriteFences(low_key, high_key);
+  SetItems(items);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetFillFactor() const -> double {
+  int space = PAGE_SIZE - static_cast<int>(reinterpret_cast<const char *>(slots_) -
+                                           reinterpret_cast<const char *>(this));
+  return 1.0 - static_cast<double>(GetFreeSpaceEnd() - GetFreeSpaceBegin()) / space;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetFreeSpaceBegin() const -> int {
+  return reinterpret_cast<const char *>(slots_ + GetSize()) - reinterpret_cast<const char *>(this);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetFreeSpaceEnd() const -> int { return data_start_; }
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::ComparePrefix(const KeyType &key) const -> int {
+  size_t prefix_size = std::min<size_t>(prefix_size_, KeySize);
+  int cmp = memcmp(key.data_, low_key_, std::min<size_t>(key.size_, prefix_size));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return key.size_ < prefix_size ? -1 : 0;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::CompareAt(const KeyType &key, int index) const -> int {
+  VarKeySlot slot = SlotAt(index);
+  size_t prefix_size = std::min<size_t>(prefix_size_, key.size_);
+  size_t key_size = key.size_ - prefix_size;
+  int cmp = memcmp(key.data_ + prefix_size, reinterpret_cast<const char *>(this) + slot.offset_,
+                   std::min<size_t>(key_size, slot.key_size_));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return key_size < slot.key_size_ ? -1 : (key_size > slot.key_size_ ? 1 : 0);
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::SlotAt(int index) const -> VarKeySlot {
+  VarKeySlot slot = slots_[index];
+  if (slot.key_size_ > KeySize || slot.offset_ + slot.key_size_ + sizeof(ValueType) > PAGE_SIZE) {
+    return VarKeySlot{static_cast<uint16_t>(PAGE_SIZE - sizeof(ValueType)), 0};
+  }
+  return slot;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  VarKeySlot slot = SlotAt(index);
+  ValueType value;
+  memcpy(&value, reinterpret_cast<const char *>(this) + slot.offset_ + slot.key_size_, sizeof(ValueType));
+  return value;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetItems() const -> std::vector<MappingType> {
+  std::vector<MappingType> items;
+  items.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    items.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return items;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::SetItems(const std::vector<MappingType> &items) {
+  std::optional<KeyType> high_key = GetHighKey();
+  prefix_size_ = high_key ? KeyType::CommonPrefix(GetLowKey(), *high_key, 0) : 0;
+  data_start_ = PAGE_SIZE;
+  SetSize(0);
+  for (const auto &item : items) {
+    CopyLastFrom(item);
+  }
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+auto VAR_KEY_LEAF_PAGE_TYPE::GetHighKey() const -> std::optional<KeyType> {
+  if (high_size_ == OPEN_FENCE) {
+    return std::nullopt;
+  }
+  KeyType key;
+  key.SetFromBytes(high_key_, high_size_);
+  return key;
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::WriteFences(const KeyType *low_key, const KeyType *high_key) {
+  low_size_ = low_key == nullptr ? 0 : low_key->size_;
+  memcpy(low_key_, low_key == nullptr ? "" : low_key->data_, low_size_);
+  high_size_ = high_key == nullptr ? OPEN_FENCE : high_key->size_;
+  if (high_key != nullptr) {
+    memcpy(high_key_, high_key->data_, high_size_);
+  }
+}
+
+VAR_KEY_TEMPLATE_ARGUMENTS
+void VAR_KEY_LEAF_PAGE_TYPE::UpdateMaxSize() {
+  SetMaxSize(std::min(capacity_, GetSize() + (GetFreeSpaceEnd() - GetFreeSpaceBegin()) / MAX_ENTRY_SIZE));
+}
+
+/*****************************************************************************
+ * SPLIT KEY LEAF PAGE
+ *****************************************************************************/
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+  next_page_id_ = INVALID_PAGE_ID;
+  prev_page_id_ = INVALID_PAGE_ID;
+  BUSTUB_ASSERT(GetFreeSpaceBegin() + max_size * static_cast<int>(sizeof(IntType) + sizeof(ValueType)) <= PAGE_SIZE,
+                "max size entries fit in the page");
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  KeyType key;
+  memset(key.data_, 0, KeySize);
+  memcpy(key.data_, &keys_[index], sizeof(IntType));
+  return key;
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  return KeySearch::LowerBound(keys_, GetSize(), KeyComparator::ColumnOf(key));
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::GetItem(int index) -> MappingType { return MappingType(KeyAt(index), ValueSlot(index)); }
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
+    -> int {
+  InsertAt(KeyIndex(key, comparator), KeyComparator::ColumnOf(key), value);
+  return GetSize();
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || keys_[index] != KeyComparator::ColumnOf(key)) {
+    return false;
+  }
+  *value = ValueSlot(index);
+  return true;
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || keys_[index] != KeyComparator::ColumnOf(key)) {
+    return GetSize();
+  }
+  RemoveAt(index, 1);
+  return GetSize();
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  int keep = GetSize() / 2;
+  recipient->CopyNFrom(this, keep, GetSize() - keep);
+  SetSize(keep);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  recipient->CopyNFrom(this, 0, GetSize());
+  recipient->SetNextPageId(next_page_id_);
+  SetSize(0);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyNFrom(this, 0, 1);
+  RemoveAt(0, 1);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  recipient->InsertAt(0, keys_[GetSize() - 1], ValueSlot(GetSize() - 1));
+  IncreaseSize(-1);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  InsertAt(GetSize(), KeyComparator::ColumnOf(item.first), item.second);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::GetFreeSpaceBegin() const -> int {
+  return reinterpret_cast<const char *>(keys_ + GetSize()) - reinterpret_cast<const char *>(this);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::GetFreeSpaceEnd() const -> int {
+  return PAGE_SIZE - GetSize() * static_cast<int>(sizeof(ValueType));
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::ValueSlot(int index) -> ValueType & {
+  return reinterpret_cast<ValueType *>(reinterpret_cast<char *>(this) + PAGE_SIZE)[-1 - index];
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+auto SPLIT_KEY_LEAF_PAGE_TYPE::ValueSlot(int index) const -> const ValueType & {
+  return reinterpret_cast<const ValueType *>(reinterpret_cast<const char *>(this) + PAGE_SIZE)[-1 - index];
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::InsertAt(int index, IntType key, const ValueType &value) {
+  InsertSplitKeyEntry(reinterpret_cast<char *>(this), reinterpret_cast<char *>(keys_), GetSize(), index, &key,
+                      sizeof(IntType), &value, sizeof(ValueType));
+  IncreaseSize(1);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::RemoveAt(int index, int count) {
+  RemoveSplitKeyEntries(reinterpret_cast<char *>(this), reinterpret_cast<char *>(keys_), GetSize(), index, count,
+                        sizeof(IntType), sizeof(ValueType));
+  IncreaseSize(-count);
+}
+
+SPLIT_KEY_TEMPLATE_ARGUMENTS
+void SPLIT_KEY_LEAF_PAGE_TYPE::CopyNFrom(const BPlusTreeLeafPage *source, int index, int count) {
+  AppendSplitKeyEntries(reinterpret_cast<char *>(this), reinterpret_cast<char *>(keys_), GetSize(),
+                        reinterpret_cast<const char *>(source), reinterpret_cast<const char *>(source->keys_), index,
+                        count, sizeof(IntType), sizeof(ValueType));
+  IncreaseSize(count);
+}
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<4>, RID, IntegerComparator<4, int32_t>>;
+template class BPlusTreeLeafPage<GenericKey<8>, RID, IntegerComparator<8, int32_t>>;
+template class BPlusTreeLeafPage<GenericKey<8>, RID, IntegerComparator<8, int64_t>>;
+template class BPlusTreeLeafPage<GenericKey<8>, RID, IntegerComparator<8, int32_t, 2>>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID, IntegerComparator<16, int32_t>>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID, IntegerComparator<16, int64_t>>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID, IntegerComparator<16, int32_t, 2>>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID, IntegerComparator<16, int64_t, 2>>;
+template class BPlusTreeLeafPage<VarKey<16>, RID, VarKeyComparator<16>>;
+template class BPlusTreeLeafPage<VarKey<32>, RID, VarKeyComparator<32>>;
+template class BPlusTreeLeafPage<VarKey<64>, RID, VarKeyComparator<64>>;
 }  // namespace bustub
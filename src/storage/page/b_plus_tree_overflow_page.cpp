@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_overflow_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_overflow_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_overflow_page.h"
+
+namespace bustub {
+
+template <typename ValueType>
+void B_PLUS_TREE_OVERFLOW_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
+  SetPageType(IndexPageType::OVERFLOW_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetParentPageId(INVALID_PAGE_ID);
+  SetPageId(page_id);
+  next_page_id_ = INVALID_PAGE_ID;
+  list_size_ = 0;
+}
+
+template <typename ValueType>
+auto B_PLUS_TREE_OVERFLOW_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+template <typename ValueType>
+void B_PLUS_TREE_OVERFLOW_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+template <typename ValueType>
+auto B_PLUS_TREE_OVERFLOW_PAGE_TYPE::GetListSize() const -> int { return list_size_; }
+
+template <typename ValueType>
+void B_PLUS_TREE_OVERFLOW_PAGE_TYPE::SetListSize(int list_size) { list_size_ = list_size; }
+
+template <typename ValueType>
+auto B_PLUS_TREE_OVERFLOW_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index]; }
+
+template <typename ValueType>
+auto B_PLUS_TREE_OVERFLOW_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  return static_cast<int>(std::lower_bound(array_, array_ + GetSize(), value, ValueLess) - array_);
+}
+
+template <typename ValueType>
+auto B_PLUS_TREE_OVERFLOW_PAGE_TYPE::Insert(const ValueType &value) -> bool {
+  int index = ValueIndex(value);
+  if (index < GetSize() && array_[index] == value) {
+    return false;
+  }
+  std::move_backward(array_ + index, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[index] = value;
+  IncreaseSize(1);
+  return true;
+}
+
+template <typename ValueType>
+auto B_PLUS_TREE_OVERFLOW_PAGE_TYPE::Remove(const ValueType &value) -> bool {
+  int index = ValueIndex(value);
+  if (index == GetSize() || !(array_[index] == value)) {
+    return false;
+  }
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+  return true;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_OVERFLOW_PAGE_TYPE::CopyNFrom(const ValueType *values, int count) {
+  std::copy(values, values + count, array_ + GetSize());
+  IncreaseSize(count);
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_OVERFLOW_PAGE_TYPE::MoveHalfTo(BPlusTreeOverflowPage *recipient) {
+  int keep = GetSize() / 2;
+  recipient->CopyNFrom(array_ + keep, GetSize() - keep);
+  SetSize(keep);
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_OVERFLOW_PAGE_TYPE::MoveAllTo(BPlusTreeOverflowPage *recipient) {
+  recipient->CopyNFrom(array_, GetSize());
+  SetSize(0);
+}
+
+template <typename ValueType>
+auto B_PLUS_TREE_OVERFLOW_PAGE_TYPE::GetFreeSpaceBegin() const -> int {
+  return OVERFLOW_PAGE_HEADER_SIZE + GetSize() * static_cast<int>(sizeof(ValueType));
+}
+
+template <typename ValueType>
+auto B_PLUS_TREE_OVERFLOW_PAGE_TYPE::GetFreeSpaceEnd() const -> int { return PAGE_SIZE; }
+
+template <typename ValueType>
+void B_PLUS_TREE_OVERFLOW_PAGE_TYPE::ReadList(BufferPoolManager *buffer_pool_manager, page_id_t page_id,
+                                              std::vector<ValueType> *values) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a b+ tree page");
+    }
+    auto *overflow = reinterpret_cast<BPlusTreeOverflowPage *>(page->GetData());
+    values->insert(values->end(), overflow->array_, overflow->array_ + overflow->GetSize());
+    page_id = overflow->GetNextPageId();
+    buffer_pool_manager->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+template class BPlusTreeOverflowPage<RID>;
+
+}  // namespace bustub
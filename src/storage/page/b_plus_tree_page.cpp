@@ -11,51 +11,154 @@
 
 #include "storage/page/b_plus_tree_page.h"
 
+#include <cstring>
+
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
 namespace bustub {
 
 /*
  * Helper methods to get/set page type
  * Page type enum class is defined in b_plus_tree_page.h
  */
-auto BPlusTreePage::IsLeafPage() const -> bool { return false; }
-auto BPlusTreePage::IsRootPage() const -> bool { return false; }
-void BPlusTreePage::SetPageType(IndexPageType page_type) {}
+auto BPlusTreePage::IsLeafPage() const -> bool { return page_type_ == IndexPageType::LEAF_PAGE; }
+auto BPlusTreePage::IsOverflowPage() const -> bool { return page_type_ == IndexPageType::OVERFLOW_PAGE; }
+auto BPlusTreePage::IsRootPage() const -> bool { return parent_page_id_ == INVALID_PAGE_ID; }
+void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_type; }
 
 /*
  * Helper methods to get/set size (number of key/value pairs stored in that
  * page)
  */
-auto BPlusTreePage::GetSize() const -> int { return 0; }
-void BPlusTreePage::SetSize(int size) {}
-void BPlusTreePage::IncreaseSize(int amount) {}
+auto BPlusTreePage::GetSize() const -> int { return size_; }
+void BPlusTreePage::SetSize(int size) { size_ = size; }
+void BPlusTreePage::IncreaseSize(int amount) { size_ += amount; }
 
 /*
  * Helper methods to get/set max size (capacity) of the page
  */
-auto BPlusTreePage::GetMaxSize() const -> int { return 0; }
-void BPlusTreePage::SetMaxSize(int size) {}
+auto BPlusTreePage::GetMaxSize() const -> int { return max_size_; }
+void BPlusTreePage::SetMaxSize(int size) { max_size_ = size; }
 
 /*
  * Helper method to get min page size
  * Generally, min page size == max page size / 2
+ * A leaf splits when it fills up, an internal page only when it overflows, hence the rounding.
  */
-auto BPlusTreePage::GetMinSize() const -> int { return 0; }
+auto BPlusTreePage::GetMinSize() const -> int { return IsLeafPage() ? max_size_ / 2 : (max_size_ + 1) / 2; }
 
 /*
  * Helper methods to get/set parent page id
  */
-auto BPlusTreePage::GetParentPageId() const -> page_id_t { return 0; }
-void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) {}
+auto BPlusTreePage::GetParentPageId() const -> page_id_t { return parent_page_id_; }
+void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) { parent_page_id_ = parent_page_id; }
 
 /*
  * Helper methods to get/set self page id
  */
-auto BPlusTreePage::GetPageId() const -> page_id_t { return 0; }
-void BPlusTreePage::SetPageId(page_id_t page_id) {}
+auto BPlusTreePage::GetPageId() const -> page_id_t { return page_id_; }
+void BPlusTreePage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
 
 /*
  * Helper methods to set lsn
  */
 void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
+void BPlusTreePage::InsertVarKeyEntry(char *page, VarKeySlot *slots, int size, int index, uint16_t *data_start,
+                                      const char *key, int key_size, const void *value, int value_size) {
+  *data_start -= key_size + value_size;
+  memcpy(page + *data_start, key, key_size);
+  memcpy(page + *data_start + key_size, value, value_size);
+  memmove(slots + index + 1, slots + index, (size - index) * sizeof(VarKeySlot));
+  slots[index] = VarKeySlot{*data_start, static_cast<uint16_t>(key_size)};
+}
+
+/*
+ * The entries below the removed one move up to close the gap, so the free space stays in one piece.
+ */
+void BPlusTreePage::RemoveVarKeyEntry(char *page, VarKeySlot *slots, int size, int index, uint16_t *data_start,
+                                      int value_size) {
+  VarKeySlot removed = slots[index];
+  int entry_size = removed.key_size_ + value_size;
+  memmove(page + *data_start + entry_size, page + *data_start, removed.offset_ - *data_start);
+  *data_start += entry_size;
+  memmove(slots + index, slots + index + 1, (size - index - 1) * sizeof(VarKeySlot));
+  for (int i = 0; i < size - 1; i++) {
+    if (slots[i].offset_ < removed.offset_) {
+      slots[i].offset_ += entry_size;
+    }
+  }
+}
+
+void BPlusTreePage::InsertSplitKeyEntry(char *page, char *keys, int size, int index, const void *key, int key_size,
+                                        const void *value, int value_size) {
+  char *values = page + PAGE_SIZE;
+  memmove(keys + (index + 1) * key_size, keys + index * key_size, (size - index) * key_size);
+  memcpy(keys + index * key_size, key, key_size);
+  memmove(values - (size + 1) * value_size, values - size * value_size, (size - index) * value_size);
+  memcpy(values - (index + 1) * value_size, value, value_size);
+}
+
+void BPlusTreePage::RemoveSplitKeyEntries(char *page, char *keys, int size, int index, int count, int key_size,
+                                          int value_size) {
+  char *values = page + PAGE_SIZE;
+  int moved = size - index - count;
+  memmove(keys + index * key_size, keys + (index + count) * key_size, moved * key_size);
+  memmove(values - (size - count) * value_size, values - size * value_size, moved * value_size);
+}
+
+void BPlusTreePage::AppendSplitKeyEntries(char *page, char *keys, int size, const char *source_page,
+                                          const char *source_keys, int index, int count, int key_size,
+                                          int value_size) {
+  memcpy(keys + size * key_size, source_keys + index * key_size, count * key_size);
+  memcpy(page + PAGE_SIZE - (size + count) * value_size, source_page + PAGE_SIZE - (index + count) * value_size,
+         count * value_size);
+}
+
+/*
+ * Entries are moved as raw bytes: the op carries the entry width, and the header size follows from the page type.
+ */
+void BPlusTreePage::ApplyLogOp(const IndexLogOp &op) {
+  static_assert(sizeof(BPlusTreePage) == INTERNAL_PAGE_HEADER_SIZE, "internal entries follow the common header");
+  char *page = reinterpret_cast<char *>(this);
+  char *entries = page + (IsLeafPage() ? LEAF_PAGE_HEADER_SIZE : INTERNAL_PAGE_HEADER_SIZE);
+  switch (op.type_) {
+    case IndexLogOpType::FORMAT:
+      memcpy(page, op.data_.data(), op.data_.size());
+      size_ = 0;
+      break;
+    case IndexLogOpType::INSERT_ENTRIES: {
+      int count = static_cast<int>(op.data_.size()) / op.entry_size_;
+      memmove(entries + (op.slot_ + count) * op.entry_size_, entries + op.slot_ * op.entry_size_,
+              (size_ - op.slot_) * op.entry_size_);
+      memcpy(entries + op.slot_ * op.entry_size_, op.data_.data(), op.data_.size());
+      size_ += count;
+      break;
+    }
+    case IndexLogOpType::REMOVE_ENTRIES:
+      memmove(entries + op.slot_ * op.entry_size_, entries + (op.slot_ + op.value_) * op.entry_size_,
+              (size_ - op.slot_ - op.value_) * op.entry_size_);
+      size_ -= op.value_;
+      break;
+    case IndexLogOpType::SET_NEXT_PAGE:
+      // The next page id of a leaf directly follows the common header.
+      memcpy(page + sizeof(BPlusTreePage), &op.value_, sizeof(page_id_t));
+      break;
+    case IndexLogOpType::SET_PREV_PAGE:
+      // The previous page id of a leaf follows its next page id.
+      memcpy(page + sizeof(BPlusTreePage) + sizeof(page_id_t), &op.value_, sizeof(page_id_t));
+      break;
+    case IndexLogOpType::SET_PARENT_PAGE:
+      parent_page_id_ = op.value_;
+      break;
+    case IndexLogOpType::PAGE_IMAGE:
+      memcpy(page, op.data_.data(), op.slot_);
+      memcpy(page + op.value_, op.data_.data() + op.slot_, op.data_.size() - op.slot_);
+      break;
+    default:
+      break;
+  }
+}
+
 }  // namespace bustub
@@ -108,6 +108,14 @@ template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class HashTableBucketPage<GenericKey<4>, RID, IntegerComparator<4, int32_t>>;
+template class HashTableBucketPage<GenericKey<8>, RID, IntegerComparator<8, int32_t>>;
+template class HashTableBucketPage<GenericKey<8>, RID, IntegerComparator<8, int64_t>>;
+template class HashTableBucketPage<GenericKey<8>, RID, IntegerComparator<8, int32_t, 2>>;
+template class HashTableBucketPage<GenericKey<16>, RID, IntegerComparator<16, int32_t>>;
+template class HashTableBucketPage<GenericKey<16>, RID, IntegerComparator<16, int64_t>>;
+template class HashTableBucketPage<GenericKey<16>, RID, IntegerComparator<16, int32_t, 2>>;
+template class HashTableBucketPage<GenericKey<16>, RID, IntegerComparator<16, int64_t, 2>>;
 
 // template class HashTableBucketPage<hash_t, TmpTuple, HashComparator>;
 
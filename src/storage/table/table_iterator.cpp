@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 
 #include "storage/table/table_heap.h"
@@ -43,6 +44,7 @@ auto TableIterator::operator++() -> TableIterator & {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+      ReadAhead(cur_page->GetTablePageId(), cur_page->GetNextPageId());
       auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
@@ -64,6 +66,22 @@ auto TableIterator::operator++() -> TableIterator & {
   return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t prev_page_id, page_id_t page_id) {
+  if (page_id != prev_page_id + 1) {
+    return;
+  }
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  // Keep the window small relative to the pool, or read-ahead evicts the pages it just brought in.
+  auto window = std::min<page_id_t>(READ_AHEAD_WINDOW, buffer_pool_manager->GetPoolSize() / 4);
+  // Refill the window once the scan is halfway through it.
+  if (window == 0 || page_id + window / 2 < read_ahead_until_) {
+    return;
+  }
+  page_id_t first_page_id = std::max(page_id + 1, read_ahead_until_);
+  read_ahead_until_ = page_id + 1 + window;
+  buffer_pool_manager->PrefetchPages(first_page_id, read_ahead_until_);
+}
+
 auto TableIterator::operator++(int) -> TableIterator {
   TableIterator clone(*this);
   ++(*this);
@@ -11,9 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <fstream>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -21,7 +25,7 @@ namespace bustub {
 
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
+TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -86,7 +90,7 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
+TEST(BufferPoolManagerInstanceTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -141,4 +145,468 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// Threads hammer a small hot set (hits) while also touching cold pages (misses and evictions).
+static void ConcurrentHitMiss(ReplacerType replacer_type) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 4;
+  const int rounds = 500;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+
+  // Scenario: create more pages than fit in the pool, each stamped with its own page id.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: threads hammer a small hot set (hits) while also touching cold pages (misses and evictions).
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid]() {
+      for (int round = 0; round < rounds; ++round) {
+        page_id_t page_id = round % 3 == 0 ? (round + tid) % num_pages : tid % 2;
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(page_id, std::atoi(page->GetData()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: every pin was released, so all frames can be handed out again.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentHitMissTest) {
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+    ConcurrentHitMiss(replacer_type);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const auto old_interval = background_writer_interval;
+  background_writer_interval = std::chrono::milliseconds(5);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, log_manager);
+
+  // Scenario: fill the pool with dirty, unpinned pages. Page i carries LSN i.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData() + 64, PAGE_SIZE - 64, "page %d", page_id_temp);
+    page->SetLSN(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  auto wait_for_background_writes = [bpm](uint64_t expected) {
+    for (int i = 0; i < 400 && bpm->GetStats().background_writes_ < expected; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return bpm->GetStats().background_writes_;
+  };
+
+  // Scenario: with logging enabled, only pages whose LSN is persistent in the log may be written.
+  enable_logging = true;
+  log_manager->SetPersistentLSN(4);
+  bpm->StartBackgroundWriter(1.0);
+  EXPECT_EQ(5, wait_for_background_writes(5));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(5, bpm->GetStats().background_writes_);
+
+  // Scenario: once the log catches up, the remaining pages are cleaned too.
+  log_manager->SetPersistentLSN(buffer_pool_size);
+  EXPECT_EQ(buffer_pool_size, wait_for_background_writes(buffer_pool_size));
+  bpm->StopBackgroundWriter();
+  enable_logging = false;
+
+  // Scenario: evicting every page now costs no foreground write.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetStats().foreground_writes_);
+
+  // Scenario: the pages written in the background can be read back.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData() + 64));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a background write fails, here on a closed file. The page stays dirty and the write is not counted.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  disk_manager->ShutDown();
+  bpm->StartBackgroundWriter(1.0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().background_writes_);
+  EXPECT_TRUE(page->IsDirty());
+
+  remove("test.db");
+  remove("test.log");
+  background_writer_interval = old_interval;
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: create twice as many pages as fit in the pool, so the first ones are evicted.
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: prefetching reads the evicted pages in the background. Unallocated pages are ignored.
+  int reads = disk_manager->GetNumReads();
+  bpm->PrefetchPages(0, 5);
+  bpm->PrefetchPage(buffer_pool_size * 3);
+  for (int i = 0; i < 400 && disk_manager->GetNumReads() < reads + 5; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(reads + 5, disk_manager->GetNumReads());
+
+  // Scenario: the prefetched pages are unpinned, so the pool can still be filled with new pages.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size - 5; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    pinned.push_back(page_id_temp);
+  }
+
+  // Scenario: fetching the prefetched pages hits the pool without another disk read.
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::atoi(page->GetData()));
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(reads + 5, disk_manager->GetNumReads());
+
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: create twice as many pages as fit in the pool, so pages 0 to 9 are evicted.
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a batch of hits and misses. The misses are read once each, a repeated page is pinned twice.
+  int reads = disk_manager->GetNumReads();
+  std::vector<page_id_t> page_ids = {3, 15, 1, 3, 2};
+  std::vector<Page *> pages;
+  bpm->FetchPages(page_ids, &pages);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(page_ids[i], std::atoi(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[0], pages[3]);
+  EXPECT_EQ(2, pages[0]->GetPinCount());
+  EXPECT_EQ(reads + 3, disk_manager->GetNumReads());
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(3, stats.misses_);
+  EXPECT_EQ(1, stats.hits_);
+
+  // Scenario: the batched pages are pinned like fetched pages, so a batch larger than the rest of the pool comes
+  // back partially filled.
+  std::vector<page_id_t> more_page_ids;
+  for (page_id_t page_id = 4; page_id < 14; ++page_id) {
+    more_page_ids.push_back(page_id);
+  }
+  std::vector<Page *> more_pages;
+  bpm->FetchPages(more_page_ids, &more_pages);
+  ASSERT_EQ(more_page_ids.size(), more_pages.size());
+  size_t fetched = 0;
+  for (size_t i = 0; i < more_pages.size(); ++i) {
+    if (more_pages[i] != nullptr) {
+      EXPECT_EQ(more_page_ids[i], std::atoi(more_pages[i]->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(more_page_ids[i], false));
+      fetched++;
+    }
+  }
+  EXPECT_EQ(buffer_pool_size - 4, fetched);
+
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  EXPECT_EQ(0, pages[0]->GetPinCount());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizePoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_FALSE(bpm->ResizePool(0));
+  EXPECT_FALSE(bpm->ResizePool(bpm->GetCapacity() + 1));
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+  }
+
+  // Scenario: shrinking a pool whose pages are all pinned releases the frames as the pages are unpinned.
+  EXPECT_TRUE(bpm->ResizePool(5));
+  EXPECT_EQ(5, bpm->GetPoolSize());
+  int writes = disk_manager->GetNumWrites();
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(writes + 5, disk_manager->GetNumWrites());
+
+  // Scenario: once the pool is down to its new size, unpinned pages are evicted as usual.
+  EXPECT_EQ(true, bpm->UnpinPage(5, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: growing hands out free frames right away.
+  EXPECT_TRUE(bpm->ResizePool(20));
+  std::vector<page_id_t> new_pages;
+  for (size_t i = 0; i < 15; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    new_pages.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: pages whose frames were released are read back from disk.
+  for (page_id_t page_id : new_pages) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 0; page_id < 6; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::atoi(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ChecksumFailureTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: page 0 was evicted and then torn on disk. Fetching it fails, and the frame stays usable.
+  {
+    std::fstream file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(PAGE_SIZE / 2);
+    file.write("torn", 4);
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+  std::vector<Page *> pages;
+  bpm->FetchPages({0, 1}, &pages);
+  EXPECT_EQ(nullptr, pages[0]);
+  ASSERT_NE(nullptr, pages[1]);
+  EXPECT_EQ(1, std::atoi(pages[1]->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(2, disk_manager->GetNumChecksumFailures());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.crc");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushFailureTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  EXPECT_EQ(true, bpm->FlushPage(page_id));
+  EXPECT_FALSE(page->IsDirty());
+
+  // Scenario: the write fails, here on a closed file; the page stays dirty so that its changes are not lost.
+  page = bpm->FetchPage(page_id);
+  snprintf(page->GetData(), PAGE_SIZE, "World");
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  disk_manager->ShutDown();
+  EXPECT_EQ(false, bpm->FlushPage(page_id));
+  EXPECT_TRUE(page->IsDirty());
+
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, EvictionTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(1, disk_manager, log_manager);
+
+  // Scenario: the only page to evict has a change whose log record is not yet persistent. The log goes first.
+  enable_logging = true;
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData() + 64, PAGE_SIZE - 64, "Hello");
+  LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::BEGIN_CHECKPOINT);
+  page->SetLSN(log_manager->AppendLogRecord(&log_record));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  EXPECT_LT(log_manager->GetPersistentLSN(), page->GetLSN());
+  page_id_t new_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  EXPECT_EQ(log_record.GetLSN(), log_manager->GetPersistentLSN());
+  EXPECT_EQ(true, bpm->UnpinPage(new_page_id, true));
+  enable_logging = false;
+
+  // Scenario: writing back the victim fails. It stays resident, with its change, instead of making room.
+  page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("Hello", std::string(page->GetData() + 64));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  disk_manager->ShutDown();
+  EXPECT_EQ(nullptr, bpm->NewPage(&new_page_id));
+  page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_EQ("Hello", std::string(page->GetData() + 64));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  remove("test.db");
+  remove("test.log");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushWhileLatchedTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(3, disk_manager);
+
+  // Scenario: a B+ tree split holds the write latch of a page and allocates a new one, while a checkpoint flushes the
+  // page. The flush waits for the page latch without holding up the allocation.
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  page->WLatch();
+  snprintf(page->GetData(), PAGE_SIZE, "Hello");
+  std::thread flusher([bpm, page_id] { EXPECT_EQ(true, bpm->FlushPage(page_id)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  page_id_t new_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(new_page_id, false));
+  page->WUnlatch();
+  flusher.join();
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/frame_arena.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, LayoutTest) {
+  // A small arena is not rounded up to a huge page.
+  FrameArena small_arena(3);
+  EXPECT_FALSE(small_arena.IsHugePageBacked());
+  EXPECT_EQ(small_arena.GetFrame(0) + 2 * PAGE_SIZE, small_arena.GetFrame(2));
+
+  // A large arena starts on a huge page boundary so that it can be backed by huge pages.
+  const size_t num_frames = 3 * HUGE_PAGE_SIZE / PAGE_SIZE + 1;
+  FrameArena arena(num_frames);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(0)) % HUGE_PAGE_SIZE);
+  EXPECT_EQ(FrameArena::ANY_NUMA_NODE, arena.GetNumaNode());
+
+  // The frames are zeroed and writable up to the last byte.
+  char *last = arena.GetFrame(num_frames - 1);
+  for (size_t i = 0; i < PAGE_SIZE; ++i) {
+    ASSERT_EQ(0, last[i]);
+  }
+  memset(last, 'x', PAGE_SIZE);
+  EXPECT_EQ('x', last[PAGE_SIZE - 1]);
+
+  // Binding to a node is a hint: node 0 always exists.
+  FrameArena bound_arena(num_frames, 0);
+  memset(bound_arena.GetFrame(0), 'y', PAGE_SIZE);
+  EXPECT_GE(FrameArena::NumNumaNodes(), 1);
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolLayoutTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Page data is laid out back to back in the arena, apart from the page bookkeeping.
+  Page *pages = bpm->GetPages();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(bpm->GetFrameArena()->GetFrame(static_cast<frame_id_t>(i)), pages[i].GetData());
+  }
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  // Evict everything and read it back through the arena.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  delete bpm;
+
+  // A NUMA-bound parallel pool behaves like an unbound one, whether or not this host has several nodes.
+  auto *parallel_bpm = new ParallelBufferPoolManager(4, buffer_pool_size, disk_manager, nullptr, true);
+  Page *page = parallel_bpm->FetchPage(3);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 3", std::string(page->GetData()));
+  EXPECT_EQ(true, parallel_bpm->UnpinPage(3, false));
+  delete parallel_bpm;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
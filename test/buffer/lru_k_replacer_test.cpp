@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Each has a single reference.
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(2);
+  lru_replacer.Unpin(3);
+  lru_replacer.Unpin(4);
+  lru_replacer.Unpin(5);
+  lru_replacer.Unpin(6);
+  lru_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_replacer.Size());
+
+  // Scenario: reference frame 1 a second time. It now has a finite backward 2-distance and is evicted last.
+  lru_replacer.Pin(1);
+  lru_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_replacer.Size());
+
+  int value;
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pinned frames cannot be victimized. Pinning 3 has no effect since it has been victimized.
+  lru_replacer.Pin(3);
+  lru_replacer.Pin(4);
+  EXPECT_EQ(3, lru_replacer.Size());
+
+  // Scenario: unpin 4. It now has two references, older than those of frame 1.
+  lru_replacer.Unpin(4);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(0, lru_replacer.Size());
+  EXPECT_FALSE(lru_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_replacer(4, 2, 2);
+
+  // Scenario: frame 1 is re-pinned right after being loaded. The second reference is correlated and not counted.
+  lru_replacer.Unpin(1);
+  lru_replacer.Pin(1);
+  lru_replacer.Unpin(1);
+
+  // Scenario: frame 2 is referenced twice, far enough apart.
+  lru_replacer.Unpin(2);
+  lru_replacer.Unpin(3);
+  lru_replacer.Pin(3);
+  lru_replacer.Pin(3);
+  lru_replacer.Unpin(3);
+  lru_replacer.Pin(2);
+  lru_replacer.Unpin(2);
+
+  // Frame 1 and 3 still have a single uncorrelated reference, frame 2 has two.
+  int value;
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, PrefetchTest) {
+  LRUKReplacer lru_replacer(4, 2);
+
+  // Scenario: frame 1 is loaded and referenced once, frame 2 is prefetched and then referenced once.
+  lru_replacer.Unpin(1);
+  lru_replacer.AddPrefetched(2);
+  EXPECT_EQ(2, lru_replacer.Size());
+  lru_replacer.Pin(2);
+  lru_replacer.Unpin(2);
+
+  // Scenario: frame 3 is referenced twice. The prefetch of frame 2 does not count as a reference.
+  lru_replacer.Unpin(3);
+  lru_replacer.Pin(3);
+  lru_replacer.Unpin(3);
+
+  int value;
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+}
+
+TEST(LRUKReplacerTest, RemoveTest) {
+  LRUKReplacer lru_replacer(4, 2);
+
+  // Scenario: frame 1 is referenced twice and frame 2 once, then the page in frame 1 is deleted.
+  lru_replacer.Unpin(1);
+  lru_replacer.Pin(1);
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(2);
+  lru_replacer.Remove(1);
+  EXPECT_EQ(1, lru_replacer.Size());
+
+  // Scenario: frame 1 takes a new page, referenced once like frame 3 after it. It starts without the old references.
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(3);
+
+  int value;
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+}
+
+/**
+ * Replays a page reference trace against a replacer managing pool_size frames and returns the hit ratio. A hit pins
+ * and unpins the frame; a miss loads the page into a free frame or a victim and then unpins it.
+ */
+static auto ReplayTrace(Replacer *replacer, size_t pool_size, const std::vector<page_id_t> &trace) -> double {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frames(pool_size, INVALID_PAGE_ID);
+  size_t next_free = 0;
+  size_t hits = 0;
+  for (page_id_t page_id : trace) {
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      hits++;
+      replacer->Pin(it->second);
+      replacer->Unpin(it->second);
+      continue;
+    }
+    frame_id_t frame_id;
+    if (next_free < pool_size) {
+      frame_id = static_cast<frame_id_t>(next_free++);
+    } else {
+      EXPECT_TRUE(replacer->Victim(&frame_id));
+      page_table.erase(frames[frame_id]);
+    }
+    frames[frame_id] = page_id;
+    page_table[page_id] = frame_id;
+    replacer->Unpin(frame_id);
+  }
+  return static_cast<double>(hits) / static_cast<double>(trace.size());
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceHitRatioTest) {
+  const size_t pool_size = 64;
+  const int hot_pages = 48;
+  const int scan_pages = 4096;
+  const int num_references = 50000;
+
+  // Mixed trace: point lookups over a hot set that fits in the pool, interleaved with a sequential scan over a table
+  // much larger than the pool.
+  std::default_random_engine rng(15445);
+  std::uniform_int_distribution<int> hot_dist(0, hot_pages - 1);
+  std::vector<page_id_t> trace;
+  int scan_cursor = 0;
+  for (int i = 0; i < num_references; ++i) {
+    if (i % 2 == 0) {
+      trace.push_back(hot_dist(rng));
+    } else {
+      trace.push_back(hot_pages + scan_cursor);
+      scan_cursor = (scan_cursor + 1) % scan_pages;
+    }
+  }
+
+  LRUReplacer lru_replacer(pool_size);
+  ClockReplacer clock_replacer(pool_size);
+  LRUKReplacer lru_k_replacer(pool_size, 2);
+  double lru_hit_ratio = ReplayTrace(&lru_replacer, pool_size, trace);
+  double clock_hit_ratio = ReplayTrace(&clock_replacer, pool_size, trace);
+  double lru_k_hit_ratio = ReplayTrace(&lru_k_replacer, pool_size, trace);
+  printf("hit ratio on scan + point lookup trace: LRU %.3f, Clock %.3f, LRU-2 %.3f\n", lru_hit_ratio, clock_hit_ratio,
+         lru_k_hit_ratio);
+
+  // Every point lookup should hit once the hot set is warm; the scan never hits.
+  EXPECT_GT(lru_k_hit_ratio, 0.45);
+  EXPECT_GT(lru_k_hit_ratio, lru_hit_ratio);
+  EXPECT_GT(lru_k_hit_ratio, clock_hit_ratio);
+}
+
+}  // namespace bustub
@@ -11,9 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -21,7 +25,7 @@ namespace bustub {
 
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(ParallelBufferPoolManagerTest, DISABLED_BinaryDataTest) {
+TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
   const size_t num_instances = 5;
@@ -88,7 +92,7 @@ TEST(ParallelBufferPoolManagerTest, DISABLED_BinaryDataTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(ParallelBufferPoolManagerTest, DISABLED_SampleTest) {
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
   const size_t num_instances = 5;
@@ -151,4 +155,208 @@ TEST(ParallelBufferPoolManagerTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Pages 0 and 2 land on instance 0, pages 1 and 3 on instance 1.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Two hits on instance 1.
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(1));
+    EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  }
+
+  // Instance 0 evicts a dirty page to make room for a fresh one, and then misses when the victim is read back.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, page_id_temp % num_instances);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  auto instance_stats = bpm->GetInstanceStats();
+  ASSERT_EQ(num_instances, instance_stats.size());
+  EXPECT_EQ(0, instance_stats[0].hits_);
+  EXPECT_EQ(1, instance_stats[0].misses_);
+  EXPECT_EQ(2, instance_stats[0].evictions_);
+  EXPECT_EQ(2, instance_stats[0].foreground_writes_);
+  EXPECT_EQ(2, instance_stats[1].hits_);
+  EXPECT_EQ(0, instance_stats[1].misses_);
+  EXPECT_EQ(0, instance_stats[1].evictions_);
+
+  BufferPoolStats sum;
+  for (const auto &stats : instance_stats) {
+    sum += stats;
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(sum.hits_, stats.hits_);
+  EXPECT_EQ(sum.misses_, stats.misses_);
+  EXPECT_EQ(sum.evictions_, stats.evictions_);
+  EXPECT_EQ(sum.foreground_writes_, stats.foreground_writes_);
+  EXPECT_DOUBLE_EQ(2.0 / 3.0, stats.HitRatio());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: the batch is split over the instances and the results come back in request order.
+  int reads = disk_manager->GetNumReads();
+  std::vector<page_id_t> page_ids = {7, 0, 5, 23, 1, 2};
+  std::vector<Page *> pages;
+  bpm->FetchPages(page_ids, &pages);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], std::atoi(pages[i]->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  EXPECT_EQ(reads + 5, disk_manager->GetNumReads());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+  }
+
+  // Scenario: the frames are spread evenly over the instances.
+  EXPECT_FALSE(bpm->ResizePool(1));
+  EXPECT_TRUE(bpm->ResizePool(15));
+  EXPECT_EQ(15, bpm->GetPoolSize());
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: instances can only be added or removed once every page is unpinned.
+  EXPECT_FALSE(bpm->SetNumInstances(3));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * num_instances); ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_TRUE(bpm->SetNumInstances(3));
+  EXPECT_EQ(3, bpm->GetNumInstances());
+  EXPECT_EQ(15, bpm->GetPoolSize());
+
+  // Scenario: the pages are now served by other instances, and new pages do not reuse old page ids.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * num_instances); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::atoi(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_GT(page_id_temp, static_cast<page_id_t>(buffer_pool_size * num_instances));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  EXPECT_TRUE(bpm->SetNumInstances(1));
+  auto *page = bpm->FetchPage(7);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(7, std::atoi(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(7, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentResizeTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, 10, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: pages are fetched while the instances are rebuilt; every fetch sees the old or the new instances.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; ++t) {
+    threads.emplace_back([&bpm, &done, t] {
+      for (int i = t; !done; i = (i + 1) % num_pages) {
+        auto *page = bpm->FetchPage(i);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(i, std::atoi(page->GetData()));
+        EXPECT_EQ(true, bpm->UnpinPage(i, false));
+        // Leave the rebuild moments without pinned pages.
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+      }
+    });
+  }
+  int num_resizes = 0;
+  for (size_t num_instances = 1; num_resizes < 20; num_instances = num_instances % 4 + 1) {
+    // A page pinned by a reader holds the rebuild off until it is unpinned.
+    if (bpm->SetNumInstances(num_instances)) {
+      num_resizes++;
+      EXPECT_EQ(num_instances, bpm->GetNumInstances());
+    }
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -688,4 +688,58 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+// Integer keys get a comparator that reads the key bytes directly; other keys keep the one they asked for
+TEST(CatalogTest, CreateIndexComparatorTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  std::vector<Column> columns{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}, {"C", TypeId::BIGINT}};
+  Schema table_schema{columns};
+  EXPECT_NE(Catalog::NULL_TABLE_INFO, catalog->CreateTable(nullptr, table_name, table_schema));
+
+  std::vector<Column> pair_columns{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}};
+  Schema pair_schema{pair_columns};
+  auto *pair_index = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn.get(), "index1", table_name, table_schema, pair_schema, {0, 1}, 8, HashFunction<GenericKey<8>>{});
+  EXPECT_NE(nullptr, (dynamic_cast<ExtendibleHashTableIndex<GenericKey<8>, RID, IntegerComparator<8, int32_t, 2>> *>(
+                         pair_index->index_.get())));
+
+  std::vector<Column> bigint_columns{{"C", TypeId::BIGINT}};
+  Schema bigint_schema{bigint_columns};
+  auto *bigint_index = catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      txn.get(), "index2", table_name, table_schema, bigint_schema, {2}, 16, HashFunction<GenericKey<16>>{});
+  EXPECT_NE(nullptr, (dynamic_cast<ExtendibleHashTableIndex<GenericKey<16>, RID, IntegerComparator<16, int64_t>> *>(
+                         bigint_index->index_.get())));
+
+  std::vector<Column> mixed_columns{{"A", TypeId::INTEGER}, {"C", TypeId::BIGINT}};
+  Schema mixed_schema{mixed_columns};
+  auto *mixed_index = catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      txn.get(), "index3", table_name, table_schema, mixed_schema, {0, 2}, 16, HashFunction<GenericKey<16>>{});
+  EXPECT_NE(nullptr, (dynamic_cast<ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>> *>(
+                         mixed_index->index_.get())));
+
+  // Duplicate keys keep posting lists, which only B+ trees of key and value pairs have.
+  auto *non_unique_index = catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      txn.get(), "index4", table_name, table_schema, bigint_schema, {2}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::BPlusTree, false);
+  auto *tree_index =
+      dynamic_cast<BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>> *>(non_unique_index->index_.get());
+  ASSERT_NE(nullptr, tree_index);
+  std::vector<Value> values{ValueFactory::GetBigIntValue(7)};
+  Tuple key{values, &bigint_schema};
+  tree_index->InsertEntry(key, RID(1, 0), txn.get());
+  tree_index->InsertEntry(key, RID(1, 1), txn.get());
+  tree_index->InsertEntry(key, RID(2, 0), txn.get());
+  tree_index->DeleteEntry(key, RID(1, 1), txn.get());
+  std::vector<RID> results;
+  tree_index->ScanKey(key, &results, txn.get());
+  EXPECT_EQ((std::vector<RID>{RID(1, 0), RID(2, 0)}), results);
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util_test.cpp
+//
+// Identification: test/common/crc32c_util_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "common/util/crc32c_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cUtilTest, KnownValuesTest) {
+  // Check values from RFC 3720, appendix B.4.
+  const char *digits = "123456789";
+  EXPECT_EQ(0xE3069283, Crc32cUtil::Crc32c(digits, strlen(digits)));
+  EXPECT_EQ(0xE3069283, Crc32cUtil::Crc32cSoftware(digits, strlen(digits)));
+
+  std::vector<char> zeros(32, 0);
+  EXPECT_EQ(0x8A9136AA, Crc32cUtil::Crc32c(zeros.data(), zeros.size()));
+  std::vector<char> ones(32, static_cast<char>(0xFF));
+  EXPECT_EQ(0x62A8AB43, Crc32cUtil::Crc32cSoftware(ones.data(), ones.size()));
+  EXPECT_EQ(0, Crc32cUtil::Crc32c(nullptr, 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cUtilTest, HardwareMatchesSoftwareTest) {
+  std::mt19937 generator(15445);
+  std::vector<char> data(1000);
+  for (auto &byte : data) {
+    byte = static_cast<char>(generator());
+  }
+  // Every length and alignment, also checksumming piece by piece.
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t length = 0; length + offset <= data.size(); length += 37) {
+      uint32_t crc = Crc32cUtil::Crc32cSoftware(data.data() + offset, length);
+      EXPECT_EQ(crc, Crc32cUtil::Crc32c(data.data() + offset, length));
+      uint32_t first_half = Crc32cUtil::Crc32c(data.data() + offset, length / 2);
+      EXPECT_EQ(crc, Crc32cUtil::Crc32c(data.data() + offset + length / 2, length - length / 2, first_half));
+    }
+  }
+}
+
+}  // namespace bustub
@@ -31,6 +31,7 @@
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/update_plan.h"
@@ -110,6 +111,62 @@ TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
   }
 }
 
+// SELECT col_a, col_b FROM test_1 WHERE col_a < 500 ORDER BY col_a DESC, through a B+ tree index on col_a
+TEST_F(ExecutorTest, IndexScanRangeTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("a integer");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{}, IndexType::BPlusTree);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  IndexScanPlanNode reverse_plan{out_schema, MakeComparisonExpression(col_a, const500, ComparisonType::LessThan),
+                                 index_info->index_oid_, true};
+
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&reverse_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 500);
+  for (int32_t i = 0; i < static_cast<int32_t>(result_set.size()); i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 499 - i);
+    ASSERT_TRUE(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>() < 10);
+  }
+
+  // SELECT col_a, col_b FROM test_1 WHERE 990 <= col_a, with the constant on the left
+  auto *const990 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(990));
+  IndexScanPlanNode forward_plan{
+      out_schema, MakeComparisonExpression(const990, col_a, ComparisonType::LessThanOrEqual), index_info->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&forward_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 10);
+  for (int32_t i = 0; i < static_cast<int32_t>(result_set.size()); i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 990 + i);
+  }
+
+  // SELECT col_a, col_b FROM test_1 WHERE col_a < 3.5, whose bound the integer key cannot hold exactly
+  auto *const3_5 = MakeConstantValueExpression(ValueFactory::GetDecimalValue(3.5));
+  IndexScanPlanNode fractional_high_plan{
+      out_schema, MakeComparisonExpression(col_a, const3_5, ComparisonType::LessThan), index_info->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&fractional_high_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 4);
+  for (int32_t i = 0; i < static_cast<int32_t>(result_set.size()); i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), i);
+  }
+
+  // SELECT col_a, col_b FROM test_1 WHERE col_a > -0.5, which takes col_a = 0 too
+  auto *const_neg0_5 = MakeConstantValueExpression(ValueFactory::GetDecimalValue(-0.5));
+  IndexScanPlanNode fractional_low_plan{
+      out_schema, MakeComparisonExpression(col_a, const_neg0_5, ComparisonType::GreaterThan), index_info->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&fractional_low_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 0);
+}
+
 // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
 TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
   // Create Values to insert
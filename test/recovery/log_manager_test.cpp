@@ -0,0 +1,192 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <future>  // NOLINT
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "recovery/log_recovery.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, WaitForFlushTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+
+  // Scenario: without a flush thread, waiting flushes in the calling thread.
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  lsn_t lsn = log_manager.AppendLogRecord(&begin);
+  EXPECT_EQ(0, lsn);
+  EXPECT_EQ(INVALID_LSN, log_manager.GetPersistentLSN());
+  log_manager.WaitForFlush(lsn).get();
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+  EXPECT_EQ(1, disk_manager.GetNumFlushes());
+
+  // Scenario: with the flush thread, a waiter does not have to wait for the timeout.
+  log_timeout = std::chrono::seconds(15);
+  log_manager.RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+  LogRecord commit(0, lsn, LogRecordType::COMMIT);
+  lsn = log_manager.AppendLogRecord(&commit);
+  auto start = std::chrono::steady_clock::now();
+  log_manager.WaitForFlush(lsn).get();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+
+  // Scenario: waiting for a persistent record returns at once, and stopping the thread flushes what is left.
+  EXPECT_EQ(std::future_status::ready, log_manager.WaitForFlush(0).wait_for(std::chrono::seconds(0)));
+  LogRecord abort(1, INVALID_LSN, LogRecordType::ABORT);
+  lsn = log_manager.AppendLogRecord(&abort);
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+  log_timeout = std::chrono::seconds(1);
+
+  // The log file holds the three records back to back.
+  char buf[64];
+  EXPECT_TRUE(disk_manager.ReadLog(buf, sizeof(buf), 0));
+  LogRecovery log_recovery(&disk_manager, nullptr, 1);
+  int offset = 0;
+  for (int i = 0; i < 3; ++i) {
+    LogRecord log_record;
+    ASSERT_TRUE(log_recovery.DeserializeLogRecord(buf + offset, &log_record));
+    EXPECT_EQ(i, log_record.GetLSN());
+    offset += log_record.GetSize();
+  }
+  EXPECT_EQ(begin.GetSize() + commit.GetSize() + abort.GetSize(), offset);
+  EXPECT_FALSE(disk_manager.ReadLog(buf, sizeof(buf), offset));
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  const int records_per_thread = 20000;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+
+  // Scenario: many threads append at once, filling the log buffer many times over.
+  for (int num_threads : {1, 2, 4, 8}) {
+    lsn_t first_lsn = log_manager.GetNextLSN();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&log_manager, t] {
+        for (int i = 0; i < records_per_thread; ++i) {
+          LogRecord log_record(t, INVALID_LSN, LogRecordType::BEGIN);
+          log_manager.AppendLogRecord(&log_record);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(first_lsn + num_threads * records_per_thread, log_manager.GetNextLSN());
+    std::cout << num_threads << " appenders: " << num_threads * records_per_thread / elapsed << " records/s"
+              << std::endl;
+  }
+  log_manager.Flush();
+  EXPECT_EQ(log_manager.GetNextLSN() - 1, log_manager.GetPersistentLSN());
+  log_manager.StopFlushThread();
+
+  // Every record made it to the log exactly once, in LSN order, with its header intact. Records are all the same
+  // size, so none straddles the end of the buffer read.
+  const int record_size = LogRecord(0, INVALID_LSN, LogRecordType::BEGIN).GetSize();
+  std::vector<char> log(LOG_BUFFER_SIZE);
+  LogRecovery log_recovery(&disk_manager, nullptr, 1);
+  lsn_t expected_lsn = 0;
+  int offset = 0;
+  while (disk_manager.ReadLog(log.data(), LOG_BUFFER_SIZE, offset)) {
+    int pos = 0;
+    LogRecord log_record;
+    while (pos + record_size <= LOG_BUFFER_SIZE &&
+           log_recovery.DeserializeLogRecord(log.data() + pos, &log_record)) {
+      ASSERT_EQ(expected_lsn, log_record.GetLSN());
+      ASSERT_TRUE(log_record.GetTxnId() >= 0 && log_record.GetTxnId() < 8);
+      expected_lsn++;
+      pos += log_record.GetSize();
+    }
+    if (pos == 0) {
+      break;
+    }
+    offset += pos;
+  }
+  EXPECT_EQ(log_manager.GetNextLSN(), expected_lsn);
+  disk_manager.ShutDown();
+}
+
+// A benchmark rather than a test; run it with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, DISABLED_GroupCommitBenchmark) {
+  const int commits_per_thread = 50;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  log_manager.RunFlushThread();
+
+  for (int num_threads : {1, 2, 4, 8, 16}) {
+    int flushes_before = disk_manager.GetNumFlushes();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&txn_manager] {
+        for (int i = 0; i < commits_per_thread; ++i) {
+          Transaction *txn = txn_manager.Begin();
+          txn_manager.Commit(txn);
+          delete txn;
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int commits = num_threads * commits_per_thread;
+    int flushes = disk_manager.GetNumFlushes() - flushes_before;
+
+    // Every commit returned only after its record was persistent, and commits shared flushes.
+    EXPECT_EQ(log_manager.GetNextLSN() - 1, log_manager.GetPersistentLSN());
+    EXPECT_LE(flushes, commits);
+    std::cout << num_threads << " committers: " << commits / elapsed << " commits/s, "
+              << static_cast<double>(commits) / flushes << " commits per flush" << std::endl;
+  }
+
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
@@ -10,9 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <iostream>
 #include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -100,7 +102,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -152,7 +154,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -203,7 +205,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -245,7 +247,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -288,7 +290,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -333,4 +335,77 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+// A benchmark rather than a test; run it with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, DISABLED_ReadScalingBenchmark) {
+  const int64_t num_keys = 20000;
+  const int lookups_per_thread = 5000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // Every reader pins up to two pages at a time.
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  for (int num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    // Readers look up the even keys while a writer inserts and removes odd ones, splitting and merging leaves.
+    std::atomic<bool> done = false;
+    std::thread writer([&tree, &done] {
+      GenericKey<8> index_key;
+      RID rid;
+      for (int64_t i = 0; !done; ++i) {
+        index_key.SetFromInteger(1 + 2 * (i % (num_keys / 2)));
+        if ((i / (num_keys / 2)) % 2 == 0) {
+          tree.Insert(index_key, rid);
+        } else {
+          tree.Remove(index_key);
+        }
+      }
+    });
+
+    std::atomic<int> missing = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> readers;
+    for (int t = 0; t < num_threads; ++t) {
+      readers.emplace_back([&tree, &keys, &missing, t] {
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        for (int i = 0; i < lookups_per_thread; ++i) {
+          int64_t key = keys[(static_cast<size_t>(i) * 7919 + t) % keys.size()];
+          index_key.SetFromInteger(key);
+          rids.clear();
+          if (!tree.GetValue(index_key, &rids) || rids[0].GetSlotNum() != static_cast<uint32_t>(key)) {
+            missing++;
+          }
+        }
+      });
+    }
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    done = true;
+    writer.join();
+
+    EXPECT_EQ(missing, 0);
+    std::cout << num_threads << " readers: " << num_threads * lookups_per_thread / elapsed << " lookups/s"
+              << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
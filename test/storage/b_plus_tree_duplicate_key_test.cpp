@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_duplicate_key_test.cpp
+//
+// Identification: test/storage/b_plus_tree_duplicate_key_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+auto RidLess(const RID &a, const RID &b) -> bool { return a.Get() < b.Get(); }
+
+/**
+ * Most keys get a few values, every tenth a list too long for a leaf, and key 0 one that takes several overflow pages.
+ */
+auto MakePairs(int64_t num_keys) -> std::vector<std::pair<int64_t, RID>> {
+  std::vector<std::pair<int64_t, RID>> pairs;
+  for (int64_t key = 0; key < num_keys; key++) {
+    int count = key == 0 ? 1200 : key % 10 == 5 ? 70 : static_cast<int>(key % 4) + 1;
+    for (int i = 0; i < count; i++) {
+      pairs.emplace_back(key, RID(i, static_cast<uint32_t>(key)));
+    }
+  }
+  return pairs;
+}
+
+void CheckTree(Tree *tree, std::map<int64_t, std::vector<RID>> expected, int64_t num_keys) {
+  GenericKey<8> index_key;
+  std::vector<std::pair<int64_t, RID>> sorted_pairs;
+  for (int64_t key = 0; key < num_keys; key++) {
+    auto &values = expected[key];
+    std::sort(values.begin(), values.end(), RidLess);
+    index_key.SetFromInteger(key);
+    std::vector<RID> rids;
+    ASSERT_EQ(!values.empty(), tree->GetValue(index_key, &rids)) << "key " << key;
+    ASSERT_EQ(values, rids) << "key " << key;
+    for (const RID &rid : values) {
+      sorted_pairs.emplace_back(key, rid);
+    }
+  }
+
+  std::vector<std::pair<int64_t, RID>> actual;
+  for (auto iter = tree->Begin(); !iter.IsEnd(); ++iter) {
+    actual.emplace_back((*iter).first.ToString(), (*iter).second);
+  }
+  ASSERT_EQ(sorted_pairs, actual);
+  actual.clear();
+  for (auto iter = tree->RBegin(); !iter.IsEnd(); ++iter) {
+    actual.emplace_back((*iter).first.ToString(), (*iter).second);
+  }
+  std::reverse(actual.begin(), actual.end());
+  ASSERT_EQ(sorted_pairs, actual);
+}
+
+void RunDuplicateKeyTest(int leaf_max_size, int internal_max_size) {
+  const int64_t num_keys = 300;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  Tree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size, nullptr, false);
+
+  auto pairs = MakePairs(num_keys);
+  std::shuffle(pairs.begin(), pairs.end(), std::mt19937(15445));
+  std::map<int64_t, std::vector<RID>> expected;
+  GenericKey<8> index_key;
+  for (const auto &[key, rid] : pairs) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, rid));
+    expected[key].push_back(rid);
+  }
+  // A key takes each value once.
+  for (int64_t key : {0, 1, 5, 7}) {
+    index_key.SetFromInteger(key);
+    ASSERT_FALSE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key))));
+  }
+  CheckTree(&tree, expected, num_keys);
+
+  // Lists shrink value by value, and the long ones move back into their leaves.
+  for (auto &[key, values] : expected) {
+    index_key.SetFromInteger(key);
+    std::vector<RID> remaining;
+    for (size_t i = 0; i < values.size(); i++) {
+      if (key != 0 && i % 4 != 0) {
+        tree.Remove(index_key, values[i]);
+      } else {
+        remaining.push_back(values[i]);
+      }
+    }
+    tree.Remove(index_key, RID(5000, 0));
+    values = remaining;
+  }
+  CheckTree(&tree, expected, num_keys);
+
+  // Removing a key takes every value with it, overflow pages included.
+  for (auto &[key, values] : expected) {
+    if (key % 3 == 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+      values.clear();
+    }
+  }
+  CheckTree(&tree, expected, num_keys);
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace
+
+TEST(BPlusTreeDuplicateKeyTest, PostingListTest) {
+  RunDuplicateKeyTest(3, 4);
+  RunDuplicateKeyTest((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>),
+                      (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>));
+}
+
+TEST(BPlusTreeDuplicateKeyTest, BulkLoadTest) {
+  const int64_t num_keys = 300;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto pairs = MakePairs(num_keys);
+  std::map<int64_t, std::vector<RID>> expected;
+  for (const auto &[key, rid] : pairs) {
+    expected[key].push_back(rid);
+  }
+
+  // Sorted input loads in one pass, shuffled input through runs that keep the values of a key together.
+  for (bool shuffled : {false, true}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    Tree tree("foo_pk", bpm, comparator, 20, 4, nullptr, false);
+
+    std::vector<std::pair<GenericKey<8>, RID>> input;
+    for (const auto &[key, rid] : pairs) {
+      GenericKey<8> index_key;
+      index_key.SetFromInteger(key);
+      input.emplace_back(index_key, rid);
+    }
+    if (shuffled) {
+      std::shuffle(input.begin(), input.end(), std::mt19937(15445));
+    }
+    ASSERT_TRUE(tree.BulkLoad(input.begin(), input.end(), 0.7));
+    CheckTree(&tree, expected, num_keys);
+
+    // The loaded tree takes more values like any other.
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(1);
+    ASSERT_TRUE(tree.Insert(index_key, RID(7, 1)));
+    expected[1].push_back(RID(7, 1));
+    CheckTree(&tree, expected, num_keys);
+    expected[1].pop_back();
+
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(BPlusTreeDuplicateKeyTest, SplitKeyTreesAreUniqueTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  IntegerComparator<8, int64_t> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  EXPECT_THROW((BPlusTree<GenericKey<8>, RID, IntegerComparator<8, int64_t>>("foo_pk", bpm, comparator, 3, 4,
+                                                                             nullptr, false)),
+               Exception);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
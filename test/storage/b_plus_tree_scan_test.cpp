@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_scan_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+using Bound = std::optional<IndexKeyBound<GenericKey<8>>>;
+
+auto MakeBound(int64_t key, bool inclusive) -> Bound {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return IndexKeyBound<GenericKey<8>>{index_key, inclusive};
+}
+
+/** The keys a scan between the bounds should return, in the order it should return them. */
+auto ExpectedScan(const std::vector<int64_t> &sorted_keys, std::optional<int64_t> low, bool low_inclusive,
+                  std::optional<int64_t> high, bool high_inclusive, bool reverse) -> std::vector<int64_t> {
+  std::vector<int64_t> expected;
+  for (auto key : sorted_keys) {
+    if (low.has_value() && (key < *low || (key == *low && !low_inclusive))) {
+      continue;
+    }
+    if (high.has_value() && (key > *high || (key == *high && !high_inclusive))) {
+      continue;
+    }
+    expected.push_back(key);
+  }
+  if (reverse) {
+    std::reverse(expected.begin(), expected.end());
+  }
+  return expected;
+}
+
+template <typename KeyComparator>
+void CheckScans(BPlusTree<GenericKey<8>, RID, KeyComparator> *tree, const std::vector<int64_t> &sorted_keys) {
+  // Bounds on keys, between keys, and past either end, with every mix of open and inclusive ends.
+  int64_t max_key = sorted_keys.empty() ? 0 : sorted_keys.back();
+  std::vector<std::optional<int64_t>> bounds{std::nullopt, -1, 0, 1, 7, 8, max_key / 2, max_key - 1, max_key,
+                                             max_key + 1};
+  for (const auto &low : bounds) {
+    for (const auto &high : bounds) {
+      for (int flags = 0; flags < 8; flags++) {
+        bool low_inclusive = (flags & 1) != 0;
+        bool high_inclusive = (flags & 2) != 0;
+        bool reverse = (flags & 4) != 0;
+        auto expected = ExpectedScan(sorted_keys, low, low_inclusive, high, high_inclusive, reverse);
+        std::vector<int64_t> actual;
+        auto iter = tree->Scan(low.has_value() ? MakeBound(*low, low_inclusive) : std::nullopt,
+                               high.has_value() ? MakeBound(*high, high_inclusive) : std::nullopt, reverse);
+        for (; !iter.IsEnd(); ++iter) {
+          actual.push_back((*iter).second.GetSlotNum());
+        }
+        ASSERT_EQ(expected, actual) << "low " << low.value_or(-100) << (low_inclusive ? "]" : ")") << " high "
+                                    << high.value_or(-100) << (high_inclusive ? "]" : ")") << " reverse " << reverse;
+      }
+    }
+  }
+
+  std::vector<int64_t> actual;
+  for (auto iter = tree->RBegin(); !iter.IsEnd(); ++iter) {
+    actual.push_back((*iter).second.GetSlotNum());
+  }
+  ASSERT_EQ(ExpectedScan(sorted_keys, std::nullopt, true, std::nullopt, true, true), actual);
+  actual.clear();
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(max_key / 2 + 1);
+  for (auto iter = tree->RBegin(index_key); !iter.IsEnd(); ++iter) {
+    actual.push_back((*iter).second.GetSlotNum());
+  }
+  ASSERT_EQ(ExpectedScan(sorted_keys, std::nullopt, true, max_key / 2 + 1, true, true), actual);
+}
+
+template <typename KeyComparator>
+void RunScanTest(const KeyComparator &comparator, int leaf_max_size, int internal_max_size) {
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  BPlusTree<GenericKey<8>, RID, KeyComparator> tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+  CheckScans(&tree, {});
+
+  // Even keys only, so that odd bounds fall between two keys.
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 2000; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(key)));
+  }
+  std::vector<int64_t> sorted_keys = keys;
+  std::sort(sorted_keys.begin(), sorted_keys.end());
+  CheckScans(&tree, sorted_keys);
+
+  // Merges and redistributions must keep the leaves linked both ways.
+  std::vector<int64_t> remaining;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (i % 4 != 0) {
+      index_key.SetFromInteger(keys[i]);
+      tree.Remove(index_key);
+    } else {
+      remaining.push_back(keys[i]);
+    }
+  }
+  std::sort(remaining.begin(), remaining.end());
+  CheckScans(&tree, remaining);
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace
+
+TEST(BPlusTreeScanTest, RangeScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  RunScanTest(comparator, 3, 4);
+  RunScanTest(comparator, (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>),
+              (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>));
+}
+
+TEST(BPlusTreeScanTest, SplitKeyRangeScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  IntegerComparator<8, int64_t> comparator(key_schema.get());
+  RunScanTest(comparator, 3, 4);
+}
+
+}  // namespace bustub
@@ -0,0 +1,215 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_split_key_test.cpp
+//
+// Identification: test/storage/b_plus_tree_split_key_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/key_search.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+template <typename IntType>
+void CheckBounds(const std::vector<IntType> &keys, IntType key) {
+  auto size = static_cast<int>(keys.size());
+  auto lower = static_cast<int>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+  auto upper = static_cast<int>(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin());
+  ASSERT_EQ(lower, KeySearch::LowerBound(keys.data(), size, key));
+  ASSERT_EQ(lower, KeySearch::LowerBoundScalar(keys.data(), size, key));
+  ASSERT_EQ(upper, KeySearch::UpperBound(keys.data(), size, key));
+}
+
+template <typename IntType>
+void CheckBoundsForSizes() {
+  std::mt19937 generator(15445);
+  std::uniform_int_distribution<IntType> distribution(-1000, 1000);
+  for (int size = 0; size <= 600; size += size < 40 ? 1 : 37) {
+    std::vector<IntType> keys(size);
+    for (auto &key : keys) {
+      key = distribution(generator);
+    }
+    std::sort(keys.begin(), keys.end());
+    if (size > 1) {
+      keys.front() = std::numeric_limits<IntType>::min();
+      keys.back() = std::numeric_limits<IntType>::max();
+    }
+    for (IntType key = -1001; key <= 1001; key += 7) {
+      CheckBounds(keys, key);
+    }
+    CheckBounds(keys, std::numeric_limits<IntType>::min());
+    CheckBounds(keys, std::numeric_limits<IntType>::max());
+  }
+}
+
+template <typename KeyComparator>
+auto LookupsPerSecond(const KeyComparator &comparator, const std::vector<int64_t> &keys) -> double {
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  BPlusTree<GenericKey<8>, RID, KeyComparator> tree("foo_pk", bpm, comparator);
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+  }
+
+  const int num_lookups = 50000;
+  int missing = 0;
+  std::vector<RID> rids;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_lookups; ++i) {
+    index_key.SetFromInteger(keys[(static_cast<size_t>(i) * 7919) % keys.size()]);
+    rids.clear();
+    missing += tree.GetValue(index_key, &rids) ? 0 : 1;
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(0, missing);
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  return num_lookups / elapsed;
+}
+
+}  // namespace
+
+TEST(KeySearchTest, BoundsTest) {
+  CheckBoundsForSizes<int32_t>();
+  CheckBoundsForSizes<int64_t>();
+}
+
+TEST(BPlusTreeSplitKeyTest, InsertRemoveTest) {
+  const int64_t num_keys = 10000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  IntegerComparator<8, int64_t> comparator(key_schema.get());
+  // Small pages split and merge often; full ones fill every byte between the keys and the values.
+  using LayoutTraits = BPlusTreeLayoutTraits<GenericKey<8>, IntegerComparator<8, int64_t>>;
+  const int leaf_page_size =
+      LayoutTraits::MaxEntries(PAGE_SIZE - LEAF_PAGE_HEADER_SIZE, sizeof(std::pair<GenericKey<8>, RID>));
+  const int internal_page_size =
+      LayoutTraits::MaxEntries(PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE, sizeof(std::pair<GenericKey<8>, page_id_t>));
+  for (auto [leaf_max_size, internal_max_size] : {std::pair{3, 4}, std::pair{leaf_page_size, internal_page_size}}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    BPlusTree<GenericKey<8>, RID, IntegerComparator<8, int64_t>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                                       internal_max_size);
+
+    std::vector<int64_t> keys(num_keys);
+    for (int64_t i = 0; i < num_keys; i++) {
+      keys[i] = (i - num_keys / 2) * 7919;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.Insert(index_key, RID(key)));
+    }
+    index_key.SetFromInteger(keys[0]);
+    EXPECT_FALSE(tree.Insert(index_key, RID(0)));
+
+    for (auto key : keys) {
+      std::vector<RID> rids;
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(RID(key), rids[0]);
+      index_key.SetFromInteger(key + 1);
+      ASSERT_FALSE(tree.GetValue(index_key, &rids));
+    }
+
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (i % 3 != 0) {
+        index_key.SetFromInteger(keys[i]);
+        tree.Remove(index_key);
+      }
+    }
+    std::vector<int64_t> remaining;
+    for (size_t i = 0; i < keys.size(); i += 3) {
+      remaining.push_back(keys[i]);
+    }
+    std::sort(remaining.begin(), remaining.end());
+    size_t next = 0;
+    for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+      ASSERT_LT(next, remaining.size());
+      EXPECT_EQ(remaining[next], (*iter).first.ToString());
+      next++;
+    }
+    EXPECT_EQ(remaining.size(), next);
+
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// A benchmark rather than a test; run it with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BPlusTreeSplitKeyTest, DISABLED_KeySearchBenchmark) {
+  // Searching a full leaf's worth of keys, on its own.
+  const int page_keys = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(int64_t) + sizeof(RID));
+  std::vector<int64_t> page(page_keys);
+  for (int i = 0; i < page_keys; i++) {
+    page[i] = 2 * i;
+  }
+  const int num_searches = 500000;
+  int64_t checksum = 0;
+  auto time = [&](auto search) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_searches; ++i) {
+      checksum += search(static_cast<int64_t>((static_cast<size_t>(i) * 7919) % (2 * page_keys)));
+    }
+    return num_searches / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  auto std_rate = time([&](int64_t key) { return std::lower_bound(page.begin(), page.end(), key) - page.begin(); });
+  auto scalar_rate = time([&](int64_t key) { return KeySearch::LowerBoundScalar(page.data(), page_keys, key); });
+  auto simd_rate = time([&](int64_t key) { return KeySearch::LowerBound(page.data(), page_keys, key); });
+  EXPECT_GT(checksum, 0);
+  std::cout << page_keys << " keys, std::lower_bound: " << std_rate << " searches/s" << std::endl;
+  std::cout << page_keys << " keys, scalar window: " << scalar_rate << " searches/s" << std::endl;
+  std::cout << page_keys << " keys, " << (KeySearch::HasSimdSupport() ? "SIMD" : "scalar (no SIMD)")
+            << " window: " << simd_rate << " searches/s" << std::endl;
+
+  // Point lookups through a resident tree, with pairs of keys and values or with keys kept apart.
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 20000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  auto key_schema = ParseCreateStatement("a bigint");
+  auto generic_rate = LookupsPerSecond(GenericComparator<8>(key_schema.get()), keys);
+  auto integer_rate = LookupsPerSecond(IntegerComparator<8, int64_t>(key_schema.get()), keys);
+  std::cout << "GenericComparator<8> tree: " << generic_rate << " lookups/s" << std::endl;
+  std::cout << "IntegerComparator<8, int64_t> tree: " << integer_rate << " lookups/s" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,179 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_var_key_test.cpp
+//
+// Identification: test/storage/b_plus_tree_var_key_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+// Keys with a long common prefix and a shared suffix, as composite string keys tend to have.
+auto MakeKey(int64_t id) -> VarKey<64> {
+  char buffer[64];
+  int size = snprintf(buffer, sizeof(buffer), "tenant/acme/user/%010ld/profile", static_cast<long>(id));  // NOLINT
+  VarKey<64> key;
+  key.SetFromBytes(buffer, size);
+  return key;
+}
+
+}  // namespace
+
+TEST(VarKeyTest, OrderTest) {
+  auto key_schema = ParseCreateStatement("a integer,b varchar(16)");
+  VarKeyComparator<32> comparator(key_schema.get());
+  std::vector<std::pair<int32_t, std::string>> values{{-5, "zz"}, {-1, ""}, {0, "a"}, {0, "ab"},
+                                                      {0, "b"},   {7, "a"}, {300, ""}};
+  std::vector<VarKey<32>> keys;
+  for (const auto &[a, b] : values) {
+    std::vector<Value> row{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b)};
+    Tuple tuple(row, key_schema.get());
+    keys.emplace_back();
+    keys.back().SetFromKey(tuple, key_schema.get());
+  }
+  for (size_t i = 0; i + 1 < keys.size(); i++) {
+    EXPECT_LT(comparator(keys[i], keys[i + 1]), 0) << "values " << i << " and " << i + 1 << " are out of order";
+    EXPECT_GT(comparator(keys[i + 1], keys[i]), 0);
+    EXPECT_EQ(0, comparator(keys[i], keys[i]));
+  }
+
+  VarKey<32> left;
+  VarKey<32> right;
+  left.SetFromBytes("apple", 5);
+  right.SetFromBytes("apricot", 7);
+  VarKey<32> separator = VarKey<32>::Separator(left, right);
+  EXPECT_EQ(3, separator.size_);
+  EXPECT_LT(comparator(left, separator), 0);
+  EXPECT_LE(comparator(separator, right), 0);
+
+  VarKey<32> integer;
+  integer.SetFromInteger(-42);
+  EXPECT_EQ("-42", integer.ToString());
+}
+
+TEST(BPlusTreeVarKeyTest, InsertRemoveTest) {
+  const int64_t num_keys = 10000;
+  VarKeyComparator<64> comparator;
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  BPlusTree<VarKey<64>, RID, VarKeyComparator<64>> tree("foo_pk", bpm, comparator);
+
+  std::vector<int64_t> ids(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(7));
+  for (int64_t id : ids) {
+    ASSERT_TRUE(tree.Insert(MakeKey(id), RID(id)));
+  }
+  EXPECT_FALSE(tree.Insert(MakeKey(ids[0]), RID(0)));
+
+  // A GenericKey<64> leaf holds at most 56 pairs, so that tree would take more pages than this.
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, false);
+  EXPECT_LT(page_id, num_keys / 56);
+
+  for (int64_t id = 0; id < num_keys; id++) {
+    std::vector<RID> rids;
+    ASSERT_TRUE(tree.GetValue(MakeKey(id), &rids));
+    EXPECT_EQ(RID(id), rids[0]);
+  }
+  int64_t expected_id = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    ASSERT_EQ(0, comparator(MakeKey(expected_id), (*iter).first));
+    expected_id++;
+  }
+  EXPECT_EQ(num_keys, expected_id);
+
+  for (int64_t id : ids) {
+    if (id % 3 != 0) {
+      tree.Remove(MakeKey(id));
+    }
+  }
+  expected_id = 0;
+  for (auto iter = tree.Begin(MakeKey(1)); !iter.IsEnd(); ++iter) {
+    expected_id += 3;
+    ASSERT_EQ(0, comparator(MakeKey(expected_id), (*iter).first));
+  }
+  EXPECT_EQ((num_keys - 1) / 3 * 3, expected_id);
+  for (int64_t id = 0; id < num_keys; id++) {
+    std::vector<RID> rids;
+    ASSERT_EQ(id % 3 == 0, tree.GetValue(MakeKey(id), &rids));
+  }
+
+  for (int64_t id : ids) {
+    tree.Remove(MakeKey(id));
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeVarKeyTest, BulkLoadTest) {
+  const int64_t num_keys = 5000;
+  VarKeyComparator<64> comparator;
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  BPlusTree<VarKey<64>, RID, VarKeyComparator<64>> tree("foo_pk", bpm, comparator);
+
+  // Every other key, out of order, so that the load sorts runs and merges them.
+  std::vector<std::pair<VarKey<64>, RID>> pairs;
+  for (int64_t id = 0; id < num_keys; id += 2) {
+    pairs.emplace_back(MakeKey(id), RID(id));
+  }
+  std::shuffle(pairs.begin(), pairs.end(), std::mt19937(11));
+  ASSERT_TRUE(tree.BulkLoad(pairs.begin(), pairs.end(), 0.7));
+
+  // Loaded leaves take inserts between their keys, and removes down to merges.
+  for (int64_t id = 1; id < num_keys; id += 2) {
+    ASSERT_TRUE(tree.Insert(MakeKey(id), RID(id)));
+  }
+  int64_t expected_id = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    ASSERT_EQ(0, comparator(MakeKey(expected_id), (*iter).first));
+    EXPECT_EQ(RID(expected_id), (*iter).second);
+    expected_id++;
+  }
+  EXPECT_EQ(num_keys, expected_id);
+  for (int64_t id = 0; id < num_keys; id++) {
+    if (id % 5 != 0) {
+      tree.Remove(MakeKey(id));
+    }
+  }
+  for (int64_t id = 0; id < num_keys; id++) {
+    std::vector<RID> rids;
+    ASSERT_EQ(id % 5 == 0, tree.GetValue(MakeKey(id), &rids));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -10,10 +10,22 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
+#include "common/util/crc32c_util.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_io_engine.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -24,12 +36,17 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.crc");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.crc");
+    for (int seq = 0; seq < 10; ++seq) {
+      remove(("test.log." + std::string(7, '0') + std::to_string(seq)).c_str());
+    }
   };
 };
 
@@ -72,7 +89,353 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LogSegmentTest) {
+  // Room for exactly three 1 KB flushes per segment after the segment header.
+  const int flush_size = 1024;
+  const int segment_size = 4 * flush_size;
+  std::vector<std::vector<char>> flushes(10, std::vector<char>(flush_size));
+  for (size_t i = 0; i < flushes.size(); ++i) {
+    std::memset(flushes[i].data(), 'a' + i, flush_size);
+  }
+  std::vector<char> buf(2 * flush_size);
+  {
+    auto dm = DiskManager("test.db", false, DiskIOBackend::SYNC, false, segment_size);
+    EXPECT_FALSE(dm.ReadLog(buf.data(), flush_size, 0));
+    // Flush i holds the records with LSNs 10 * i to 10 * i + 9.
+    for (size_t i = 0; i < flushes.size(); ++i) {
+      dm.WriteLog(flushes[i].data(), flush_size, static_cast<lsn_t>(10 * i));
+    }
+    EXPECT_EQ(4, dm.GetNumLogSegments());
+
+    // Reads go on across segment boundaries.
+    EXPECT_TRUE(dm.ReadLog(buf.data(), 2 * flush_size, 2 * flush_size));
+    EXPECT_EQ('c', buf[0]);
+    EXPECT_EQ('d', buf[flush_size]);
+    EXPECT_FALSE(dm.ReadLog(buf.data(), flush_size, 10 * flush_size));
+    // Offsets past 4 GiB do not wrap around to the start of the log.
+    EXPECT_FALSE(dm.ReadLog(buf.data(), flush_size, (int64_t{1} << 32) + 2 * flush_size));
+    EXPECT_EQ(3 * flush_size, dm.GetLogSegmentOffset(45));
+
+    // The segment holding the restart LSN stays, and so does everything after it.
+    dm.TruncateLog(45);
+    EXPECT_EQ(3, dm.GetNumLogSegments());
+    EXPECT_EQ(45, dm.GetLogRestartLSN());
+    EXPECT_FALSE(dm.ReadLog(buf.data(), flush_size, 0));
+    EXPECT_TRUE(dm.ReadLog(buf.data(), flush_size, 3 * flush_size));
+    EXPECT_EQ('d', buf[0]);
+    dm.ShutDown();
+  }
+
+  // The remaining segments are found again on restart.
+  auto dm = DiskManager("test.db", false, DiskIOBackend::SYNC, false, segment_size);
+  EXPECT_EQ(3, dm.GetNumLogSegments());
+  EXPECT_EQ(45, dm.GetLogRestartLSN());
+  EXPECT_EQ(3 * flush_size, dm.GetLogSegmentOffset(dm.GetLogRestartLSN()));
+  EXPECT_TRUE(dm.ReadLog(buf.data(), flush_size, 9 * flush_size));
+  EXPECT_EQ('j', buf[0]);
+  EXPECT_TRUE(dm.ReadLog(buf.data(), 2 * flush_size, 9 * flush_size));
+  EXPECT_EQ(0, buf[flush_size]);
+
+  // Truncating past every segment keeps the last one, which new records go on filling.
+  dm.TruncateLog(1000);
+  EXPECT_EQ(1, dm.GetNumLogSegments());
+  dm.WriteLog(flushes[0].data(), flush_size, 100);
+  EXPECT_EQ(1, dm.GetNumLogSegments());
+  EXPECT_TRUE(dm.ReadLog(buf.data(), flush_size, 10 * flush_size));
+  EXPECT_EQ('a', buf[0]);
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Pages written before checksums were enabled have no trailer and are not reported.
+  {
+    auto dm = DiskManager(db_file);
+    dm.WritePage(0, data);
+    dm.ShutDown();
+  }
+  auto dm = DiskManager(db_file, true);
+  EXPECT_TRUE(dm.ReadPage(0, buf));
+  EXPECT_TRUE(dm.ReadPage(3, buf));  // tolerate empty read
+
+  dm.WritePage(1, data);
+  dm.WritePage(2, data);
+  EXPECT_TRUE(dm.ReadPage(1, buf));
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // Scenario: only the first half of page 2 made it to disk.
+  {
+    std::fstream file(db_file, std::ios::binary | std::ios::in | std::ios::out);
+    char garbage[PAGE_SIZE / 2];
+    std::memset(garbage, 'x', sizeof(garbage));
+    file.seekp(2 * PAGE_SIZE + PAGE_SIZE / 2);
+    file.write(garbage, sizeof(garbage));
+  }
+  EXPECT_FALSE(dm.ReadPage(2, buf));
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+  char bufs[3][PAGE_SIZE];
+  std::vector<bool> verified = dm.ReadPages({2, 1, 0}, {bufs[0], bufs[1], bufs[2]});
+  EXPECT_EQ(std::vector<bool>({false, true, true}), verified);
+
+  // Rewriting the page repairs it.
+  dm.WritePage(2, data);
+  EXPECT_TRUE(dm.ReadPage(2, buf));
+
+  // Scenario: a crash hit between the page and its trailer; recovery takes the page as it is and fixes the trailer.
+  {
+    std::fstream file(db_file, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(1 * PAGE_SIZE);
+    file.write("Another string.", 15);
+  }
+  EXPECT_FALSE(dm.ReadPage(1, buf));
+  dm.SetRepairChecksums(true);
+  EXPECT_TRUE(dm.ReadPage(1, buf));
+  dm.SetRepairChecksums(false);
+  EXPECT_TRUE(dm.ReadPage(1, buf));
+  EXPECT_EQ(std::memcmp(buf, "Another string.", 15), 0);
+  dm.SyncPages();
+  dm.ShutDown();
+
+  // The trailers outlive the disk manager.
+  auto reopened = DiskManager(db_file, true);
+  EXPECT_TRUE(reopened.ReadPage(1, buf));
+  EXPECT_TRUE(reopened.ReadPage(2, buf));
+  EXPECT_EQ(0, reopened.GetNumChecksumFailures());
+  reopened.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadPagesTest) {
+  const int num_pages = 6;
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+  auto dm = DiskManager("test.db", true);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    std::memset(data[page_id].data(), 'a' + page_id, PAGE_SIZE);
+    dm.WritePage(page_id, data[page_id].data());
+  }
+
+  // Scenario: a batch in no particular order, with runs of adjacent pages, a lone page and pages past the end.
+  std::vector<page_id_t> page_ids{4, 1, 8, 2, 3, 0, 7};
+  std::vector<std::vector<char>> buf(page_ids.size(), std::vector<char>(PAGE_SIZE, 'x'));
+  std::vector<char *> page_data;
+  for (auto &page_buf : buf) {
+    page_data.push_back(page_buf.data());
+  }
+  EXPECT_EQ(std::vector<bool>(page_ids.size(), true), dm.ReadPages(page_ids, page_data));
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    std::vector<char> expected = page_ids[i] < num_pages ? data[page_ids[i]] : std::vector<char>(PAGE_SIZE, 0);
+    EXPECT_EQ(expected, buf[i]) << "page " << page_ids[i];
+  }
+
+  // Scenario: a page in the middle of a run is torn; only that page fails its checksum.
+  {
+    std::fstream file("test.db", std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(2 * PAGE_SIZE + 100);
+    file.write("torn", 4);
+  }
+  EXPECT_EQ(std::vector<bool>({true, true, true}),
+            dm.ReadPages({3, 1, 0}, {page_data[0], page_data[1], page_data[2]}));
+  EXPECT_EQ(std::vector<bool>({true, false, true}),
+            dm.ReadPages({1, 2, 3}, {page_data[0], page_data[1], page_data[2]}));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadErrorTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto dm = DiskManager("test.db");
+  dm.WritePage(0, data);
+  EXPECT_TRUE(dm.ReadPage(0, buf));
+  // Scenario: the read fails, here on a closed file; the buffer holds no page.
+  dm.ShutDown();
+  EXPECT_FALSE(dm.ReadPage(0, buf));
+  EXPECT_FALSE(dm.ReadPageAsync(0, buf).get());
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncReadWritePageTest) {
+  const int num_pages = 100;
+  for (auto backend : {DiskIOBackend::SYNC, DiskIOBackend::THREAD_POOL, DiskIOBackend::IO_URING}) {
+    remove("test.db");
+    remove("test.crc");
+    auto dm = DiskManager("test.db", true, backend);
+    if (backend == DiskIOBackend::IO_URING) {
+      // The thread pool stands in where the kernel does not allow io_uring.
+      EXPECT_NE(DiskIOBackend::SYNC, dm.GetIOBackend());
+    } else {
+      EXPECT_EQ(backend, dm.GetIOBackend());
+    }
+
+    // Scenario: all writes are in flight at the same time.
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::future<void>> writes;
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      snprintf(data[page_id].data(), PAGE_SIZE, "page %d", page_id);
+      writes.push_back(dm.WritePageAsync(page_id, data[page_id].data()));
+    }
+    for (auto &write : writes) {
+      write.get();
+    }
+
+    std::vector<std::vector<char>> buf(num_pages, std::vector<char>(PAGE_SIZE, 'x'));
+    std::vector<std::future<bool>> reads;
+    for (page_id_t page_id = num_pages - 1; page_id >= 0; --page_id) {
+      reads.push_back(dm.ReadPageAsync(page_id, buf[page_id].data()));
+    }
+    for (auto &read : reads) {
+      EXPECT_TRUE(read.get());
+    }
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      EXPECT_EQ(0, std::memcmp(buf[page_id].data(), data[page_id].data(), PAGE_SIZE));
+    }
+
+    // Scenario: reading past the end of the file gives a zeroed page, and the sync calls see the async writes.
+    EXPECT_TRUE(dm.ReadPageAsync(num_pages + 10, buf[0].data()).get());
+    EXPECT_EQ(0, buf[0][0]);
+    EXPECT_TRUE(dm.ReadPage(7, buf[0].data()));
+    EXPECT_EQ(0, std::memcmp(buf[0].data(), data[7].data(), PAGE_SIZE));
+    std::vector<bool> verified = dm.ReadPages({3, 2}, {buf[0].data(), buf[1].data()});
+    EXPECT_EQ(std::vector<bool>({true, true}), verified);
+    EXPECT_EQ(0, std::memcmp(buf[1].data(), data[2].data(), PAGE_SIZE));
+
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, IoUringShortReadTest) {
+  auto engine = IoUringDiskIOEngine(DISK_IO_QUEUE_DEPTH);
+  if (!engine.IsReady()) {
+    GTEST_SKIP() << "io_uring is not available";
+  }
+  // Scenario: the data arrives in two parts, here through a pipe; the read goes on until it has all of it.
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  char buf[8] = {0};
+  std::promise<ssize_t> done;
+  engine.SubmitRead(fds[0], buf, sizeof(buf), 0, [&done](ssize_t result) { done.set_value(result); });
+  ASSERT_EQ(4, write(fds[1], "abcd", 4));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(4, write(fds[1], "efgh", 4));
+  EXPECT_EQ(8, done.get_future().get());
+  EXPECT_EQ(0, std::memcmp(buf, "abcdefgh", 8));
+  close(fds[0]);
+  close(fds[1]);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentDirectIOTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  for (bool direct_io : {false, true}) {
+    remove("test.db");
+    remove("test.crc");
+    auto dm = DiskManager("test.db", true, DiskIOBackend::SYNC, direct_io);
+    // O_DIRECT is refused by some file systems, e.g. tmpfs, which leaves the file on buffered I/O.
+    if (!direct_io) {
+      EXPECT_FALSE(dm.IsDirectIO());
+    }
+
+    // Scenario: threads write and read back disjoint pages at the same time, from unaligned buffers.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&dm, t] {
+        std::vector<char> data(PAGE_SIZE + 1);
+        std::vector<char> buf(PAGE_SIZE + 1);
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + t;
+          snprintf(data.data() + 1, PAGE_SIZE, "page %d", page_id);
+          dm.WritePage(page_id, data.data() + 1);
+          EXPECT_TRUE(dm.ReadPage(page_id, buf.data() + 1));
+          EXPECT_EQ(0, std::memcmp(buf.data() + 1, data.data() + 1, PAGE_SIZE));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+    // Scenario: the cached file size covers every page written, and a page past it reads as zeroes.
+    char buf[PAGE_SIZE];
+    EXPECT_TRUE(dm.ReadPage(num_threads * pages_per_thread - 1, buf));
+    EXPECT_EQ(0, strcmp(buf, ("page " + std::to_string(num_threads * pages_per_thread - 1)).c_str()));
+    memset(buf, 'x', PAGE_SIZE);
+    EXPECT_TRUE(dm.ReadPage(num_threads * pages_per_thread, buf));
+    EXPECT_EQ(0, buf[0]);
+    dm.ShutDown();
+
+    // Scenario: a new disk manager picks up the size of the existing file.
+    auto reopened = DiskManager("test.db", true, DiskIOBackend::SYNC, direct_io);
+    EXPECT_TRUE(reopened.ReadPage(5, buf));
+    EXPECT_EQ(0, strcmp(buf, "page 5"));
+    EXPECT_EQ(0, reopened.GetNumChecksumFailures());
+    reopened.ShutDown();
+  }
+}
+
+// A benchmark rather than a test; run it with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_ChecksumOverheadBenchmark) {
+  const int num_pages = 256;
+  const int rounds = 4;
+  char data[PAGE_SIZE];
+  for (int i = 0; i < PAGE_SIZE; ++i) {
+    data[i] = static_cast<char>(i * 7);
+  }
+
+  auto run = [&](bool enable_checksums) {
+    remove("test.db");
+    remove("test.crc");
+    auto dm = DiskManager("test.db", enable_checksums);
+    char buf[PAGE_SIZE];
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        dm.WritePage(page_id, data);
+      }
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        EXPECT_TRUE(dm.ReadPage(page_id, buf));
+      }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    dm.ShutDown();
+    return 2.0 * num_pages * rounds / elapsed;
+  };
+  double plain = run(false);
+  double checksummed = run(true);
+
+  std::vector<char> block(1 << 20, 'b');
+  auto crc_throughput = [&](auto crc) {
+    auto start = std::chrono::steady_clock::now();
+    uint32_t sum = 0;
+    for (int i = 0; i < 64; ++i) {
+      sum += crc(block.data(), block.size());
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_NE(0, sum);
+    return 64.0 / 1024 / elapsed;
+  };
+  double hardware = crc_throughput([](const char *p, size_t n) { return Crc32cUtil::Crc32c(p, n); });
+  double software = crc_throughput([](const char *p, size_t n) { return Crc32cUtil::Crc32cSoftware(p, n); });
+
+  std::cout << "page I/O without checksums: " << plain << " pages/s" << std::endl;
+  std::cout << "page I/O with checksums:    " << checksummed << " pages/s" << std::endl;
+  std::cout << "CRC32C " << (Crc32cUtil::HasHardwareSupport() ? "hardware" : "fallback") << ": " << hardware
+            << " GB/s, software: " << software << " GB/s" << std::endl;
+}
+
 }  // namespace bustub